@@ -58,9 +58,43 @@ KronosErrorCode kronos_get_last_error_code(KronosVM *vm);
  */
 void kronos_set_error_callback(KronosVM *vm, KronosErrorCallback callback);
 
+/**
+ * Memory allocator callbacks.
+ *
+ * alloc and realloc must return memory aligned for any type, or NULL on
+ * failure; realloc with a NULL pointer behaves like alloc. free is never
+ * called with NULL. user_data is passed to every callback.
+ */
+typedef struct KronosAllocator {
+  void *(*alloc)(void *user_data, size_t size);
+  void *(*realloc)(void *user_data, void *ptr, size_t size);
+  void (*free)(void *user_data, void *ptr);
+  void *user_data;
+} KronosAllocator;
+
+/**
+ * Set the allocator for VMs created afterwards on the calling thread.
+ *
+ * A VM keeps the allocator it was created with for its whole lifetime and
+ * uses it for everything it owns: the VM itself, tokens, syntax trees,
+ * bytecode, functions, globals and the buffers of the strings and lists its
+ * scripts create. Small fixed-size value headers come from the runtime's
+ * per-thread slab pages, and strings interned for constants are shared
+ * between VMs, so both stay on the C library allocator.
+ *
+ * Parameters:
+ *   allocator - Callbacks to copy (NULL, or an allocator missing a callback,
+ *               restores malloc/realloc/free).
+ * Thread-safety: affects only the calling thread.
+ */
+void kronos_set_allocator(const KronosAllocator *allocator);
+
 /**
  * Create a new Kronos virtual machine instance.
  *
+ * The VM allocates through the calling thread's allocator (see
+ * kronos_set_allocator()).
+ *
  * Returns: Pointer to new VM on success, NULL on allocation failure.
  * Thread-safety: NOT thread-safe. Each VM instance must be used by a single
  * thread.
@@ -76,6 +110,46 @@ KronosVM *kronos_vm_new(void);
  */
 void kronos_vm_free(KronosVM *vm);
 
+/**
+ * Set how much deferred freeing the VM does per slice.
+ *
+ * A list whose last reference is dropped while the VM runs is not torn down
+ * at once: its items are released in slices of at most `budget` steps at
+ * loop back-edges and value allocations, which bounds the pause of freeing
+ * a large structure. Anything left is freed when the run returns.
+ *
+ * Parameters:
+ *   vm     - VM instance (may be NULL, in which case this is a no-op).
+ *   budget - Steps per slice (default 1024), or 0 to free synchronously.
+ */
+void kronos_set_reclaim_budget(KronosVM *vm, size_t budget);
+
+/**
+ * Cap the heap a VM's scripts may use.
+ *
+ * Values allocated while the VM runs (headers, string bytes, list storage)
+ * are charged to it. Past the soft limit, an allocation first frees dead
+ * values and collects reference cycles; if it would still take usage past
+ * the hard limit it fails, and the run stops with KRONOS_ERR_RUNTIME
+ * "memory limit exceeded". The VM stays usable afterwards.
+ *
+ * Parameters:
+ *   vm         - VM instance (may be NULL, in which case this is a no-op).
+ *   soft_limit - Bytes above which cycle collection runs first (0: same as
+ *                limit).
+ *   limit      - Hard cap in bytes (0: unlimited, the default).
+ */
+void kronos_set_memory_limit(KronosVM *vm, size_t soft_limit, size_t limit);
+
+/**
+ * Bytes currently charged to a VM's memory limit.
+ *
+ * Parameters:
+ *   vm - VM instance (may be NULL).
+ * Returns: Bytes in use by values allocated while the VM ran (0 for NULL).
+ */
+size_t kronos_get_memory_usage(KronosVM *vm);
+
 /**
  * Execute a Kronos source file.
  *
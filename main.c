@@ -9,6 +9,7 @@
 
 #include "include/kronos.h"
 #include "src/compiler/compiler.h"
+#include "src/core/memory.h"
 #include "src/core/runtime.h"
 #include "src/frontend/parser.h"
 #include "src/frontend/tokenizer.h"
@@ -19,17 +20,43 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** Allocator given to VMs created on this thread (all NULL: the C library) */
+static _Thread_local KronosAllocator vm_allocator;
+
+/**
+ * @brief Set the allocator of VMs created afterwards on this thread
+ *
+ * @param allocator Callbacks to copy, or NULL for malloc/realloc/free. An
+ * allocator missing any callback counts as NULL.
+ */
+void kronos_set_allocator(const KronosAllocator *allocator) {
+  if (allocator && allocator->alloc && allocator->realloc && allocator->free)
+    vm_allocator = *allocator;
+  else
+    memset(&vm_allocator, 0, sizeof(vm_allocator));
+}
+
 /**
  * @brief Create a new Kronos VM instance
  *
  * Initializes the runtime system and creates a new virtual machine ready
- * to execute Kronos bytecode. The VM includes the built-in Pi constant.
+ * to execute Kronos bytecode. The VM includes the built-in Pi constant and
+ * allocates through the allocator set with kronos_set_allocator().
  *
  * @return Pointer to the new VM instance, or NULL on failure
  */
 KronosVM *kronos_vm_new(void) {
   runtime_init();
+  MemAllocator *allocator = NULL;
+  if (vm_allocator.alloc && !(allocator = mem_allocator_new(&vm_allocator))) {
+    runtime_cleanup();
+    return NULL;
+  }
+
+  MemAllocator *previous = mem_set_allocator(allocator);
   KronosVM *vm = vm_new();
+  mem_set_allocator(previous);
+  mem_allocator_release(allocator); // The VM holds its own reference
   if (!vm) {
     runtime_cleanup();
     return NULL;
@@ -101,20 +128,45 @@ void kronos_set_error_callback(KronosVM *vm, KronosErrorCallback callback) {
 }
 
 /**
- * @brief Execute Kronos source code from a string
+ * @brief Set the per-slice budget of deferred reclamation
  *
- * Compiles and executes Kronos source code in a single call. This function
- * handles the full pipeline: tokenization, parsing, compilation, and execution.
- * Errors are stored in the VM and can be retrieved with kronos_get_last_error().
+ * @param vm The VM instance
+ * @param budget Steps per slice, or 0 to free dead lists synchronously
+ */
+void kronos_set_reclaim_budget(KronosVM *vm, size_t budget) {
+  if (!vm)
+    return;
+  vm->reclaim.budget = budget;
+}
+
+/**
+ * @brief Set the heap limits of a VM
  *
- * @param vm The VM instance to use for execution
- * @param source The Kronos source code to execute (must not be NULL)
- * @return 0 on success, negative error code on failure
+ * @param vm The VM instance
+ * @param soft_limit Bytes above which allocation collects cycles first
+ * (0: same as limit)
+ * @param limit Hard cap in bytes (0: unlimited)
  */
-int kronos_run_string(KronosVM *vm, const char *source) {
-  if (!vm || !source)
-    return -(int)KRONOS_ERR_INVALID_ARGUMENT;
+void kronos_set_memory_limit(KronosVM *vm, size_t soft_limit, size_t limit) {
+  if (!vm)
+    return;
+  gc_budget_set_limits(&vm->memory, soft_limit, limit);
+}
+
+/**
+ * @brief Get the bytes charged to a VM's memory limit
+ *
+ * @param vm The VM instance
+ * @return Bytes in use, or 0 if vm is NULL
+ */
+size_t kronos_get_memory_usage(KronosVM *vm) {
+  if (!vm)
+    return 0;
+  return vm->memory.used;
+}
 
+// Tokenize, parse, compile and run source (the VM's allocator is current)
+static int run_source(KronosVM *vm, const char *source) {
   vm_clear_error(vm);
 
   // Step 1: Tokenize - Convert source code into tokens
@@ -153,19 +205,28 @@ int kronos_run_string(KronosVM *vm, const char *source) {
 }
 
 /**
- * @brief Execute a Kronos program from a file
+ * @brief Execute Kronos source code from a string
  *
- * Reads the contents of a file and executes it as Kronos source code.
- * Handles file I/O errors and validates file size to prevent memory issues.
+ * Compiles and executes Kronos source code in a single call. This function
+ * handles the full pipeline: tokenization, parsing, compilation, and execution.
+ * Errors are stored in the VM and can be retrieved with kronos_get_last_error().
  *
  * @param vm The VM instance to use for execution
- * @param filepath Path to the .kr file to execute (must not be NULL)
+ * @param source The Kronos source code to execute (must not be NULL)
  * @return 0 on success, negative error code on failure
  */
-int kronos_run_file(KronosVM *vm, const char *filepath) {
-  if (!vm || !filepath)
+int kronos_run_string(KronosVM *vm, const char *source) {
+  if (!vm || !source)
     return -(int)KRONOS_ERR_INVALID_ARGUMENT;
 
+  MemAllocator *previous = vm_use_allocator(vm);
+  int result = run_source(vm, source);
+  mem_set_allocator(previous);
+  return result;
+}
+
+// Read and run a source file (the VM's allocator is current)
+static int run_file(KronosVM *vm, const char *filepath) {
   vm_clear_error(vm);
 
   // Open file for reading
@@ -210,7 +271,7 @@ int kronos_run_file(KronosVM *vm, const char *filepath) {
   // Allocate buffer for file contents (size + 1 for null terminator)
   // Safe to cast after size validation above
   size_t length = (size_t)size;
-  char *source = malloc(length + 1);
+  char *source = mem_alloc(length + 1);
   if (!source) {
     int err = vm_error(vm, KRONOS_ERR_INTERNAL,
                        "Failed to allocate memory for file contents");
@@ -223,7 +284,7 @@ int kronos_run_file(KronosVM *vm, const char *filepath) {
   // Verify file was read successfully
   if (ferror(file)) {
     int err = vm_errorf(vm, KRONOS_ERR_IO, "Failed to read file: %s", filepath);
-    free(source);
+    mem_free(source);
     fclose(file);
     return err;
   }
@@ -232,7 +293,7 @@ int kronos_run_file(KronosVM *vm, const char *filepath) {
   if (read_size < length && !feof(file)) {
     int err =
         vm_errorf(vm, KRONOS_ERR_IO, "Incomplete read from file: %s", filepath);
-    free(source);
+    mem_free(source);
     fclose(file);
     return err;
   }
@@ -242,9 +303,29 @@ int kronos_run_file(KronosVM *vm, const char *filepath) {
   fclose(file);
 
   // Execute the source code
-  int result = kronos_run_string(vm, source);
-  free(source);
+  int result = run_source(vm, source);
+  mem_free(source);
+
+  return result;
+}
+
+/**
+ * @brief Execute a Kronos program from a file
+ *
+ * Reads the contents of a file and executes it as Kronos source code.
+ * Handles file I/O errors and validates file size to prevent memory issues.
+ *
+ * @param vm The VM instance to use for execution
+ * @param filepath Path to the .kr file to execute (must not be NULL)
+ * @return 0 on success, negative error code on failure
+ */
+int kronos_run_file(KronosVM *vm, const char *filepath) {
+  if (!vm || !filepath)
+    return -(int)KRONOS_ERR_INVALID_ARGUMENT;
 
+  MemAllocator *previous = vm_use_allocator(vm);
+  int result = run_file(vm, filepath);
+  mem_set_allocator(previous);
   return result;
 }
 
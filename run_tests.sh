@@ -101,8 +101,17 @@ run_integration_test() {
     exit_code=$?
 
     if [ "$should_pass" = "true" ]; then
-        # Test should succeed (exit code 0)
-        if [ $exit_code -eq 0 ]; then
+        # Test should succeed (exit code 0) and, when the test has a golden
+        # file next to it (same name, .out), print exactly that
+        local golden="${test_file%.kr}.out"
+        if [ $exit_code -eq 0 ] && [ -f "$golden" ] &&
+           ! diff_output=$(diff "$golden" <(printf '%s\n' "$output")); then
+            echo "${RED}✗${NC} FAIL: $test_name (output differs from $(basename "$golden"))"
+            echo "$diff_output" | sed 's/^/   /'
+            failed_tests=$((failed_tests + 1))
+            integration_tests_failed=$((integration_tests_failed + 1))
+            return 1
+        elif [ $exit_code -eq 0 ]; then
             echo "${GREEN}✓${NC} PASS: $test_name"
             passed_tests=$((passed_tests + 1))
             integration_tests_passed=$((integration_tests_passed + 1))
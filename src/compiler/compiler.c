@@ -12,6 +12,7 @@
  */
 
 #include "compiler.h"
+#include "../core/memory.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -39,9 +40,31 @@ typedef struct LoopInfo {
   size_t loop_end; // Position after loop end (for break) - updated after loop
                    // compilation
   BreakContinueJump *pending_jumps; // List of break/continue jumps to patch
+  size_t stack_values; // Loop state kept on the operand stack (list-for)
   struct LoopInfo *next;
 } LoopInfo;
 
+/**
+ * Forward jumps that share a target not yet known
+ * Used for the exits of conditions and the blocks of an if/else-if chain
+ */
+typedef struct {
+  size_t *positions; // Positions of the offset bytes that need patching
+  size_t count;
+  size_t capacity;
+} JumpList;
+
+/**
+ * Frame slot layout of the function currently being compiled
+ * Parameters take the first slots, followed by every name the body assigns,
+ * followed by hidden loop state allocated while compiling the body
+ */
+typedef struct FunctionScope {
+  const char *slots[LOCALS_MAX]; // Slot names (borrowed from AST/constants)
+  size_t slot_count;             // Slots allocated so far
+  struct FunctionScope *enclosing;
+} FunctionScope;
+
 /**
  * Compiler state structure
  * Tracks bytecode generation and error state
@@ -50,6 +73,9 @@ typedef struct {
   Bytecode *bytecode;        /**< Generated bytecode being built */
   const char *error_message; /**< Current error message (NULL if no error) */
   LoopInfo *loop_stack;      /**< Stack of active loops for break/continue */
+  FunctionScope *scope;      /**< Innermost function scope (NULL at top level) */
+  uint32_t *global_index;    /**< Hash index over bytecode->globals (idx + 1) */
+  size_t global_index_capacity; /**< Bucket count (power of two) */
 } Compiler;
 
 static inline bool compiler_has_error(const Compiler *c) {
@@ -64,12 +90,13 @@ static void compiler_set_error(Compiler *c, const char *message) {
 
 // Push loop info onto stack
 static bool push_loop(Compiler *c, size_t loop_start) {
-  LoopInfo *info = malloc(sizeof(LoopInfo));
+  LoopInfo *info = mem_alloc(sizeof(LoopInfo));
   if (!info) {
     compiler_set_error(c, "Failed to allocate loop info");
     return false;
   }
   info->loop_start = loop_start;
+  info->stack_values = 0;
   info->loop_continue =
       loop_start;     // Default to loop_start, will be updated for for loops
   info->loop_end = 0; // Will be set after loop compilation
@@ -86,7 +113,7 @@ static bool add_pending_jump(Compiler *c, size_t jump_pos, bool is_break) {
                                    : "continue statement outside of loop");
     return false;
   }
-  BreakContinueJump *jump = malloc(sizeof(BreakContinueJump));
+  BreakContinueJump *jump = mem_alloc(sizeof(BreakContinueJump));
   if (!jump) {
     compiler_set_error(c, "Failed to allocate jump info");
     return false;
@@ -130,7 +157,7 @@ static void patch_pending_jumps(Compiler *c) {
       }
     }
     BreakContinueJump *next = jump->next;
-    free(jump);
+    mem_free(jump);
     jump = next;
   }
   c->loop_stack->pending_jumps = NULL;
@@ -144,11 +171,11 @@ static void pop_loop(Compiler *c) {
   BreakContinueJump *jump = c->loop_stack->pending_jumps;
   while (jump) {
     BreakContinueJump *next = jump->next;
-    free(jump);
+    mem_free(jump);
     jump = next;
   }
   LoopInfo *next = c->loop_stack->next;
-  free(c->loop_stack);
+  mem_free(c->loop_stack);
   c->loop_stack = next;
 }
 
@@ -182,7 +209,7 @@ static void emit_byte(Compiler *c, uint8_t byte) {
     size_t new_size = new_capacity * sizeof(uint8_t);
 
     // Attempt reallocation using temporary pointer
-    uint8_t *new_code = realloc(c->bytecode->code, new_size);
+    uint8_t *new_code = mem_realloc(c->bytecode->code, new_size);
 
     if (!new_code) {
       compiler_set_error(c, "Failed to allocate memory for bytecode");
@@ -218,6 +245,183 @@ static void emit_uint16(Compiler *c, uint16_t value) {
   emit_byte(c, (uint8_t)(value & 0xFF));
 }
 
+// Find the frame slot holding a name in the current function (-1 if none)
+static int scope_resolve(const FunctionScope *scope, const char *name) {
+  for (size_t i = 0; i < scope->slot_count; i++) {
+    if (strcmp(scope->slots[i], name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// Allocate a frame slot for a name, reusing an existing slot if present
+static int scope_declare(Compiler *c, const char *name) {
+  int slot = scope_resolve(c->scope, name);
+  if (slot >= 0)
+    return slot;
+  if (c->scope->slot_count >= LOCALS_MAX) {
+    compiler_set_error(c, "Too many local variables in function (limit 64)");
+    return -1;
+  }
+  c->scope->slots[c->scope->slot_count] = name;
+  return (int)c->scope->slot_count++;
+}
+
+/**
+ * @brief Reserve frame slots for every name a function body assigns
+ *
+ * Runs before the body is compiled so that a read which precedes the first
+ * assignment (e.g. inside a loop) still resolves to the slot. Nested function
+ * definitions get their own scope and are skipped.
+ *
+ * @param c Compiler state (c->scope must be set)
+ * @param block Statements to scan
+ * @param count Number of statements in block
+ */
+static void scope_collect(Compiler *c, ASTNode **block, size_t count) {
+  for (size_t i = 0; i < count && !compiler_has_error(c); i++) {
+    ASTNode *node = block[i];
+    if (!node)
+      continue;
+    switch (node->type) {
+    case AST_ASSIGN:
+      scope_declare(c, node->as.assign.name);
+      break;
+    case AST_FOR:
+      scope_declare(c, node->as.for_stmt.var);
+      scope_collect(c, node->as.for_stmt.block, node->as.for_stmt.block_size);
+      break;
+    case AST_WHILE:
+      scope_collect(c, node->as.while_stmt.block,
+                    node->as.while_stmt.block_size);
+      break;
+    case AST_IF:
+      scope_collect(c, node->as.if_stmt.block, node->as.if_stmt.block_size);
+      for (size_t j = 0; j < node->as.if_stmt.else_if_count; j++) {
+        scope_collect(c, node->as.if_stmt.else_if_blocks[j],
+                      node->as.if_stmt.else_if_block_sizes[j]);
+      }
+      scope_collect(c, node->as.if_stmt.else_block,
+                    node->as.if_stmt.else_block_size);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Rebuild the global name hash index with room for at least min_entries
+static bool global_index_grow(Compiler *c, size_t min_entries) {
+  size_t capacity = c->global_index_capacity ? c->global_index_capacity : 64;
+  while (capacity < min_entries * 2)
+    capacity *= 2;
+  uint32_t *index = mem_calloc(capacity, sizeof(uint32_t));
+  if (!index) {
+    compiler_set_error(c, "Failed to allocate global name index");
+    return false;
+  }
+  for (size_t i = 0; i < c->bytecode->global_count; i++) {
+    KronosValue *name = c->bytecode->constants[c->bytecode->globals[i]];
+    size_t bucket = name->as.string.hash & (capacity - 1);
+    while (index[bucket])
+      bucket = (bucket + 1) & (capacity - 1);
+    index[bucket] = (uint32_t)i + 1;
+  }
+  mem_free(c->global_index);
+  c->global_index = index;
+  c->global_index_capacity = capacity;
+  return true;
+}
+
+/**
+ * @brief Map a global name to its index in the bytecode's global table
+ *
+ * Each distinct name gets one entry, so every reference to it compiles to
+ * the same operand and the VM resolves the name once per bytecode.
+ *
+ * @param c Compiler state
+ * @param name_idx Constant pool index of the name (an interned string)
+ * @return Global table index, or -1 on error
+ */
+static int resolve_global(Compiler *c, size_t name_idx) {
+  KronosValue *name = c->bytecode->constants[name_idx];
+  Bytecode *bc = c->bytecode;
+
+  if (c->global_index_capacity < (bc->global_count + 1) * 2 &&
+      !global_index_grow(c, bc->global_count + 1))
+    return -1;
+
+  size_t mask = c->global_index_capacity - 1;
+  size_t bucket = name->as.string.hash & mask;
+  while (c->global_index[bucket]) {
+    uint32_t idx = c->global_index[bucket] - 1;
+    // Names are interned, so the same name is the same string
+    if (bc->constants[bc->globals[idx]] == name)
+      return (int)idx;
+    bucket = (bucket + 1) & mask;
+  }
+
+  if (bc->global_count > UINT16_MAX) {
+    compiler_set_error(c, "Too many global variables (limit 65536)");
+    return -1;
+  }
+  if (bc->global_count >= bc->global_capacity) {
+    size_t new_capacity = bc->global_capacity ? bc->global_capacity * 2 : 16;
+    uint16_t *globals =
+        mem_realloc(bc->globals, new_capacity * sizeof(uint16_t));
+    if (!globals) {
+      compiler_set_error(c, "Failed to allocate global name table");
+      return -1;
+    }
+    bc->globals = globals;
+    bc->global_capacity = new_capacity;
+  }
+  bc->globals[bc->global_count] = (uint16_t)name_idx;
+  c->global_index[bucket] = (uint32_t)bc->global_count + 1;
+  return (int)bc->global_count++;
+}
+
+/**
+ * @brief Emit a variable load or store
+ *
+ * Inside a function, names that live in a frame slot are emitted as
+ * OP_LOAD_LOCAL/OP_STORE_LOCAL with a one-byte slot index. Stores always
+ * target a slot (hidden loop state gets one on first use). Everything else
+ * is a global, addressed through the bytecode's global table with
+ * OP_LOAD_GLOBAL/OP_STORE_GLOBAL.
+ *
+ * @param c Compiler state
+ * @param op OP_LOAD_VAR or OP_STORE_VAR
+ * @param name_idx Constant pool index of the variable name
+ */
+static void emit_variable(Compiler *c, OpCode op, size_t name_idx) {
+  if (compiler_has_error(c))
+    return;
+  if (name_idx > UINT16_MAX) {
+    compiler_set_error(c, "Too many constants (limit 65535)");
+    return;
+  }
+
+  if (c->scope) {
+    const char *name = c->bytecode->constants[name_idx]->as.string.data;
+    int slot = op == OP_STORE_VAR ? scope_declare(c, name)
+                                  : scope_resolve(c->scope, name);
+    if (compiler_has_error(c))
+      return;
+    if (slot >= 0) {
+      emit_bytes(c, op == OP_STORE_VAR ? OP_STORE_LOCAL : OP_LOAD_LOCAL,
+                 (uint8_t)slot);
+      return;
+    }
+  }
+
+  int global = resolve_global(c, name_idx);
+  if (global < 0)
+    return;
+  emit_byte(c, op == OP_STORE_VAR ? OP_STORE_GLOBAL : OP_LOAD_GLOBAL);
+  emit_uint16(c, (uint16_t)global);
+}
+
 /**
  * @brief Add a constant to the constant pool
  *
@@ -250,7 +454,7 @@ static size_t add_constant(Compiler *c, KronosValue *value) {
     size_t new_size = new_capacity * sizeof(KronosValue *);
 
     // Attempt reallocation using temporary pointer
-    KronosValue **new_constants = realloc(c->bytecode->constants, new_size);
+    KronosValue **new_constants = mem_realloc(c->bytecode->constants, new_size);
 
     if (!new_constants) {
       compiler_set_error(c, "Failed to allocate memory for constant pool");
@@ -268,8 +472,8 @@ static size_t add_constant(Compiler *c, KronosValue *value) {
   return c->bytecode->const_count++;
 }
 
-// Helper to emit constant
-static void emit_constant(Compiler *c, KronosValue *value) {
+// Emit an instruction whose operand is a constant (takes ownership of value)
+static void emit_constant_op(Compiler *c, OpCode op, KronosValue *value) {
   if (!c) {
     if (value)
       value_release(value);
@@ -294,10 +498,191 @@ static void emit_constant(Compiler *c, KronosValue *value) {
     compiler_set_error(c, "Too many constants (limit 65535)");
     return;
   }
-  emit_byte(c, OP_LOAD_CONST);
+  emit_byte(c, (uint8_t)op);
   emit_uint16(c, (uint16_t)idx);
 }
 
+// Helper to emit constant
+static void emit_constant(Compiler *c, KronosValue *value) {
+  emit_constant_op(c, OP_LOAD_CONST, value);
+}
+
+// Map a comparison operator to its fused compare-and-branch opcode
+static int compare_branch_op(BinOp op) {
+  switch (op) {
+  case BINOP_EQ:
+    return OP_JUMP_IF_NOT_EQ;
+  case BINOP_NEQ:
+    return OP_JUMP_IF_NOT_NEQ;
+  case BINOP_GT:
+    return OP_JUMP_IF_NOT_GT;
+  case BINOP_LT:
+    return OP_JUMP_IF_NOT_LT;
+  case BINOP_GTE:
+    return OP_JUMP_IF_NOT_GTE;
+  case BINOP_LTE:
+    return OP_JUMP_IF_NOT_LTE;
+  default:
+    return -1;
+  }
+}
+
+// Record a forward jump whose offset byte is at pos
+static void jump_list_add(Compiler *c, JumpList *list, size_t pos) {
+  if (compiler_has_error(c))
+    return;
+  if (list->count == list->capacity) {
+    size_t new_capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+    size_t *positions =
+        mem_realloc(list->positions, sizeof(size_t) * new_capacity);
+    if (!positions) {
+      compiler_set_error(c, "Failed to allocate jump list");
+      return;
+    }
+    list->positions = positions;
+    list->capacity = new_capacity;
+  }
+  list->positions[list->count++] = pos;
+}
+
+// Point every jump in the list at the end of the code, then empty the list
+static void jump_list_patch(Compiler *c, JumpList *list) {
+  size_t target = c->bytecode->count;
+  for (size_t i = 0; i < list->count && !compiler_has_error(c); i++) {
+    size_t pos = list->positions[i];
+    size_t offset = target - pos - 1;
+    // OP_JUMP takes a signed offset; the conditional jumps are unsigned
+    size_t limit = c->bytecode->code[pos - 1] == OP_JUMP ? INT8_MAX : UINT8_MAX;
+    if (offset > limit) {
+      compiler_set_error(c, "jump offset too large");
+      break;
+    }
+    c->bytecode->code[pos] = (uint8_t)offset;
+  }
+  list->count = 0;
+}
+
+static void jump_list_free(JumpList *list) {
+  mem_free(list->positions);
+  list->positions = NULL;
+  list->count = list->capacity = 0;
+}
+
+static void emit_condition(Compiler *c, ASTNode *condition, bool jump_if,
+                           JumpList *exits);
+
+/**
+ * @brief Emit a function call
+ *
+ * Built-in functions are resolved here and called by ID through
+ * OP_CALL_BUILTIN; anything else is looked up by name at runtime.
+ *
+ * @param c Compiler state
+ * @param name Function name as written at the call site
+ * @param arg_count Number of arguments already pushed
+ */
+static void emit_call(Compiler *c, const char *name, size_t arg_count) {
+  int builtin = builtin_lookup(name);
+  if (builtin >= 0) {
+    emit_byte(c, OP_CALL_BUILTIN);
+    emit_bytes(c, (uint8_t)builtin, (uint8_t)arg_count);
+    return;
+  }
+
+  KronosValue *func_name = string_intern(name, strlen(name));
+  size_t name_idx = add_constant(c, func_name);
+  if (name_idx == SIZE_MAX) {
+    value_release(func_name);
+    return;
+  }
+  if (name_idx > UINT16_MAX) {
+    compiler_set_error(c, "Too many constants (limit 65535)");
+    return;
+  }
+  emit_byte(c, OP_CALL_FUNC);
+  emit_uint16(c, (uint16_t)name_idx);
+  emit_byte(c, (uint8_t)arg_count);
+}
+
+static void compile_expression(Compiler *c, ASTNode *node);
+
+// True for expressions that always produce a string
+static bool is_string_literal(const ASTNode *node) {
+  return node->type == AST_STRING || node->type == AST_FSTRING;
+}
+
+/**
+ * @brief Compile values and join their string forms with OP_BUILD_STRING
+ *
+ * Runs longer than the one-byte operand allows are joined in batches, each
+ * batch starting with the string built so far.
+ *
+ * @param c Compiler state
+ * @param parts Expressions to convert, in order
+ * @param count Number of expressions (at least 1)
+ * @param strict Reject values to_string cannot convert (f-strings), instead
+ * of treating them as "" like OP_ADD does
+ */
+static void emit_build_string(Compiler *c, ASTNode **parts, size_t count,
+                              bool strict) {
+  size_t pending = 0;
+  for (size_t i = 0; i < count; i++) {
+    compile_expression(c, parts[i]);
+    if (compiler_has_error(c))
+      return;
+    if (++pending == UINT8_MAX) {
+      emit_bytes(c, OP_BUILD_STRING, (uint8_t)pending);
+      emit_byte(c, strict);
+      pending = 1;
+    }
+  }
+  if (pending > 1 || count == 1) {
+    emit_bytes(c, OP_BUILD_STRING, (uint8_t)pending);
+    emit_byte(c, strict);
+  }
+}
+
+/**
+ * @brief Flatten a string concatenation chain
+ *
+ * `a plus b plus c` parses as ((a plus b) plus c). Once either of the first
+ * two operands is a string literal every addition in the chain concatenates,
+ * so the chain can be built with a single OP_BUILD_STRING. Shorter chains and
+ * chains that may add numbers are left to OP_ADD.
+ *
+ * @param c Compiler state (an allocation failure is reported here)
+ * @param node BINOP_ADD node at the top of the chain
+ * @param out Receives the operands, leftmost first (caller frees)
+ * @return Number of operands, or 0 if the chain should not be flattened
+ */
+static size_t concat_chain(Compiler *c, ASTNode *node, ASTNode ***out) {
+  size_t count = 1;
+  ASTNode *leftmost = node;
+  while (leftmost->type == AST_BINOP && leftmost->as.binop.op == BINOP_ADD) {
+    leftmost = leftmost->as.binop.left;
+    count++;
+  }
+  if (count < 3)
+    return 0;
+
+  ASTNode **leaves = mem_alloc(count * sizeof(ASTNode *));
+  if (!leaves) {
+    compiler_set_error(c, "Failed to allocate memory");
+    return 0;
+  }
+  size_t i = count;
+  for (ASTNode *n = node; n != leftmost; n = n->as.binop.left)
+    leaves[--i] = n->as.binop.right;
+  leaves[0] = leftmost;
+
+  if (!is_string_literal(leaves[0]) && !is_string_literal(leaves[1])) {
+    mem_free(leaves);
+    return 0;
+  }
+  *out = leaves;
+  return count;
+}
+
 /**
  * @brief Compile an expression AST node to bytecode
  *
@@ -320,93 +705,21 @@ static void compile_expression(Compiler *c, ASTNode *node) {
 
   case AST_STRING: {
     KronosValue *val =
-        value_new_string(node->as.string.value, node->as.string.length);
+        string_intern(node->as.string.value, node->as.string.length);
     emit_constant(c, val);
     break;
   }
 
-  case AST_FSTRING: {
-    // Compile f-string by concatenating parts
-    // parts alternate: string, expr, string, expr, ...
-    // Start with first string (or empty string if first is expr)
+  case AST_FSTRING:
+    // parts alternate string literals and expressions; OP_BUILD_STRING
+    // converts and joins them in one step
     if (node->as.fstring.part_count == 0) {
-      // Empty f-string
-      KronosValue *empty = value_new_string("", 0);
-      emit_constant(c, empty);
+      emit_constant(c, value_new_string("", 0));
       break;
     }
-
-    // Compile first part
-    ASTNode *first_part = node->as.fstring.parts[0];
-    if (first_part->type == AST_STRING) {
-      // First part is a string - emit it
-      compile_expression(c, first_part);
-      if (compiler_has_error(c))
-        return;
-    } else {
-      // First part is an expression - start with empty string
-      KronosValue *empty = value_new_string("", 0);
-      emit_constant(c, empty);
-      if (compiler_has_error(c))
-        return;
-      // Then compile expression, convert to string, and concatenate
-      compile_expression(c, first_part);
-      if (compiler_has_error(c))
-        return;
-
-      // Call to_string to convert expression result to string
-      KronosValue *to_string_name = value_new_string("to_string", 9);
-      size_t to_string_idx = add_constant(c, to_string_name);
-      if (to_string_idx == SIZE_MAX || to_string_idx > UINT16_MAX) {
-        value_release(to_string_name);
-        return;
-      }
-      emit_byte(c, OP_CALL_FUNC);
-      emit_uint16(c, (uint16_t)to_string_idx);
-      emit_byte(c, 1); // 1 argument
-      if (compiler_has_error(c))
-        return;
-
-      emit_byte(c, OP_ADD);
-      if (compiler_has_error(c))
-        return;
-    }
-
-    // Process remaining parts (pairs of expr, string)
-    for (size_t i = 1; i < node->as.fstring.part_count; i++) {
-      ASTNode *part = node->as.fstring.parts[i];
-
-      if (part->type == AST_STRING) {
-        // String literal - just compile it
-        compile_expression(c, part);
-        if (compiler_has_error(c))
-          return;
-      } else {
-        // Expression - compile it and convert to string
-        compile_expression(c, part);
-        if (compiler_has_error(c))
-          return;
-
-        // Call to_string to convert expression result to string
-        KronosValue *to_string_name = value_new_string("to_string", 9);
-        size_t to_string_idx = add_constant(c, to_string_name);
-        if (to_string_idx == SIZE_MAX || to_string_idx > UINT16_MAX) {
-          value_release(to_string_name);
-          return;
-        }
-        emit_byte(c, OP_CALL_FUNC);
-        emit_uint16(c, (uint16_t)to_string_idx);
-        emit_byte(c, 1); // 1 argument
-        if (compiler_has_error(c))
-          return;
-      }
-
-      emit_byte(c, OP_ADD); // Concatenate
-      if (compiler_has_error(c))
-        return;
-    }
+    emit_build_string(c, node->as.fstring.parts, node->as.fstring.part_count,
+                      true);
     break;
-  }
 
   case AST_BOOL: {
     KronosValue *val = value_new_bool(node->as.boolean);
@@ -422,7 +735,7 @@ static void compile_expression(Compiler *c, ASTNode *node) {
 
   case AST_VAR: {
     KronosValue *name =
-        value_new_string(node->as.var_name, strlen(node->as.var_name));
+        string_intern(node->as.var_name, strlen(node->as.var_name));
     size_t idx = add_constant(c, name);
     if (idx == SIZE_MAX) {
       value_release(name);
@@ -432,8 +745,7 @@ static void compile_expression(Compiler *c, ASTNode *node) {
       compiler_set_error(c, "Too many constants (limit 65535)");
       return;
     }
-    emit_byte(c, OP_LOAD_VAR);
-    emit_uint16(c, (uint16_t)idx);
+    emit_variable(c, OP_LOAD_VAR, idx);
     break;
   }
 
@@ -447,10 +759,46 @@ static void compile_expression(Compiler *c, ASTNode *node) {
       break;
     }
 
+    // and/or short-circuit: branch on the operands, then push the outcome
+    if (node->as.binop.op == BINOP_AND || node->as.binop.op == BINOP_OR) {
+      JumpList false_exits = {0};
+      emit_condition(c, node, false, &false_exits);
+      emit_constant(c, value_new_bool(true));
+      emit_bytes(c, OP_JUMP, 3); // Over the LOAD_CONST below
+      jump_list_patch(c, &false_exits);
+      emit_constant(c, value_new_bool(false));
+      jump_list_free(&false_exits);
+      break;
+    }
+
+    // "a" plus b plus c ...: join every operand at once
+    if (node->as.binop.op == BINOP_ADD) {
+      ASTNode **leaves = NULL;
+      size_t leaf_count = concat_chain(c, node, &leaves);
+      if (compiler_has_error(c))
+        return;
+      if (leaf_count > 0) {
+        emit_build_string(c, leaves, leaf_count, false);
+        mem_free(leaves);
+        break;
+      }
+    }
+
     // Compile left and right operands for binary operators
     compile_expression(c, node->as.binop.left);
     if (compiler_has_error(c))
       return;
+
+    // x plus/minus <number>: the constant rides along as an operand
+    if ((node->as.binop.op == BINOP_ADD || node->as.binop.op == BINOP_SUB) &&
+        node->as.binop.right && node->as.binop.right->type == AST_NUMBER) {
+      emit_constant_op(c,
+                       node->as.binop.op == BINOP_ADD ? OP_ADD_CONST
+                                                      : OP_SUB_CONST,
+                       value_new_number(node->as.binop.right->as.number));
+      break;
+    }
+
     compile_expression(c, node->as.binop.right);
     if (compiler_has_error(c))
       return;
@@ -487,12 +835,6 @@ static void compile_expression(Compiler *c, ASTNode *node) {
     case BINOP_LTE:
       emit_byte(c, OP_LTE);
       break;
-    case BINOP_AND:
-      emit_byte(c, OP_AND);
-      break;
-    case BINOP_OR:
-      emit_byte(c, OP_OR);
-      break;
     default: {
       // Report error for unsupported/unknown binary operator
       static char error_buf[128];
@@ -586,28 +928,172 @@ static void compile_expression(Compiler *c, ASTNode *node) {
     }
 
     // Emit call instruction
-    KronosValue *func_name =
-        value_new_string(node->as.call.name, strlen(node->as.call.name));
-    size_t name_idx = add_constant(c, func_name);
-    if (name_idx == SIZE_MAX) {
-      value_release(func_name);
+    emit_call(c, node->as.call.name, node->as.call.arg_count);
+    break;
+  }
+
+  default:
+    compiler_set_error(c, "Unknown expression node type");
+    break;
+  }
+}
+
+/**
+ * @brief Compile a condition as a forward branch
+ *
+ * Emits code that jumps when the condition's truth equals @p jump_if and
+ * falls through otherwise, consuming the condition on both paths; no bool is
+ * materialized. `and`, `or` and `not` become control flow, so the right
+ * operand of `and`/`or` runs only when the left one does not decide the
+ * result. A comparison fuses with the branch into one OP_JUMP_IF_NOT_*
+ * instruction where the semantics allow.
+ *
+ * @param c Compiler state
+ * @param condition Condition expression
+ * @param jump_if Truth value that takes the branch
+ * @param exits Receives the placeholder of every jump emitted to the target
+ */
+static void emit_condition(Compiler *c, ASTNode *condition, bool jump_if,
+                           JumpList *exits) {
+  if (compiler_has_error(c))
+    return;
+
+  if (condition && condition->type == AST_BINOP) {
+    BinOp op = condition->as.binop.op;
+    if (op == BINOP_NOT) {
+      emit_condition(c, condition->as.binop.left, !jump_if, exits);
       return;
     }
-    if (name_idx > UINT16_MAX) {
-      compiler_set_error(c, "Too many constants (limit 65535)");
+    if (op == BINOP_AND || op == BINOP_OR) {
+      // The left operand alone decides `and` when false, `or` when true
+      bool decides = op == BINOP_OR;
+      if (decides == jump_if) {
+        emit_condition(c, condition->as.binop.left, jump_if, exits);
+        emit_condition(c, condition->as.binop.right, jump_if, exits);
+      } else {
+        JumpList skip = {0};
+        emit_condition(c, condition->as.binop.left, decides, &skip);
+        emit_condition(c, condition->as.binop.right, jump_if, exits);
+        jump_list_patch(c, &skip);
+        jump_list_free(&skip);
+      }
       return;
     }
+  }
 
-    emit_byte(c, OP_CALL_FUNC);
-    emit_uint16(c, (uint16_t)name_idx);
-    emit_byte(c, (uint8_t)node->as.call.arg_count);
-    break;
+  // Equality inverts exactly; ordered comparisons keep their own branch only
+  // for jump-if-false, since an inverted one would differ on NaN
+  int fused = -1;
+  if (condition && condition->type == AST_BINOP) {
+    BinOp op = condition->as.binop.op;
+    if (!jump_if)
+      fused = compare_branch_op(op);
+    else if (op == BINOP_EQ || op == BINOP_NEQ)
+      fused = compare_branch_op(op == BINOP_EQ ? BINOP_NEQ : BINOP_EQ);
   }
 
-  default:
-    compiler_set_error(c, "Unknown expression node type");
-    break;
+  if (fused >= 0) {
+    compile_expression(c, condition->as.binop.left);
+    compile_expression(c, condition->as.binop.right);
+    emit_byte(c, (uint8_t)fused);
+  } else {
+    compile_expression(c, condition);
+    emit_byte(c, jump_if ? OP_JUMP_IF_TRUE : OP_JUMP_IF_FALSE);
+  }
+  jump_list_add(c, exits, c->bytecode->count);
+  emit_byte(c, 0);
+}
+
+/**
+ * @brief Emit `name = name + step` as a single increment instruction
+ *
+ * Equivalent to loading the variable, adding the constant and storing it back
+ * as a mutable, untyped variable (OP_STORE_* flags 1, 0).
+ *
+ * @param c Compiler state
+ * @param name_idx Constant pool index of the variable name
+ * @param step Number to add
+ */
+static void emit_increment(Compiler *c, size_t name_idx, double step) {
+  if (compiler_has_error(c))
+    return;
+  KronosValue *step_val = value_new_number(step);
+  size_t step_idx = add_constant(c, step_val);
+  if (step_idx == SIZE_MAX) {
+    value_release(step_val);
+    return;
+  }
+  if (step_idx > UINT16_MAX || name_idx > UINT16_MAX) {
+    compiler_set_error(c, "Too many constants (limit 65535)");
+    return;
+  }
+
+  if (c->scope) {
+    const char *name = c->bytecode->constants[name_idx]->as.string.data;
+    int slot = scope_declare(c, name);
+    if (slot < 0)
+      return;
+    emit_bytes(c, OP_INC_LOCAL, (uint8_t)slot);
+  } else {
+    int global = resolve_global(c, name_idx);
+    if (global < 0)
+      return;
+    emit_byte(c, OP_INC_GLOBAL);
+    emit_uint16(c, (uint16_t)global);
+  }
+  emit_uint16(c, (uint16_t)step_idx);
+}
+
+// True if an assignment is `let name to name plus <number>`
+static bool is_increment(const ASTNode *node) {
+  const ASTNode *value = node->as.assign.value;
+  return node->as.assign.is_mutable && !node->as.assign.type_name && value &&
+         value->type == AST_BINOP && value->as.binop.op == BINOP_ADD &&
+         value->as.binop.left && value->as.binop.left->type == AST_VAR &&
+         strcmp(value->as.binop.left->as.var_name, node->as.assign.name) ==
+             0 &&
+         value->as.binop.right && value->as.binop.right->type == AST_NUMBER;
+}
+
+// True if a block (outside nested function definitions) assigns name
+static bool block_assigns(ASTNode **block, size_t count, const char *name) {
+  for (size_t i = 0; i < count; i++) {
+    ASTNode *node = block[i];
+    if (!node)
+      continue;
+    switch (node->type) {
+    case AST_ASSIGN:
+      if (strcmp(node->as.assign.name, name) == 0)
+        return true;
+      break;
+    case AST_FOR:
+      if (strcmp(node->as.for_stmt.var, name) == 0 ||
+          block_assigns(node->as.for_stmt.block, node->as.for_stmt.block_size,
+                        name))
+        return true;
+      break;
+    case AST_WHILE:
+      if (block_assigns(node->as.while_stmt.block,
+                        node->as.while_stmt.block_size, name))
+        return true;
+      break;
+    case AST_IF:
+      if (block_assigns(node->as.if_stmt.block, node->as.if_stmt.block_size,
+                        name) ||
+          block_assigns(node->as.if_stmt.else_block,
+                        node->as.if_stmt.else_block_size, name))
+        return true;
+      for (size_t j = 0; j < node->as.if_stmt.else_if_count; j++) {
+        if (block_assigns(node->as.if_stmt.else_if_blocks[j],
+                          node->as.if_stmt.else_if_block_sizes[j], name))
+          return true;
+      }
+      break;
+    default:
+      break;
+    }
   }
+  return false;
 }
 
 /**
@@ -625,6 +1111,18 @@ static void compile_statement(Compiler *c, ASTNode *node) {
 
   switch (node->type) {
   case AST_ASSIGN: {
+    if (is_increment(node)) {
+      KronosValue *name =
+          string_intern(node->as.assign.name, strlen(node->as.assign.name));
+      size_t idx = add_constant(c, name);
+      if (idx == SIZE_MAX) {
+        value_release(name);
+        return;
+      }
+      emit_increment(c, idx, node->as.assign.value->as.binop.right->as.number);
+      break;
+    }
+
     // Compile value expression
     compile_expression(c, node->as.assign.value);
     if (compiler_has_error(c))
@@ -632,7 +1130,7 @@ static void compile_statement(Compiler *c, ASTNode *node) {
 
     // Store in variable
     KronosValue *name =
-        value_new_string(node->as.assign.name, strlen(node->as.assign.name));
+        string_intern(node->as.assign.name, strlen(node->as.assign.name));
     size_t idx = add_constant(c, name);
     if (idx == SIZE_MAX) {
       value_release(name);
@@ -642,8 +1140,7 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       compiler_set_error(c, "Too many constants (limit 65535)");
       return;
     }
-    emit_byte(c, OP_STORE_VAR);
-    emit_uint16(c, (uint16_t)idx);
+    emit_variable(c, OP_STORE_VAR, idx);
     if (compiler_has_error(c))
       return;
 
@@ -655,7 +1152,7 @@ static void compile_statement(Compiler *c, ASTNode *node) {
     // Emit type name if specified
     if (node->as.assign.type_name) {
       emit_byte(c, 1);
-      KronosValue *type_val = value_new_string(
+      KronosValue *type_val = string_intern(
           node->as.assign.type_name, strlen(node->as.assign.type_name));
       size_t type_idx = add_constant(c, type_val);
       if (type_idx == SIZE_MAX) {
@@ -688,210 +1185,48 @@ static void compile_statement(Compiler *c, ASTNode *node) {
     break;
   }
 
-  case AST_IF: {
-    // Compile condition
-    compile_expression(c, node->as.if_stmt.condition);
-    if (compiler_has_error(c))
-      return;
-
-    // Emit jump if false (placeholder for jump offset)
-    emit_byte(c, OP_JUMP_IF_FALSE);
-    size_t jump_offset_pos = c->bytecode->count;
-    emit_byte(c, 0); // Placeholder
-    if (compiler_has_error(c))
-      return;
-
-    // Compile if block
-    for (size_t i = 0; i < node->as.if_stmt.block_size; i++) {
-      compile_statement(c, node->as.if_stmt.block[i]);
-      if (compiler_has_error(c))
-        return;
-    }
-
-    // Collect all jump positions that need to be patched to point to next
-    // condition/else/end
-    size_t *jump_positions = NULL;
-    size_t jump_count = 0;
-    size_t jump_capacity = 0;
-
-    // Collect all skip jumps (jumps that skip to the end)
-    size_t *skip_jumps = NULL;
-    size_t skip_count = 0;
-    size_t skip_capacity = 0;
-
-    // Add the initial if jump (jump-if-false, should point to next
-    // else-if/else/end)
-    if (jump_count >= jump_capacity) {
-      size_t new_capacity = jump_capacity == 0 ? 4 : jump_capacity * 2;
-      size_t *new_positions =
-          realloc(jump_positions, sizeof(size_t) * new_capacity);
-      if (!new_positions) {
-        compiler_set_error(c, "Failed to allocate jump positions array");
-        return;
-      }
-      jump_positions = new_positions;
-      jump_capacity = new_capacity;
-    }
-    jump_positions[jump_count++] = jump_offset_pos;
-
-    // Only emit skip jump if there are else-if or else blocks
-    // For simple if statements, we don't need a skip jump
-    bool has_else_or_else_if = (node->as.if_stmt.else_if_count > 0 ||
-                                node->as.if_stmt.else_block_size > 0);
-
-    if (has_else_or_else_if) {
-      // Emit skip jump at end of if block (will be patched at the end)
-      emit_byte(c, OP_JUMP);
-      size_t if_skip_jump_pos = c->bytecode->count;
-      emit_byte(c, 0); // Placeholder
-      if (compiler_has_error(c)) {
-        free(jump_positions);
-        return;
-      }
-      if (skip_count >= skip_capacity) {
-        size_t new_capacity = skip_capacity == 0 ? 4 : skip_capacity * 2;
-        size_t *new_skips = realloc(skip_jumps, sizeof(size_t) * new_capacity);
-        if (!new_skips) {
-          compiler_set_error(c, "Failed to allocate skip jumps array");
-          free(jump_positions);
-          return;
-        }
-        skip_jumps = new_skips;
-        skip_capacity = new_capacity;
-      }
-      skip_jumps[skip_count++] = if_skip_jump_pos;
-    }
-
-    // Compile else-if chains
-    for (size_t i = 0; i < node->as.if_stmt.else_if_count; i++) {
-      // Emit jump to skip else-if block (will be patched immediately when we
-      // know where next block starts)
-      emit_byte(c, OP_JUMP);
-      size_t else_if_jump_pos = c->bytecode->count;
-      emit_byte(c, 0); // Placeholder
-      if (compiler_has_error(c)) {
-        free(jump_positions);
-        free(skip_jumps);
-        return;
-      }
-
-      // Patch previous jumps to point to this else-if condition
-      size_t else_if_start = c->bytecode->count;
-      for (size_t j = 0; j < jump_count; j++) {
-        size_t pos = jump_positions[j];
-        c->bytecode->code[pos] = (uint8_t)(else_if_start - pos - 1);
-      }
-      // Clear jump positions - we'll add new ones for this else-if
-      jump_count = 0;
-
-      // Compile else-if condition
-      compile_expression(c, node->as.if_stmt.else_if_conditions[i]);
-      if (compiler_has_error(c)) {
-        free(jump_positions);
-        free(skip_jumps);
-        return;
-      }
-
-      // Emit jump if false
-      emit_byte(c, OP_JUMP_IF_FALSE);
-      size_t else_if_jump_if_false_pos = c->bytecode->count;
-      emit_byte(c, 0); // Placeholder
-      if (compiler_has_error(c)) {
-        free(jump_positions);
-        free(skip_jumps);
-        return;
-      }
-
-      // Compile else-if block
-      for (size_t j = 0; j < node->as.if_stmt.else_if_block_sizes[i]; j++) {
-        compile_statement(c, node->as.if_stmt.else_if_blocks[i][j]);
-        if (compiler_has_error(c)) {
-          free(jump_positions);
-          free(skip_jumps);
-          return;
-        }
-      }
-
-      // Add skip jump to list (will be patched at the end)
-      if (skip_count >= skip_capacity) {
-        size_t new_capacity = skip_capacity == 0 ? 4 : skip_capacity * 2;
-        size_t *new_skips = realloc(skip_jumps, sizeof(size_t) * new_capacity);
-        if (!new_skips) {
-          compiler_set_error(c, "Failed to allocate skip jumps array");
-          free(jump_positions);
-          free(skip_jumps);
-          return;
-        }
-        skip_jumps = new_skips;
-        skip_capacity = new_capacity;
-      }
-      skip_jumps[skip_count++] = else_if_jump_pos;
-
-      // Add jump-if-false to list (should point to next else-if/else/end)
-      if (jump_count + 1 > jump_capacity) {
-        size_t new_capacity = jump_capacity == 0 ? 4 : jump_capacity * 2;
-        while (new_capacity < jump_count + 1) {
-          new_capacity *= 2;
-        }
-        size_t *new_positions =
-            realloc(jump_positions, sizeof(size_t) * new_capacity);
-        if (!new_positions) {
-          compiler_set_error(c, "Failed to allocate jump positions array");
-          free(jump_positions);
-          free(skip_jumps);
-          return;
-        }
-        jump_positions = new_positions;
-        jump_capacity = new_capacity;
-      }
-      jump_positions[jump_count++] = else_if_jump_if_false_pos;
-    }
-
-    // Compile else block (if present)
-    if (node->as.if_stmt.else_block_size > 0) {
-      // Patch all previous jumps (from if and else-if chains) to point to else
-      // block
-      size_t else_start = c->bytecode->count;
-      for (size_t j = 0; j < jump_count; j++) {
-        size_t pos = jump_positions[j];
-        c->bytecode->code[pos] = (uint8_t)(else_start - pos - 1);
-      }
-      jump_count = 0;
-
-      // Compile else block
-      for (size_t i = 0; i < node->as.if_stmt.else_block_size; i++) {
-        compile_statement(c, node->as.if_stmt.else_block[i]);
-        if (compiler_has_error(c)) {
-          free(jump_positions);
-          free(skip_jumps);
-          return;
-        }
+  case AST_IF: {
+    // A false condition falls through to the next else-if, the else block or
+    // the end; every block but the last jumps past the rest of the chain
+    JumpList next_branch = {0};
+    JumpList chain_end = {0};
+    size_t branch_count = 1 + node->as.if_stmt.else_if_count;
+    bool has_else = node->as.if_stmt.else_block_size > 0;
+
+    for (size_t i = 0; i < branch_count && !compiler_has_error(c); i++) {
+      ASTNode *condition = i == 0 ? node->as.if_stmt.condition
+                                  : node->as.if_stmt.else_if_conditions[i - 1];
+      ASTNode **block = i == 0 ? node->as.if_stmt.block
+                               : node->as.if_stmt.else_if_blocks[i - 1];
+      size_t block_size = i == 0 ? node->as.if_stmt.block_size
+                                 : node->as.if_stmt.else_if_block_sizes[i - 1];
+
+      jump_list_patch(c, &next_branch);
+      emit_condition(c, condition, false, &next_branch);
+      for (size_t j = 0; j < block_size && !compiler_has_error(c); j++)
+        compile_statement(c, block[j]);
+
+      if (i + 1 < branch_count || has_else) {
+        emit_byte(c, OP_JUMP);
+        jump_list_add(c, &chain_end, c->bytecode->count);
+        emit_byte(c, 0); // Placeholder
       }
     }
 
-    // Patch all skip jumps to point to end
-    size_t end_pos = c->bytecode->count;
-    for (size_t j = 0; j < skip_count; j++) {
-      size_t pos = skip_jumps[j];
-      c->bytecode->code[pos] = (uint8_t)(end_pos - pos - 1);
-    }
-
-    // If no else block, also patch jump-if-false jumps to end
-    if (node->as.if_stmt.else_block_size == 0) {
-      for (size_t j = 0; j < jump_count; j++) {
-        size_t pos = jump_positions[j];
-        c->bytecode->code[pos] = (uint8_t)(end_pos - pos - 1);
-      }
-    }
+    jump_list_patch(c, &next_branch);
+    for (size_t i = 0;
+         i < node->as.if_stmt.else_block_size && !compiler_has_error(c); i++)
+      compile_statement(c, node->as.if_stmt.else_block[i]);
+    jump_list_patch(c, &chain_end);
 
-    free(jump_positions);
-    free(skip_jumps);
+    jump_list_free(&next_branch);
+    jump_list_free(&chain_end);
     break;
   }
 
   case AST_FOR: {
     KronosValue *var_name =
-        value_new_string(node->as.for_stmt.var, strlen(node->as.for_stmt.var));
+        string_intern(node->as.for_stmt.var, strlen(node->as.for_stmt.var));
     size_t var_idx = add_constant(c, var_name);
     if (var_idx == SIZE_MAX) {
       value_release(var_name);
@@ -902,52 +1237,106 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       return;
     }
 
-    if (node->as.for_stmt.is_range) {
-      // Range iteration: for i in range start to end [by step]
-      // Initialize loop variable
+    if (node->as.for_stmt.is_range &&
+        !block_assigns(node->as.for_stmt.block, node->as.for_stmt.block_size,
+                       node->as.for_stmt.var)) {
+      // Counted loop: start, end and step are evaluated once and the
+      // iterator [counter, end, step] stays on the operand stack. The body
+      // never assigns the variable, so each pass just stores the counter
       compile_expression(c, node->as.for_stmt.iterable);
+      compile_expression(c, node->as.for_stmt.end);
+      if (node->as.for_stmt.step)
+        compile_expression(c, node->as.for_stmt.step);
+      else
+        emit_constant(c, value_new_number(1));
+      emit_byte(c, OP_RANGE_ITER);
+      if (compiler_has_error(c))
+        return;
+
+      // Loop start: push the counter, or exit with the iterator in place
+      size_t loop_start = c->bytecode->count;
+      emit_byte(c, OP_RANGE_NEXT);
+      size_t exit_jump_pos = c->bytecode->count;
+      emit_byte(c, 0); // Placeholder
       if (compiler_has_error(c))
         return;
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)var_idx);
+
+      if (!push_loop(c, loop_start)) {
+        return;
+      }
+      c->loop_stack->stack_values = 3;
+
+      emit_variable(c, OP_STORE_VAR, var_idx);
       emit_byte(c, 1); // for loop variables default mutable
       emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c))
+      for (size_t i = 0;
+           i < node->as.for_stmt.block_size && !compiler_has_error(c); i++) {
+        compile_statement(c, node->as.for_stmt.block[i]);
+      }
+
+      // Jump back to loop start
+      size_t offset = c->bytecode->count - loop_start + 2;
+      emit_bytes(c, OP_JUMP, (uint8_t)(-offset));
+      if (compiler_has_error(c)) {
+        pop_loop(c);
         return;
+      }
 
-      // Loop start
-      size_t loop_start = c->bytecode->count;
+      // Done: like the variable-driven loop, leave the variable holding the
+      // first value past the end
+      size_t exit_target = c->bytecode->count;
+      c->bytecode->code[exit_jump_pos] =
+          (uint8_t)(exit_target - exit_jump_pos - 1);
+      emit_byte(c, OP_POP); // pop step
+      emit_byte(c, OP_POP); // pop end
+      emit_variable(c, OP_STORE_VAR, var_idx);
+      emit_byte(c, 1);
+      emit_byte(c, 0);
+      emit_bytes(c, OP_JUMP, 3); // Over the break exit
+
+      // Break: the variable keeps its value
+      c->loop_stack->loop_end = c->bytecode->count;
+      patch_pending_jumps(c);
+      pop_loop(c);
+      emit_byte(c, OP_POP);
+      emit_byte(c, OP_POP);
+      emit_byte(c, OP_POP);
+    } else if (node->as.for_stmt.is_range) {
+      // Range iteration whose body assigns the loop variable: the variable
+      // itself is the counter, so the end is re-checked against it each pass.
+      // A nonzero literal step picks the comparison here; any other step is
+      // checked by OP_RANGE_TEST, which keeps it on the stack for the
+      // increment
+      ASTNode *step = node->as.for_stmt.step;
+      bool const_step =
+          !step || (step->type == AST_NUMBER && step->as.number != 0);
+      double step_value = step && const_step ? step->as.number : 1;
 
-      // Load loop variable and end value
-      emit_byte(c, OP_LOAD_VAR);
-      emit_uint16(c, (uint16_t)var_idx);
+      // Initialize loop variable
+      compile_expression(c, node->as.for_stmt.iterable);
       if (compiler_has_error(c))
         return;
-      compile_expression(c, node->as.for_stmt.end);
+      emit_variable(c, OP_STORE_VAR, var_idx);
+      emit_byte(c, 1); // for loop variables default mutable
+      emit_byte(c, 0); // no type annotation
       if (compiler_has_error(c))
         return;
 
-      // Determine step value (default to 1 if not specified)
-      // For now, we'll compile the step expression and use it
-      // If step is NULL, we'll use 1
-      bool has_step = (node->as.for_stmt.step != NULL);
-
-      // For comparison, we need to check direction based on step
-      // If step > 0: check var <= end
-      // If step < 0: check var >= end
-      // For now, we'll assume step is positive (default) and handle negative at
-      // runtime Actually, we can't know the sign at compile time if step is an
-      // expression So we'll always use <= and handle negative steps at runtime
-      // Or we can check if step is a constant and optimize
-
-      // For simplicity, always use <= for now
-      // TODO: Optimize for negative steps when step is a constant
-      emit_byte(c, OP_LTE);
+      // Loop start: exit once var has passed end (var <= end counting up,
+      // var >= end counting down)
+      size_t loop_start = c->bytecode->count;
+      emit_variable(c, OP_LOAD_VAR, var_idx);
       if (compiler_has_error(c))
         return;
-
-      // Jump if false (exit loop)
-      emit_byte(c, OP_JUMP_IF_FALSE);
+      compile_expression(c, node->as.for_stmt.end);
+      if (compiler_has_error(c))
+        return;
+      if (const_step) {
+        emit_byte(c, step_value > 0 ? OP_JUMP_IF_NOT_LTE : OP_JUMP_IF_NOT_GTE);
+      } else {
+        compile_expression(c, step);
+        emit_byte(c, OP_RANGE_TEST);
+      }
       size_t exit_jump_pos = c->bytecode->count;
       emit_byte(c, 0); // Placeholder
       if (compiler_has_error(c))
@@ -957,6 +1346,8 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       if (!push_loop(c, loop_start)) {
         return;
       }
+      if (!const_step)
+        c->loop_stack->stack_values = 1;
 
       // Compile loop body
       for (size_t i = 0; i < node->as.for_stmt.block_size; i++) {
@@ -972,36 +1363,17 @@ static void compile_statement(Compiler *c, ASTNode *node) {
         c->loop_stack->loop_continue = c->bytecode->count;
       }
 
-      // Increment loop variable by step
-      emit_byte(c, OP_LOAD_VAR);
-      emit_uint16(c, (uint16_t)var_idx);
-      if (compiler_has_error(c)) {
-        pop_loop(c);
-        return;
-      }
-
-      if (has_step) {
-        // Use the specified step value
-        compile_expression(c, node->as.for_stmt.step);
-        if (compiler_has_error(c)) {
-          pop_loop(c);
-          return;
-        }
+      // Increment loop variable by step (step + var for a step left on the
+      // stack by OP_RANGE_TEST)
+      if (const_step) {
+        emit_increment(c, var_idx, step_value);
       } else {
-        // Default step is 1
-        KronosValue *one = value_new_number(1);
-        emit_constant(c, one);
-        if (compiler_has_error(c)) {
-          pop_loop(c);
-          return;
-        }
+        emit_variable(c, OP_LOAD_VAR, var_idx);
+        emit_byte(c, OP_ADD);
+        emit_variable(c, OP_STORE_VAR, var_idx);
+        emit_byte(c, 1);
+        emit_byte(c, 0);
       }
-
-      emit_byte(c, OP_ADD);
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)var_idx);
-      emit_byte(c, 1);
-      emit_byte(c, 0);
       if (compiler_has_error(c)) {
         pop_loop(c);
         return;
@@ -1015,7 +1387,8 @@ static void compile_statement(Compiler *c, ASTNode *node) {
         return;
       }
 
-      // Patch exit jump and update loop end
+      // Patch exit jump and update loop end; exits and breaks both drop a
+      // step kept on the stack
       size_t exit_target = c->bytecode->count;
       c->bytecode->code[exit_jump_pos] =
           (uint8_t)(exit_target - exit_jump_pos - 1);
@@ -1027,81 +1400,22 @@ static void compile_statement(Compiler *c, ASTNode *node) {
 
       // Pop loop info
       pop_loop(c);
+      if (!const_step)
+        emit_byte(c, OP_POP);
     } else {
       // List iteration: for item in list_expr
-      // Compile list expression
+      // The iterator (list, index) stays on the operand stack for the whole
+      // loop; OP_LIST_NEXT advances it in place and pushes the next item
       compile_expression(c, node->as.for_stmt.iterable);
       if (compiler_has_error(c))
         return;
-
-      // Start iteration - pushes [list, index=0] onto stack
       emit_byte(c, OP_LIST_ITER);
       if (compiler_has_error(c))
         return;
 
-      // Store iterator state in hidden variables to preserve across loop body
-      // Create hidden variable names for iterator state
-      char iter_list_name[64];
-      char iter_index_name[64];
-      snprintf(iter_list_name, sizeof(iter_list_name), "__iter_list_%zu",
-               var_idx);
-      snprintf(iter_index_name, sizeof(iter_index_name), "__iter_index_%zu",
-               var_idx);
-
-      // Stack after OP_LIST_ITER: [list, index] with index on top
-      // Store index first (pops index)
-      KronosValue *iter_index_name_val =
-          value_new_string(iter_index_name, strlen(iter_index_name));
-      size_t iter_index_name_idx = add_constant(c, iter_index_name_val);
-      if (iter_index_name_idx == SIZE_MAX || iter_index_name_idx > UINT16_MAX) {
-        value_release(iter_index_name_val);
-        return;
-      }
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_index_name_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c))
-        return;
-
-      // Now store list (pops list)
-      KronosValue *iter_list_name_val =
-          value_new_string(iter_list_name, strlen(iter_list_name));
-      size_t iter_list_name_idx = add_constant(c, iter_list_name_val);
-      if (iter_list_name_idx == SIZE_MAX || iter_list_name_idx > UINT16_MAX) {
-        value_release(iter_list_name_val);
-        return;
-      }
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_list_name_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c))
-        return;
-
-      // Loop start
+      // Loop start: push the next item, or exit with the iterator in place
       size_t loop_start = c->bytecode->count;
-
-      // Restore iterator state from variables
-      emit_byte(c, OP_LOAD_VAR);
-      emit_uint16(c, (uint16_t)iter_list_name_idx);
-      if (compiler_has_error(c))
-        return;
-      emit_byte(c, OP_LOAD_VAR);
-      emit_uint16(c, (uint16_t)iter_index_name_idx);
-      if (compiler_has_error(c))
-        return;
-      // Stack: [list, index]
-
-      // Get next item
       emit_byte(c, OP_LIST_NEXT);
-      if (compiler_has_error(c))
-        return;
-
-      // Stack after OP_LIST_NEXT: [list, index+1, item, has_more]
-      // Check has_more flag (it's on top of stack)
-      // Note: OP_JUMP_IF_FALSE pops the condition, so we don't need OP_POP
-      emit_byte(c, OP_JUMP_IF_FALSE);
       size_t exit_jump_pos = c->bytecode->count;
       emit_byte(c, 0); // Placeholder
       if (compiler_has_error(c))
@@ -1111,33 +1425,10 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       if (!push_loop(c, loop_start)) {
         return;
       }
+      c->loop_stack->stack_values = 2;
 
-      // Stack now: [list, index+1, item] (OP_JUMP_IF_FALSE already popped
-      // has_more) Store item in loop variable (pops item)
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)var_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c)) {
-        pop_loop(c);
-        return;
-      }
-
-      // Stack now: [list, index+1] - save iterator state for next iteration
-      // Stack is [list, index+1] with index+1 on top
-      // Store updated index first (pops index+1)
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_index_name_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c)) {
-        pop_loop(c);
-        return;
-      }
-
-      // Store list (pops list)
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_list_name_idx);
+      // Store item in loop variable (pops item)
+      emit_variable(c, OP_STORE_VAR, var_idx);
       emit_byte(c, 1); // mutable
       emit_byte(c, 0); // no type annotation
       if (compiler_has_error(c)) {
@@ -1145,8 +1436,6 @@ static void compile_statement(Compiler *c, ASTNode *node) {
         return;
       }
 
-      // Stack is now empty - loop body can do whatever it wants
-
       // Compile loop body
       for (size_t i = 0; i < node->as.for_stmt.block_size; i++) {
         compile_statement(c, node->as.for_stmt.block[i]);
@@ -1177,33 +1466,9 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       // Pop loop info
       pop_loop(c);
 
-      // Clean up: pop index and list from stack
-      // Stack at exit: [list, index] (OP_JUMP_IF_FALSE already popped has_more)
+      // Every exit (done, break) arrives here with [list, index] on the stack
       emit_byte(c, OP_POP); // pop index
       emit_byte(c, OP_POP); // pop list
-
-      // Reset hidden iterator variables to null to release references
-      KronosValue *nil_val = value_new_nil();
-      emit_constant(c, nil_val);
-      if (compiler_has_error(c))
-        return;
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_list_name_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c))
-        return;
-
-      nil_val = value_new_nil();
-      emit_constant(c, nil_val);
-      if (compiler_has_error(c))
-        return;
-      emit_byte(c, OP_STORE_VAR);
-      emit_uint16(c, (uint16_t)iter_index_name_idx);
-      emit_byte(c, 1); // mutable
-      emit_byte(c, 0); // no type annotation
-      if (compiler_has_error(c))
-        return;
     }
     break;
   }
@@ -1212,20 +1477,17 @@ static void compile_statement(Compiler *c, ASTNode *node) {
     // Loop start
     size_t loop_start = c->bytecode->count;
 
-    // Compile condition
-    compile_expression(c, node->as.while_stmt.condition);
-    if (compiler_has_error(c))
-      return;
-
-    // Jump if false (exit loop)
-    emit_byte(c, OP_JUMP_IF_FALSE);
-    size_t exit_jump_pos = c->bytecode->count;
-    emit_byte(c, 0); // Placeholder
-    if (compiler_has_error(c))
+    // Compile condition; jump if false (exit loop)
+    JumpList exits = {0};
+    emit_condition(c, node->as.while_stmt.condition, false, &exits);
+    if (compiler_has_error(c)) {
+      jump_list_free(&exits);
       return;
+    }
 
     // Push loop info for break/continue
     if (!push_loop(c, loop_start)) {
+      jump_list_free(&exits);
       return;
     }
 
@@ -1234,6 +1496,7 @@ static void compile_statement(Compiler *c, ASTNode *node) {
       compile_statement(c, node->as.while_stmt.block[i]);
       if (compiler_has_error(c)) {
         pop_loop(c);
+        jump_list_free(&exits);
         return;
       }
     }
@@ -1243,13 +1506,14 @@ static void compile_statement(Compiler *c, ASTNode *node) {
     emit_bytes(c, OP_JUMP, (uint8_t)(-offset));
     if (compiler_has_error(c)) {
       pop_loop(c);
+      jump_list_free(&exits);
       return;
     }
 
     // Patch exit jump and update loop end
     size_t exit_target = c->bytecode->count;
-    c->bytecode->code[exit_jump_pos] =
-        (uint8_t)(exit_target - exit_jump_pos - 1);
+    jump_list_patch(c, &exits);
+    jump_list_free(&exits);
     if (c->loop_stack) {
       c->loop_stack->loop_end = exit_target;
       // Patch all pending break/continue jumps
@@ -1263,8 +1527,8 @@ static void compile_statement(Compiler *c, ASTNode *node) {
 
   case AST_FUNCTION: {
     // Store function name
-    KronosValue *func_name = value_new_string(node->as.function.name,
-                                              strlen(node->as.function.name));
+    KronosValue *func_name =
+        string_intern(node->as.function.name, strlen(node->as.function.name));
     size_t name_idx = add_constant(c, func_name);
     if (name_idx == SIZE_MAX) {
       value_release(func_name);
@@ -1286,7 +1550,7 @@ static void compile_statement(Compiler *c, ASTNode *node) {
 
     // Store parameter names as constants
     for (size_t i = 0; i < node->as.function.param_count; i++) {
-      KronosValue *param_name = value_new_string(
+      KronosValue *param_name = string_intern(
           node->as.function.params[i], strlen(node->as.function.params[i]));
       size_t param_idx = add_constant(c, param_name);
       if (param_idx == SIZE_MAX) {
@@ -1302,26 +1566,65 @@ static void compile_statement(Compiler *c, ASTNode *node) {
         return;
     }
 
+    // Lay out the frame: parameters first, then every assigned name
+    FunctionScope scope;
+    scope.slot_count = 0;
+    scope.enclosing = c->scope;
+    if (node->as.function.param_count > LOCALS_MAX) {
+      compiler_set_error(c, "Too many local variables in function (limit 64)");
+      return;
+    }
+    for (size_t i = 0; i < node->as.function.param_count; i++) {
+      scope.slots[scope.slot_count++] = node->as.function.params[i];
+    }
+    c->scope = &scope;
+    scope_collect(c, node->as.function.block, node->as.function.block_size);
+
+    // Loops around the definition are not loops of the body
+    LoopInfo *enclosing_loops = c->loop_stack;
+    c->loop_stack = NULL;
+
+    // Slot table: total slot count (patched after the body, which may add
+    // hidden loop slots) and the names of the non-parameter slots
+    size_t local_count_pos = c->bytecode->count;
+    emit_byte(c, 0); // Placeholder
+    size_t named_count = scope.slot_count - node->as.function.param_count;
+    emit_byte(c, (uint8_t)named_count);
+    for (size_t i = 0; i < named_count && !compiler_has_error(c); i++) {
+      const char *local = scope.slots[node->as.function.param_count + i];
+      KronosValue *local_name = string_intern(local, strlen(local));
+      size_t local_idx = add_constant(c, local_name);
+      if (local_idx == SIZE_MAX) {
+        value_release(local_name);
+        break;
+      }
+      if (local_idx > UINT16_MAX) {
+        compiler_set_error(c, "Too many constants (limit 65535)");
+        break;
+      }
+      emit_uint16(c, (uint16_t)local_idx);
+    }
+
     // Store function body start position
     size_t body_start = c->bytecode->count + 2; // +2 for jump instruction
     emit_byte(c, (uint8_t)(body_start >> 8));   // High byte
     emit_byte(c, (uint8_t)(body_start & 0xFF)); // Low byte
-    if (compiler_has_error(c))
-      return;
 
     // Emit jump over function body
     emit_byte(c, OP_JUMP);
     size_t skip_body_pos = c->bytecode->count;
     emit_byte(c, 0); // Placeholder
-    if (compiler_has_error(c))
-      return;
 
     // Compile function body
-    for (size_t i = 0; i < node->as.function.block_size; i++) {
+    for (size_t i = 0;
+         i < node->as.function.block_size && !compiler_has_error(c); i++) {
       compile_statement(c, node->as.function.block[i]);
-      if (compiler_has_error(c))
-        return;
     }
+    c->scope = scope.enclosing;
+    c->loop_stack = enclosing_loops;
+    if (compiler_has_error(c))
+      return;
+    c->bytecode->code[local_count_pos] = (uint8_t)scope.slot_count;
 
     // Implicit return nil if no explicit return
     KronosValue *nil_val = value_new_nil();
@@ -1348,25 +1651,8 @@ static void compile_statement(Compiler *c, ASTNode *node) {
         return;
     }
 
-    // Push function name
-    KronosValue *func_name =
-        value_new_string(node->as.call.name, strlen(node->as.call.name));
-    size_t name_idx = add_constant(c, func_name);
-    if (name_idx == SIZE_MAX) {
-      value_release(func_name);
-      return;
-    }
-
     // Call function
-    if (name_idx > UINT16_MAX) {
-      compiler_set_error(c, "Too many constants (limit 65535)");
-      return;
-    }
-    emit_byte(c, OP_CALL_FUNC);
-    emit_uint16(c, (uint16_t)name_idx);
-    if (compiler_has_error(c))
-      return;
-    emit_byte(c, (uint8_t)node->as.call.arg_count);
+    emit_call(c, node->as.call.name, node->as.call.arg_count);
     if (compiler_has_error(c))
       return;
 
@@ -1427,6 +1713,15 @@ static void compile_statement(Compiler *c, ASTNode *node) {
   }
 
   case AST_RETURN: {
+    // Drop the iterators of enclosing list loops; the caller's stack must
+    // get back exactly the return value
+    if (c->scope) {
+      for (LoopInfo *loop = c->loop_stack; loop; loop = loop->next) {
+        for (size_t i = 0; i < loop->stack_values; i++)
+          emit_byte(c, OP_POP);
+      }
+    }
+
     // Compile return value
     compile_expression(c, node->as.return_stmt.value);
     if (compiler_has_error(c))
@@ -1443,6 +1738,120 @@ static void compile_statement(Compiler *c, ASTNode *node) {
   }
 }
 
+// Built-in names, indexed by BuiltinId
+static const char *const builtin_names[BUILTIN_COUNT] = {
+    [BUILTIN_READ_FILE] = "read_file",
+    [BUILTIN_ADD] = "add",
+    [BUILTIN_SUBTRACT] = "subtract",
+    [BUILTIN_MULTIPLY] = "multiply",
+    [BUILTIN_DIVIDE] = "divide",
+    [BUILTIN_LEN] = "len",
+    [BUILTIN_UPPERCASE] = "uppercase",
+    [BUILTIN_LOWERCASE] = "lowercase",
+    [BUILTIN_TRIM] = "trim",
+    [BUILTIN_SPLIT] = "split",
+    [BUILTIN_JOIN] = "join",
+    [BUILTIN_TO_STRING] = "to_string",
+    [BUILTIN_CONTAINS] = "contains",
+    [BUILTIN_STARTS_WITH] = "starts_with",
+    [BUILTIN_ENDS_WITH] = "ends_with",
+    [BUILTIN_REPLACE] = "replace",
+    [BUILTIN_SQRT] = "sqrt",
+    [BUILTIN_POWER] = "power",
+    [BUILTIN_ABS] = "abs",
+    [BUILTIN_ROUND] = "round",
+    [BUILTIN_FLOOR] = "floor",
+    [BUILTIN_CEIL] = "ceil",
+    [BUILTIN_RAND] = "rand",
+    [BUILTIN_MIN] = "min",
+    [BUILTIN_MAX] = "max",
+    [BUILTIN_TO_NUMBER] = "to_number",
+    [BUILTIN_TO_BOOL] = "to_bool",
+    [BUILTIN_REVERSE] = "reverse",
+    [BUILTIN_SORT] = "sort",
+};
+
+int builtin_lookup(const char *name) {
+  if (!name)
+    return -1;
+  // The math module is an alias for the global built-ins
+  if (strncmp(name, "math.", 5) == 0)
+    name += 5;
+  for (int i = 0; i < BUILTIN_COUNT; i++) {
+    if (strcmp(builtin_names[i], name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+const char *builtin_name(BuiltinId id) {
+  if ((unsigned)id >= BUILTIN_COUNT)
+    return "?";
+  return builtin_names[id];
+}
+
+// Opcode mnemonics, indexed by OpCode
+static const char *const opcode_names[OP_HALT + 1] = {
+    [OP_LOAD_CONST] = "LOAD_CONST",
+    [OP_LOAD_VAR] = "LOAD_VAR",
+    [OP_STORE_VAR] = "STORE_VAR",
+    [OP_PRINT] = "PRINT",
+    [OP_ADD] = "ADD",
+    [OP_SUB] = "SUB",
+    [OP_MUL] = "MUL",
+    [OP_DIV] = "DIV",
+    [OP_EQ] = "EQ",
+    [OP_NEQ] = "NEQ",
+    [OP_GT] = "GT",
+    [OP_LT] = "LT",
+    [OP_GTE] = "GTE",
+    [OP_LTE] = "LTE",
+    [OP_NOT] = "NOT",
+    [OP_JUMP] = "JUMP",
+    [OP_JUMP_IF_FALSE] = "JUMP_IF_FALSE",
+    [OP_JUMP_IF_TRUE] = "JUMP_IF_TRUE",
+    [OP_BREAK] = "BREAK",
+    [OP_CONTINUE] = "CONTINUE",
+    [OP_DEFINE_FUNC] = "DEFINE_FUNC",
+    [OP_CALL_FUNC] = "CALL_FUNC",
+    [OP_RETURN_VAL] = "RETURN_VAL",
+    [OP_POP] = "POP",
+    [OP_LIST_NEW] = "LIST_NEW",
+    [OP_LIST_GET] = "LIST_GET",
+    [OP_LIST_SET] = "LIST_SET",
+    [OP_LIST_APPEND] = "LIST_APPEND",
+    [OP_LIST_LEN] = "LIST_LEN",
+    [OP_LIST_SLICE] = "LIST_SLICE",
+    [OP_LIST_ITER] = "LIST_ITER",
+    [OP_LIST_NEXT] = "LIST_NEXT",
+    [OP_RANGE_ITER] = "RANGE_ITER",
+    [OP_RANGE_NEXT] = "RANGE_NEXT",
+    [OP_RANGE_TEST] = "RANGE_TEST",
+    [OP_LOAD_LOCAL] = "LOAD_LOCAL",
+    [OP_STORE_LOCAL] = "STORE_LOCAL",
+    [OP_LOAD_GLOBAL] = "LOAD_GLOBAL",
+    [OP_STORE_GLOBAL] = "STORE_GLOBAL",
+    [OP_CALL_BUILTIN] = "CALL_BUILTIN",
+    [OP_BUILD_STRING] = "BUILD_STRING",
+    [OP_ADD_CONST] = "ADD_CONST",
+    [OP_SUB_CONST] = "SUB_CONST",
+    [OP_INC_LOCAL] = "INC_LOCAL",
+    [OP_INC_GLOBAL] = "INC_GLOBAL",
+    [OP_JUMP_IF_NOT_EQ] = "JUMP_IF_NOT_EQ",
+    [OP_JUMP_IF_NOT_NEQ] = "JUMP_IF_NOT_NEQ",
+    [OP_JUMP_IF_NOT_GT] = "JUMP_IF_NOT_GT",
+    [OP_JUMP_IF_NOT_LT] = "JUMP_IF_NOT_LT",
+    [OP_JUMP_IF_NOT_GTE] = "JUMP_IF_NOT_GTE",
+    [OP_JUMP_IF_NOT_LTE] = "JUMP_IF_NOT_LTE",
+    [OP_HALT] = "HALT",
+};
+
+const char *opcode_name(uint8_t op) {
+  if (op > OP_HALT || !opcode_names[op])
+    return "?";
+  return opcode_names[op];
+}
+
 /**
  * @brief Compile an AST to bytecode
  *
@@ -1466,7 +1875,10 @@ Bytecode *compile(AST *ast, const char **out_err) {
   Compiler c;
   c.error_message = NULL;
   c.loop_stack = NULL;
-  c.bytecode = malloc(sizeof(Bytecode));
+  c.scope = NULL;
+  c.global_index = NULL;
+  c.global_index_capacity = 0;
+  c.bytecode = mem_alloc(sizeof(Bytecode));
   if (!c.bytecode) {
     if (out_err)
       *out_err = "Failed to allocate bytecode structure";
@@ -1476,9 +1888,9 @@ Bytecode *compile(AST *ast, const char **out_err) {
   // Initialize bytecode
   c.bytecode->capacity = 256;
   c.bytecode->count = 0;
-  c.bytecode->code = malloc(c.bytecode->capacity);
+  c.bytecode->code = mem_alloc(c.bytecode->capacity);
   if (!c.bytecode->code) {
-    free(c.bytecode);
+    mem_free(c.bytecode);
     if (out_err)
       *out_err = "Failed to allocate bytecode buffer";
     return NULL;
@@ -1486,11 +1898,14 @@ Bytecode *compile(AST *ast, const char **out_err) {
 
   c.bytecode->const_capacity = 32;
   c.bytecode->const_count = 0;
+  c.bytecode->globals = NULL;
+  c.bytecode->global_count = 0;
+  c.bytecode->global_capacity = 0;
   c.bytecode->constants =
-      malloc(sizeof(KronosValue *) * c.bytecode->const_capacity);
+      mem_alloc(sizeof(KronosValue *) * c.bytecode->const_capacity);
   if (!c.bytecode->constants) {
-    free(c.bytecode->code);
-    free(c.bytecode);
+    mem_free(c.bytecode->code);
+    mem_free(c.bytecode);
     if (out_err)
       *out_err = "Failed to allocate constant pool";
     return NULL;
@@ -1505,6 +1920,7 @@ Bytecode *compile(AST *ast, const char **out_err) {
   if (!compiler_has_error(&c)) {
     emit_byte(&c, OP_HALT);
   }
+  mem_free(c.global_index);
 
   if (compiler_has_error(&c)) {
     if (out_err)
@@ -1531,10 +1947,11 @@ void bytecode_free(Bytecode *bytecode) {
   for (size_t i = 0; i < bytecode->const_count; i++) {
     value_release(bytecode->constants[i]);
   }
-  free(bytecode->constants);
+  mem_free(bytecode->constants);
+  mem_free(bytecode->globals);
 
-  free(bytecode->code);
-  free(bytecode);
+  mem_free(bytecode->code);
+  mem_free(bytecode);
 }
 
 /**
@@ -1559,6 +1976,11 @@ void bytecode_print(Bytecode *bytecode) {
     printf("\n");
   }
 
+  printf("Globals (%zu):\n", bytecode->global_count);
+  for (size_t i = 0; i < bytecode->global_count; i++) {
+    printf("  [%zu] const %u\n", i, bytecode->globals[i]);
+  }
+
   printf("\nInstructions (%zu bytes):\n", bytecode->count);
   size_t offset = 0;
   while (offset < bytecode->count) {
@@ -1640,14 +2062,6 @@ void bytecode_print(Bytecode *bytecode) {
       printf("LTE\n");
       offset++;
       break;
-    case OP_AND:
-      printf("AND\n");
-      offset++;
-      break;
-    case OP_OR:
-      printf("OR\n");
-      offset++;
-      break;
     case OP_NOT:
       printf("NOT\n");
       offset++;
@@ -1660,13 +2074,20 @@ void bytecode_print(Bytecode *bytecode) {
       printf("JUMP_IF_FALSE %d\n", bytecode->code[offset + 1]);
       offset += 2;
       break;
+    case OP_JUMP_IF_TRUE:
+      printf("JUMP_IF_TRUE %d\n", bytecode->code[offset + 1]);
+      offset += 2;
+      break;
     case OP_DEFINE_FUNC: {
       uint16_t name_idx = (uint16_t)(bytecode->code[offset + 1] << 8 |
                                      bytecode->code[offset + 2]);
       uint8_t param_count = bytecode->code[offset + 3];
-      printf("DEFINE_FUNC %u (param_count=%u)\n", name_idx, param_count);
-      size_t skip = 4 + (size_t)param_count * 2 + 2 + 2;
-      offset += skip;
+      size_t table = offset + 4 + (size_t)param_count * 2;
+      uint8_t local_count = bytecode->code[table];
+      uint8_t named_count = bytecode->code[table + 1];
+      printf("DEFINE_FUNC %u (param_count=%u, local_count=%u)\n", name_idx,
+             param_count, local_count);
+      offset = table + 2 + (size_t)named_count * 2 + 2 + 2;
       break;
     }
     case OP_CALL_FUNC: {
@@ -1725,10 +2146,121 @@ void bytecode_print(Bytecode *bytecode) {
       break;
 
     case OP_LIST_NEXT:
-      printf("LIST_NEXT\n");
+      printf("LIST_NEXT %u\n", bytecode->code[offset + 1]);
+      offset += 2;
+      break;
+
+    case OP_RANGE_ITER:
+      printf("RANGE_ITER\n");
       offset++;
       break;
 
+    case OP_RANGE_NEXT:
+      printf("RANGE_NEXT %u\n", bytecode->code[offset + 1]);
+      offset += 2;
+      break;
+
+    case OP_RANGE_TEST:
+      printf("RANGE_TEST %u\n", bytecode->code[offset + 1]);
+      offset += 2;
+      break;
+
+    case OP_LOAD_LOCAL:
+      printf("LOAD_LOCAL %u\n", bytecode->code[offset + 1]);
+      offset += 2;
+      break;
+
+    case OP_STORE_LOCAL: {
+      uint8_t slot = bytecode->code[offset + 1];
+      uint8_t is_mutable = bytecode->code[offset + 2];
+      uint8_t has_type = bytecode->code[offset + 3];
+      printf("STORE_LOCAL slot=%u mutable=%u", slot, is_mutable);
+      offset += 4;
+      if (has_type) {
+        uint16_t type_idx = (uint16_t)(bytecode->code[offset] << 8 |
+                                       bytecode->code[offset + 1]);
+        printf(" type=%u", type_idx);
+        offset += 2;
+      }
+      printf("\n");
+      break;
+    }
+
+    case OP_LOAD_GLOBAL: {
+      uint16_t idx = (uint16_t)(bytecode->code[offset + 1] << 8 |
+                                bytecode->code[offset + 2]);
+      printf("LOAD_GLOBAL %u\n", idx);
+      offset += 3;
+      break;
+    }
+
+    case OP_STORE_GLOBAL: {
+      uint16_t idx = (uint16_t)(bytecode->code[offset + 1] << 8 |
+                                bytecode->code[offset + 2]);
+      uint8_t is_mutable = bytecode->code[offset + 3];
+      uint8_t has_type = bytecode->code[offset + 4];
+      printf("STORE_GLOBAL %u mutable=%u", idx, is_mutable);
+      offset += 5;
+      if (has_type) {
+        uint16_t type_idx = (uint16_t)(bytecode->code[offset] << 8 |
+                                       bytecode->code[offset + 1]);
+        printf(" type=%u", type_idx);
+        offset += 2;
+      }
+      printf("\n");
+      break;
+    }
+
+    case OP_CALL_BUILTIN:
+      printf("CALL_BUILTIN %s (arg_count=%u)\n",
+             builtin_name((BuiltinId)bytecode->code[offset + 1]),
+             bytecode->code[offset + 2]);
+      offset += 3;
+      break;
+
+    case OP_BUILD_STRING:
+      printf("BUILD_STRING %u strict=%u\n", bytecode->code[offset + 1],
+             bytecode->code[offset + 2]);
+      offset += 3;
+      break;
+
+    case OP_ADD_CONST:
+    case OP_SUB_CONST: {
+      uint16_t idx = (uint16_t)(bytecode->code[offset + 1] << 8 |
+                                bytecode->code[offset + 2]);
+      printf("%s %u\n", opcode_name(instruction), idx);
+      offset += 3;
+      break;
+    }
+
+    case OP_INC_LOCAL: {
+      uint16_t idx = (uint16_t)(bytecode->code[offset + 2] << 8 |
+                                bytecode->code[offset + 3]);
+      printf("INC_LOCAL slot=%u const=%u\n", bytecode->code[offset + 1], idx);
+      offset += 4;
+      break;
+    }
+
+    case OP_INC_GLOBAL: {
+      uint16_t global = (uint16_t)(bytecode->code[offset + 1] << 8 |
+                                   bytecode->code[offset + 2]);
+      uint16_t idx = (uint16_t)(bytecode->code[offset + 3] << 8 |
+                                bytecode->code[offset + 4]);
+      printf("INC_GLOBAL %u const=%u\n", global, idx);
+      offset += 5;
+      break;
+    }
+
+    case OP_JUMP_IF_NOT_EQ:
+    case OP_JUMP_IF_NOT_NEQ:
+    case OP_JUMP_IF_NOT_GT:
+    case OP_JUMP_IF_NOT_LT:
+    case OP_JUMP_IF_NOT_GTE:
+    case OP_JUMP_IF_NOT_LTE:
+      printf("%s %d\n", opcode_name(instruction), bytecode->code[offset + 1]);
+      offset += 2;
+      break;
+
     case OP_HALT:
       printf("HALT\n");
       offset++;
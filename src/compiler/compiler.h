@@ -4,6 +4,9 @@
 #include "../core/runtime.h"
 #include "../frontend/parser.h"
 
+// Maximum frame slots per function (parameters plus locals)
+#define LOCALS_MAX 64
+
 // Bytecode instructions
 typedef enum {
   OP_LOAD_CONST,    // Load constant from pool
@@ -20,11 +23,10 @@ typedef enum {
   OP_LT,            // Less than
   OP_GTE,           // Greater than or equal
   OP_LTE,           // Less than or equal
-  OP_AND,           // Logical AND (short-circuit)
-  OP_OR,            // Logical OR (short-circuit)
   OP_NOT,           // Logical NOT (unary)
   OP_JUMP,          // Unconditional jump
   OP_JUMP_IF_FALSE, // Jump if top of stack is false
+  OP_JUMP_IF_TRUE,  // Jump if top of stack is true
   OP_BREAK,         // Break out of loop
   OP_CONTINUE,      // Continue to next loop iteration
   OP_DEFINE_FUNC,   // Define function
@@ -37,11 +39,66 @@ typedef enum {
   OP_LIST_APPEND,   // Append element (list, value -> list)
   OP_LIST_LEN,      // Get list/string length (list/string -> length)
   OP_LIST_SLICE,    // Slice list/string (container, start, end -> slice)
-  OP_LIST_ITER,     // Start list iteration (list -> iterator)
-  OP_LIST_NEXT,     // Get next item from iterator (iterator -> item, has_more)
+  OP_LIST_ITER,     // Start list iteration (list -> list, index 0)
+  OP_LIST_NEXT,     // Advance iterator, or jump when done (arg: forward offset)
+  OP_RANGE_ITER,    // Start counted loop (start, end, step -> iterator)
+  OP_RANGE_NEXT,    // Push counter and advance, or jump when done (arg: offset)
+  OP_RANGE_TEST,    // Check a range loop counter, keeping step (arg: offset)
+  OP_LOAD_LOCAL,    // Load function frame slot (arg: slot index)
+  OP_STORE_LOCAL,   // Store function frame slot (arg: slot index, flags)
+  OP_LOAD_GLOBAL,   // Load global (arg: index into Bytecode.globals)
+  OP_STORE_GLOBAL,  // Store global (arg: index into Bytecode.globals, flags)
+  OP_CALL_BUILTIN,  // Call built-in function (arg: BuiltinId, arg count)
+  OP_BUILD_STRING,  // Join string forms of values (arg: value count, strict)
+  // Superinstructions: fused forms of the hottest opcode sequences (see
+  // KRONOS_OPCODE_STATS in vm.c)
+  OP_ADD_CONST,       // LOAD_CONST + ADD (arg: constant index)
+  OP_SUB_CONST,       // LOAD_CONST + SUB (arg: constant index)
+  OP_INC_LOCAL,       // slot = slot + number (arg: slot, constant index)
+  OP_INC_GLOBAL,      // global = global + number (arg: global, constant index)
+  OP_JUMP_IF_NOT_EQ,  // EQ + JUMP_IF_FALSE (arg: forward offset)
+  OP_JUMP_IF_NOT_NEQ, // NEQ + JUMP_IF_FALSE (arg: forward offset)
+  OP_JUMP_IF_NOT_GT,  // GT + JUMP_IF_FALSE (arg: forward offset)
+  OP_JUMP_IF_NOT_LT,  // LT + JUMP_IF_FALSE (arg: forward offset)
+  OP_JUMP_IF_NOT_GTE, // GTE + JUMP_IF_FALSE (arg: forward offset)
+  OP_JUMP_IF_NOT_LTE, // LTE + JUMP_IF_FALSE (arg: forward offset)
   OP_HALT,          // End program
 } OpCode;
 
+// Built-in functions, in dispatch table order (see builtin_lookup)
+typedef enum {
+  BUILTIN_READ_FILE,
+  BUILTIN_ADD,
+  BUILTIN_SUBTRACT,
+  BUILTIN_MULTIPLY,
+  BUILTIN_DIVIDE,
+  BUILTIN_LEN,
+  BUILTIN_UPPERCASE,
+  BUILTIN_LOWERCASE,
+  BUILTIN_TRIM,
+  BUILTIN_SPLIT,
+  BUILTIN_JOIN,
+  BUILTIN_TO_STRING,
+  BUILTIN_CONTAINS,
+  BUILTIN_STARTS_WITH,
+  BUILTIN_ENDS_WITH,
+  BUILTIN_REPLACE,
+  BUILTIN_SQRT,
+  BUILTIN_POWER,
+  BUILTIN_ABS,
+  BUILTIN_ROUND,
+  BUILTIN_FLOOR,
+  BUILTIN_CEIL,
+  BUILTIN_RAND,
+  BUILTIN_MIN,
+  BUILTIN_MAX,
+  BUILTIN_TO_NUMBER,
+  BUILTIN_TO_BOOL,
+  BUILTIN_REVERSE,
+  BUILTIN_SORT,
+  BUILTIN_COUNT
+} BuiltinId;
+
 // Bytecode representation
 typedef struct {
   uint8_t *code;
@@ -52,6 +109,13 @@ typedef struct {
   KronosValue **constants;
   size_t const_count;
   size_t const_capacity;
+
+  // Global names referenced by OP_LOAD_GLOBAL/OP_STORE_GLOBAL, as constant
+  // pool indices (one entry per distinct name). The VM links each entry to
+  // its global table slot before running the code.
+  uint16_t *globals;
+  size_t global_count;
+  size_t global_capacity;
 } Bytecode;
 
 /**
@@ -80,6 +144,34 @@ typedef struct {
  */
 Bytecode *compile(AST *ast, const char **out_err);
 
+/**
+ * @brief Resolve a function name to a built-in function ID.
+ *
+ * Accepts plain names ("sqrt") and names qualified with the built-in math
+ * module ("math.sqrt"). Built-ins take precedence over user-defined functions
+ * of the same name.
+ *
+ * @param name Function name as written at the call site (must not be NULL).
+ * @return The BuiltinId, or -1 if @p name is not a built-in.
+ */
+int builtin_lookup(const char *name);
+
+/**
+ * @brief Get the name of a built-in function.
+ *
+ * @param id Built-in function ID.
+ * @return Static name string, or "?" if @p id is out of range.
+ */
+const char *builtin_name(BuiltinId id);
+
+/**
+ * @brief Get the mnemonic of an opcode (without the OP_ prefix).
+ *
+ * @param op Opcode byte.
+ * @return Static name string, or "?" if @p op is not an opcode.
+ */
+const char *opcode_name(uint8_t op);
+
 /**
  * @brief Free a Bytecode structure and all associated resources.
  *
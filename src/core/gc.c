@@ -2,228 +2,682 @@
  * @file gc.c
  * @brief Garbage collection and memory tracking
  *
- * Provides reference-counting based garbage collection for Kronos values.
- * Tracks all allocated objects and provides statistics. Thread-safe using
- * mutexes for concurrent access.
+ * Provides reference-counting based garbage collection for Kronos values,
+ * with a synchronous cycle collector for lists that reference each other.
+ * Tracks all allocated objects and provides statistics:
+ * - tracking only flags the object and stamps it with the current epoch, so
+ *   there is no shared list or table to update
+ * - object and byte counts live in per-thread counter blocks written only by
+ *   their thread and summed on read, so gc_track() and gc_untrack() take no
+ *   lock
+ * - each thread buffers its cycle roots in its own block, so releasing a
+ *   list takes no lock either; a collection runs over the calling thread's
+ *   roots only, with the thread's own traversal stacks, and is triggered by
+ *   the thread's own allocations
+ * - only the cycle collector's statistics are shared, protected by gc_mutex
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "gc.h"
 #include <pthread.h>
-#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+/** Growable array of objects used by the cycle collector */
+typedef struct {
+  KronosValue **items;
+  size_t count;
+  size_t capacity;
+} GCStack;
 
-/** Initial capacity for the object tracking array */
-#define INITIAL_TRACKED_CAPACITY 1024
+/**
+ * Allocation counters and cycle roots of one thread
+ *
+ * Only the thread that owns a block writes it, and readers sum every block,
+ * hence relaxed atomics. Objects freed on another thread than the one that
+ * allocated them make individual blocks wrap below zero, but the unsigned
+ * sum over all blocks is still exact. Blocks are never freed: a block whose
+ * thread exited keeps its counts and is reused by the next new thread.
+ */
+typedef struct GCCounters {
+  _Atomic size_t objects;  /**< Objects tracked minus objects untracked */
+  _Atomic size_t bytes;    /**< Bytes tracked minus bytes untracked */
+  size_t allocations;      /**< Owner's gc_track() calls since it last ran
+                                the cycle collector */
+  size_t threshold;        /**< Allocations that trigger the owner's next
+                                run */
+  GCBudget *budget;        /**< Heap budget charged by the owner, if any */
+  GCStack roots;           /**< Lists the owner buffered as candidate cycle
+                                roots (VALUE_FLAG_BUFFERED) */
+  GCStack work;            /**< Traversal stacks of the owner's runs */
+  GCStack restore;
+  atomic_bool in_use;      /**< Owned by a running thread */
+  struct GCCounters *next; /**< Next block in gc_counters */
+} GCCounters;
 
 /**
  * Garbage collector state
- * Tracks all allocated KronosValue objects for leak detection and statistics
+ * Holds the cycle collector's shared state. Object counts and cycle roots
+ * are kept in the per-thread GCCounters blocks instead.
  */
 typedef struct {
-  KronosValue **objects;  /**< Array of tracked object pointers */
-  size_t count;           /**< Number of currently tracked objects */
-  size_t capacity;        /**< Capacity of the objects array */
-  size_t allocated_bytes; /**< Total bytes allocated (approximate) */
+  GCStats stats; /**< Cycle collector counters */
 } GCState;
 
 /** Global GC state (protected by gc_mutex) */
-static GCState gc_state = {0};
+static GCState gc_state;
 
-/** Mutex for thread-safe GC operations */
+/** Mutex for the collector statistics and the detach baseline */
 static pthread_mutex_t gc_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-static void gc_abort_allocation(void) {
-  fprintf(stderr,
-          "Fatal: Failed to grow GC tracking table (current count: %zu, "
-          "capacity: %zu)\n",
-          gc_state.count, gc_state.capacity);
-  fflush(stderr);
-  abort();
+/** Every counter block ever created (push-only) */
+static _Atomic(GCCounters *) gc_counters = NULL;
+
+/** Releases the block of an exiting thread */
+static pthread_key_t gc_key;
+static pthread_once_t gc_key_once = PTHREAD_ONCE_INIT;
+
+/** This thread's counter block (NULL until its first track or untrack) */
+static _Thread_local GCCounters *gc_local = NULL;
+
+/** Current tracking epoch; objects stamped with an older one are detached */
+static _Atomic uint32_t gc_epoch = 1;
+
+/** Counter sums at the last detach, subtracted from every read */
+static size_t gc_base_objects;
+static size_t gc_base_bytes;
+
+/** Cycle collector colors stored in VALUE_FLAG_GC_COLOR */
+#define GC_BLACK 0x00u /**< In use, or not visited by the current run */
+#define GC_GRAY 0x20u  /**< Internal references subtracted */
+#define GC_WHITE 0x40u /**< Reachable only through subtracted references */
+
+/**
+ * @brief Bytes accounted to a tracked object
+ *
+ * Must return the same value at track and untrack time, so a string or list
+ * whose storage changes size while tracked reports it with gc_resize().
+ *
+ * @param val Tracked object
+ * @return Accounted size in bytes
+ */
+static size_t gc_object_size(const KronosValue *val) {
+  size_t size = sizeof(KronosValue);
+  if (val->type == VAL_STRING) {
+    size += val->as.string.capacity + 1;
+  } else if (val->type == VAL_LIST) {
+    size += val->as.list.capacity * sizeof(Value);
+  } else if (val->type == VAL_FUNCTION) {
+    size += val->as.function.length;
+  }
+  return size;
 }
 
-static void gc_ensure_capacity_locked(size_t min_capacity) {
-  if (gc_state.capacity >= min_capacity)
-    return;
+// Add delta to a counter written only by the calling thread
+static inline void counter_add(_Atomic size_t *counter, size_t delta) {
+  size_t value = atomic_load_explicit(counter, memory_order_relaxed);
+  atomic_store_explicit(counter, value + delta, memory_order_relaxed);
+}
+
+// Whether size more bytes keep budget at or below cap
+static inline bool gc_budget_fits(const GCBudget *budget, size_t size,
+                                  size_t cap) {
+  return budget->used <= cap && size <= cap - budget->used;
+}
+
+// Give bytes back to a budget; objects charged elsewhere never take it
+// below zero
+static inline void gc_budget_credit(GCBudget *budget, size_t size) {
+  budget->used = budget->used > size ? budget->used - size : 0;
+}
 
-  size_t new_capacity =
-      gc_state.capacity ? gc_state.capacity : INITIAL_TRACKED_CAPACITY;
+static void gc_collect_roots(GCCounters *counters);
 
-  while (new_capacity < min_capacity) {
-    if (new_capacity > SIZE_MAX / 2) {
-      gc_abort_allocation();
+// Thread exit: collect the cycles the thread left buffered, then hand the
+// block, counts included, to the next new thread
+static void gc_counters_release(void *arg) {
+  GCCounters *counters = arg;
+  if (counters->roots.count > 0)
+    gc_collect_roots(counters);
+  counters->allocations = 0;
+  counters->budget = NULL;
+  atomic_store_explicit(&counters->in_use, false, memory_order_release);
+}
+
+static void gc_key_init(void) {
+  pthread_key_create(&gc_key, gc_counters_release);
+}
+
+/**
+ * @brief Attach a counter block to the calling thread
+ *
+ * Reuses the block of an exited thread when there is one, otherwise pushes
+ * a new block onto gc_counters. Aborts if no block can be allocated, since
+ * the counts of a tracked object must always have somewhere to go.
+ *
+ * @return The calling thread's block
+ */
+static GCCounters *gc_counters_attach(void) {
+  pthread_once(&gc_key_once, gc_key_init);
+
+  GCCounters *counters = NULL;
+  for (GCCounters *block =
+           atomic_load_explicit(&gc_counters, memory_order_acquire);
+       block; block = block->next) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong_explicit(&block->in_use, &expected, true,
+                                                memory_order_acquire,
+                                                memory_order_relaxed)) {
+      counters = block;
+      break;
     }
-    new_capacity *= 2;
   }
 
-  KronosValue **new_objects =
-      realloc(gc_state.objects, new_capacity * sizeof(KronosValue *));
-  if (!new_objects) {
-    gc_abort_allocation();
+  if (!counters) {
+    counters = calloc(1, sizeof(GCCounters));
+    if (!counters) {
+      fprintf(stderr, "Failed to allocate GC counters\n");
+      abort();
+    }
+    atomic_init(&counters->in_use, true);
+    counters->threshold = GC_COLLECT_THRESHOLD;
+    counters->next = atomic_load_explicit(&gc_counters, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&gc_counters, &counters->next,
+                                                  counters,
+                                                  memory_order_release,
+                                                  memory_order_relaxed))
+      ;
   }
 
-  memset(new_objects + gc_state.capacity, 0,
-         (new_capacity - gc_state.capacity) * sizeof(KronosValue *));
+  pthread_setspecific(gc_key, counters);
+  gc_local = counters;
+  return counters;
+}
+
+static inline GCCounters *gc_counters_local(void) {
+  GCCounters *counters = gc_local;
+  return counters ? counters : gc_counters_attach();
+}
+
+// Sum the counters of every thread, including exited ones
+static void gc_counters_sum(size_t *objects, size_t *bytes) {
+  *objects = 0;
+  *bytes = 0;
+  for (GCCounters *block =
+           atomic_load_explicit(&gc_counters, memory_order_acquire);
+       block; block = block->next) {
+    *objects += atomic_load_explicit(&block->objects, memory_order_relaxed);
+    *bytes += atomic_load_explicit(&block->bytes, memory_order_relaxed);
+  }
+}
 
-  gc_state.objects = new_objects;
-  gc_state.capacity = new_capacity;
+/**
+ * @brief Detach every tracked object and reset statistics
+ *
+ * Objects stay alive; they simply stop being counted. Starting a new epoch
+ * makes gc_untrack() ignore everything tracked before, and the current sums
+ * become the zero point of gc_get_object_count() and
+ * gc_get_allocated_bytes(). Must be called with gc_mutex held.
+ */
+static void gc_detach_all_locked(void) {
+  atomic_fetch_add_explicit(&gc_epoch, 1, memory_order_relaxed);
+  gc_counters_sum(&gc_base_objects, &gc_base_bytes);
+  if (gc_local) {
+    gc_local->allocations = 0;
+    gc_local->threshold = GC_COLLECT_THRESHOLD;
+  }
+  memset(&gc_state.stats, 0, sizeof(gc_state.stats));
 }
 
 /**
  * @brief Initialize the garbage collector
  *
- * Allocates the initial object tracking array. Safe to call multiple times
- * (will clean up previous state first).
+ * Resets tracking state. Safe to call multiple times: garbage cycles left
+ * by a previous initialization are collected, and the remaining objects are
+ * detached (not freed).
  */
 void gc_init(void) {
+  gc_collect_cycles(); // Empties this thread's root buffer
   pthread_mutex_lock(&gc_mutex);
-  // Free any previously allocated memory if gc_init is called multiple times
-  if (gc_state.objects) {
-    free(gc_state.objects);
-    gc_state.objects = NULL;
-  }
-  memset(&gc_state, 0, sizeof(GCState));
-  gc_ensure_capacity_locked(INITIAL_TRACKED_CAPACITY);
+  gc_detach_all_locked();
   pthread_mutex_unlock(&gc_mutex);
 }
 
 /**
  * @brief Cleanup the garbage collector
  *
- * Releases all tracked objects and frees the tracking array.
- * Should only be called when no more values are in use.
+ * Collects garbage cycles, then detaches all tracked objects and resets
+ * statistics. Objects that are still referenced are left alive: releasing
+ * them here would free memory that their owners still point to.
  */
 void gc_cleanup(void) {
+  gc_collect_cycles();
   pthread_mutex_lock(&gc_mutex);
-  KronosValue **objects = gc_state.objects;
-  size_t count = gc_state.count;
-  gc_state.objects = NULL;
-  gc_state.count = 0;
-  gc_state.capacity = 0;
-  gc_state.allocated_bytes = 0;
+  gc_detach_all_locked();
   pthread_mutex_unlock(&gc_mutex);
-
-  if (!objects)
-    return;
-
-  for (size_t i = 0; i < count; i++) {
-    KronosValue *obj = objects[i];
-    if (obj)
-      value_release(obj);
+  if (gc_local) {
+    free(gc_local->roots.items);
+    free(gc_local->work.items);
+    free(gc_local->restore.items);
+    memset(&gc_local->roots, 0, sizeof(gc_local->roots));
+    memset(&gc_local->work, 0, sizeof(gc_local->work));
+    memset(&gc_local->restore, 0, sizeof(gc_local->restore));
   }
-  free(objects);
 }
 
 /**
  * @brief Track a newly allocated object
  *
- * Adds the object to the tracking array for leak detection and statistics.
- * Prevents duplicate tracking of the same object.
+ * Flags the object, stamps it with the current epoch and adds it to the
+ * calling thread's counters. Objects that are already tracked, and immortal
+ * objects, are ignored. Runs the cycle collector when roots are buffered
+ * and this thread has reached the allocation threshold.
  *
  * @param val Object to track (safe to pass NULL)
  */
 void gc_track(KronosValue *val) {
-  if (!val)
+  if (!val || (val->flags & (VALUE_FLAG_IMMORTAL | VALUE_FLAG_GC_TRACKED)))
     return;
 
-  pthread_mutex_lock(&gc_mutex);
-  // Check if object is already tracked to prevent duplicates
-  for (size_t i = 0; i < gc_state.count; i++) {
-    if (gc_state.objects[i] == val) {
-      // Already tracked, skip
-      pthread_mutex_unlock(&gc_mutex);
-      return;
-    }
-  }
+  GCCounters *counters = gc_counters_local();
+  size_t size = gc_object_size(val);
+  val->flags |= VALUE_FLAG_GC_TRACKED;
+  val->gc_epoch = atomic_load_explicit(&gc_epoch, memory_order_relaxed);
+  counter_add(&counters->objects, 1);
+  counter_add(&counters->bytes, size);
+  if (counters->budget)
+    counters->budget->used += size;
 
-  // Object not found, add it
-  gc_ensure_capacity_locked(gc_state.count + 1);
-  gc_state.objects[gc_state.count++] = val;
-  gc_state.allocated_bytes += sizeof(KronosValue);
-
-  // Add size of string data if applicable
-  if (val->type == VAL_STRING) {
-    gc_state.allocated_bytes += val->as.string.length + 1;
-  }
-  pthread_mutex_unlock(&gc_mutex);
+  // val is fully built and owned by the caller, so a run cannot free it
+  if (counters->roots.count > 0 &&
+      ++counters->allocations >= counters->threshold)
+    gc_collect_roots(counters);
 }
 
 /**
  * @brief Remove an object from tracking
  *
- * Called when an object is being freed. Removes it from the tracking array
- * and updates statistics.
+ * Called when an object is being freed. Clears the tracked flag and
+ * subtracts the object from the calling thread's counters, unless it was
+ * tracked before the last detach. Untracked objects are ignored.
  *
  * @param val Object to untrack (safe to pass NULL)
  */
 void gc_untrack(KronosValue *val) {
-  if (!val)
+  if (!val || !(val->flags & VALUE_FLAG_GC_TRACKED))
     return;
 
-  pthread_mutex_lock(&gc_mutex);
-  for (size_t i = 0; i < gc_state.count; i++) {
-    if (gc_state.objects[i] == val) {
-      // Subtract from allocated bytes
-      gc_state.allocated_bytes -= sizeof(KronosValue);
-      if (val->type == VAL_STRING) {
-        gc_state.allocated_bytes -= val->as.string.length + 1;
+  val->flags &= ~VALUE_FLAG_GC_TRACKED;
+  GCCounters *counters = gc_counters_local();
+  size_t size = gc_object_size(val);
+  // Shared objects were never charged to a budget
+  if (counters->budget && !(val->flags & VALUE_FLAG_SHARED))
+    gc_budget_credit(counters->budget, size);
+  if (val->gc_epoch != atomic_load_explicit(&gc_epoch, memory_order_relaxed))
+    return;
+
+  counter_add(&counters->objects, (size_t)-1);
+  counter_add(&counters->bytes, (size_t)0 - size);
+}
+
+/**
+ * @brief Account a change in the memory owned by a tracked object
+ *
+ * @param val Tracked object
+ * @param old_size Owned bytes before the change
+ * @param new_size Owned bytes after the change
+ */
+void gc_resize(KronosValue *val, size_t old_size, size_t new_size) {
+  if (!(val->flags & VALUE_FLAG_GC_TRACKED))
+    return;
+
+  GCCounters *counters = gc_counters_local();
+  if (counters->budget) {
+    gc_budget_credit(counters->budget, old_size);
+    counters->budget->used += new_size;
+  }
+  if (val->gc_epoch == atomic_load_explicit(&gc_epoch, memory_order_relaxed))
+    counter_add(&counters->bytes, new_size - old_size);
+}
+
+/**
+ * @brief Set the calling thread's heap budget
+ *
+ * @param budget Budget to charge from now on, or NULL
+ * @return The previous budget
+ */
+GCBudget *gc_set_budget(GCBudget *budget) {
+  GCCounters *counters = gc_counters_local();
+  GCBudget *previous = counters->budget;
+  counters->budget = budget;
+  return previous;
+}
+
+/**
+ * @brief Set soft and hard limits, keeping the current usage
+ *
+ * @param budget Budget to configure
+ * @param soft_limit Bytes above which allocation collects first (0: limit)
+ * @param limit Hard cap in bytes (0: unlimited)
+ */
+void gc_budget_set_limits(GCBudget *budget, size_t soft_limit, size_t limit) {
+  budget->limit = limit == 0 ? SIZE_MAX : limit;
+  budget->soft_limit =
+      soft_limit == 0 || soft_limit > budget->limit ? budget->limit
+                                                    : soft_limit;
+  budget->collect_at = budget->soft_limit;
+}
+
+/**
+ * @brief Fast budget check done before every value allocation
+ *
+ * @param size Bytes about to be allocated
+ * @return true if there is no budget or size fits below its collection point
+ */
+bool gc_reserve(size_t size) {
+  GCCounters *counters = gc_local;
+  GCBudget *budget = counters ? counters->budget : NULL;
+  return !budget || gc_budget_fits(budget, size, budget->collect_at);
+}
+
+/**
+ * @brief Collect cycles, then check an allocation against the hard limit
+ *
+ * @param size Bytes about to be allocated
+ * @return true if the allocation fits; false (and budget->exceeded set) if
+ * it would exceed the limit
+ */
+bool gc_make_room(size_t size) {
+  GCBudget *budget = gc_counters_local()->budget;
+  if (!budget)
+    return true;
+
+  gc_collect_cycles();
+  size_t used = budget->used;
+  budget->collect_at = used < budget->soft_limit
+                           ? budget->soft_limit
+                           : used + (budget->limit - used) / 2;
+  if (gc_budget_fits(budget, size, budget->limit))
+    return true;
+  budget->exceeded = true;
+  return false;
+}
+
+// Grow stack by doubling; false on allocation failure
+static bool gc_stack_grow(GCStack *stack) {
+  size_t new_capacity = stack->capacity == 0 ? 64 : stack->capacity * 2;
+  KronosValue **items =
+      realloc(stack->items, new_capacity * sizeof(KronosValue *));
+  if (!items)
+    return false;
+  stack->items = items;
+  stack->capacity = new_capacity;
+  return true;
+}
+
+// Push onto a traversal stack; a collection cannot stop halfway
+static void gc_stack_push(GCStack *stack, KronosValue *val) {
+  if (stack->count == stack->capacity && !gc_stack_grow(stack)) {
+    fprintf(stderr, "Failed to grow cycle collector stack\n");
+    abort();
+  }
+  stack->items[stack->count++] = val;
+}
+
+static inline uint32_t gc_color(const KronosValue *val) {
+  return val->flags & VALUE_FLAG_GC_COLOR;
+}
+
+static inline void gc_set_color(KronosValue *val, uint32_t color) {
+  val->flags = (val->flags & ~VALUE_FLAG_GC_COLOR) | color;
+}
+
+// Item i of a list if it is itself a list (only lists can close a cycle)
+static inline KronosValue *gc_list_child(const KronosValue *list, size_t i) {
+  Value item = list->as.list.items[i];
+  if (!IS_OBJ(item) || AS_OBJ(item)->type != VAL_LIST)
+    return NULL;
+  return AS_OBJ(item);
+}
+
+/**
+ * @brief Buffer a list as a candidate cycle root
+ *
+ * The list goes into the calling thread's own buffer, so no lock is taken.
+ * If the buffer cannot grow the list is simply not buffered; a cycle through
+ * it is then found only if another of its lists becomes a root.
+ *
+ * @param val List whose refcount was decremented to a non-zero value
+ */
+void gc_possible_root(KronosValue *val) {
+  GCStack *roots = &gc_counters_local()->roots;
+  if (!(val->flags & VALUE_FLAG_BUFFERED) &&
+      (roots->count < roots->capacity || gc_stack_grow(roots))) {
+    val->flags |= VALUE_FLAG_BUFFERED;
+    roots->items[roots->count++] = val;
+  }
+}
+
+/**
+ * @brief Subtract the references between lists reachable from root
+ *
+ * Every list reached is colored gray, and each list-to-list reference
+ * decrements the count of its target, so afterwards a count only holds
+ * references from outside the subgraph.
+ *
+ * @param work Traversal stack of the calling thread
+ * @param root Candidate root
+ * @return Number of lists visited
+ */
+static size_t gc_mark_gray(GCStack *work, KronosValue *root) {
+  if (gc_color(root) == GC_GRAY)
+    return 0;
+  size_t visited = 0;
+  gc_set_color(root, GC_GRAY);
+  gc_stack_push(work, root);
+  while (work->count > 0) {
+    KronosValue *list = work->items[--work->count];
+    visited++;
+    for (size_t i = 0; i < list->as.list.count; i++) {
+      KronosValue *child = gc_list_child(list, i);
+      if (!child)
+        continue;
+      child->refcount--;
+      if (gc_color(child) != GC_GRAY) {
+        gc_set_color(child, GC_GRAY);
+        gc_stack_push(work, child);
       }
+    }
+  }
+  return visited;
+}
 
-      // Remove from array by shifting
-      for (size_t j = i; j < gc_state.count - 1; j++) {
-        gc_state.objects[j] = gc_state.objects[j + 1];
+// Restore the references subtracted below a list that is still in use
+static void gc_scan_black(GCStack *restore, KronosValue *list) {
+  gc_set_color(list, GC_BLACK);
+  gc_stack_push(restore, list);
+  while (restore->count > 0) {
+    KronosValue *current = restore->items[--restore->count];
+    for (size_t i = 0; i < current->as.list.count; i++) {
+      KronosValue *child = gc_list_child(current, i);
+      if (!child)
+        continue;
+      child->refcount++;
+      if (gc_color(child) != GC_BLACK) {
+        gc_set_color(child, GC_BLACK);
+        gc_stack_push(restore, child);
       }
-      gc_state.count--;
-      pthread_mutex_unlock(&gc_mutex);
-      return;
     }
   }
-  pthread_mutex_unlock(&gc_mutex);
 }
 
 /**
- * @brief Collect cycles (placeholder for future implementation)
+ * @brief Sort the gray lists below root into live and garbage
+ *
+ * A gray list with a positive count is referenced from outside, so it and
+ * everything it reaches are live (black). Gray lists left at zero are
+ * tentatively garbage (white) until a live list turns out to reach them.
  *
- * Currently a no-op. Reference counting cannot detect circular references
- * (e.g., a list containing itself). This will be implemented using
- * mark-and-sweep when needed.
+ * @param counters Block of the calling thread
+ * @param root Candidate root already passed to gc_mark_gray()
+ */
+static void gc_scan(GCCounters *counters, KronosValue *root) {
+  GCStack *work = &counters->work;
+  gc_stack_push(work, root);
+  while (work->count > 0) {
+    KronosValue *list = work->items[--work->count];
+    if (gc_color(list) != GC_GRAY)
+      continue;
+    if (list->refcount > 0) {
+      gc_scan_black(&counters->restore, list);
+      continue;
+    }
+    gc_set_color(list, GC_WHITE);
+    for (size_t i = 0; i < list->as.list.count; i++) {
+      KronosValue *child = gc_list_child(list, i);
+      if (child)
+        gc_stack_push(work, child);
+    }
+  }
+}
+
+// Move the white lists reachable from root to garbage. Roots still
+// buffered are left for their own turn.
+static void gc_collect_white(GCStack *work, GCStack *garbage,
+                             KronosValue *root) {
+  gc_stack_push(work, root);
+  while (work->count > 0) {
+    KronosValue *list = work->items[--work->count];
+    if (gc_color(list) != GC_WHITE || (list->flags & VALUE_FLAG_BUFFERED))
+      continue;
+    gc_set_color(list, GC_BLACK);
+    gc_stack_push(garbage, list);
+    for (size_t i = 0; i < list->as.list.count; i++) {
+      KronosValue *child = gc_list_child(list, i);
+      if (child)
+        gc_stack_push(work, child);
+    }
+  }
+}
+
+static uint64_t gc_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Collect the reference cycles buffered in one thread's block
+ *
+ * Runs the three trial deletion passes over the block's roots with the
+ * block's own stacks, so no lock is held until the statistics are updated.
+ * Roots freed by refcounting since they were buffered are only empty
+ * headers and are freed here as well. The owner's next automatic run waits
+ * for at least as many of its own allocations as this run visited lists.
+ *
+ * @param counters Block of the calling thread
+ */
+static void gc_collect_roots(GCCounters *counters) {
+  uint64_t start = gc_now_ns();
+  GCStack garbage = {0};
+
+  // Drop the roots already freed by refcounting before any count changes.
+  // Dead lists still on a reclaim queue are left for it to free.
+  GCStack *roots = &counters->roots;
+  size_t kept = 0;
+  for (size_t i = 0; i < roots->count; i++) {
+    KronosValue *root = roots->items[i];
+    if (root->refcount == 0 && (root->flags & VALUE_FLAG_RECLAIM))
+      root->flags &= ~VALUE_FLAG_BUFFERED;
+    else if (root->refcount == 0)
+      gc_stack_push(&garbage, root);
+    else
+      roots->items[kept++] = root;
+  }
+  size_t released = garbage.count;
+  roots->count = kept;
+
+  size_t visited = 0;
+  for (size_t i = 0; i < roots->count; i++)
+    visited += gc_mark_gray(&counters->work, roots->items[i]);
+  for (size_t i = 0; i < roots->count; i++)
+    gc_scan(counters, roots->items[i]);
+  for (size_t i = 0; i < roots->count; i++) {
+    roots->items[i]->flags &= ~VALUE_FLAG_BUFFERED;
+    gc_collect_white(&counters->work, &garbage, roots->items[i]);
+  }
+  roots->count = 0;
+  counters->allocations = 0;
+  counters->threshold =
+      visited > GC_COLLECT_THRESHOLD ? visited : GC_COLLECT_THRESHOLD;
+
+  // Freeing releases strings and untracks objects, which may buffer new
+  // roots; the buffer is empty and free to take them
+  value_free_unreachable(garbage.items, garbage.count);
+  free(garbage.items);
+
+  uint64_t elapsed = gc_now_ns() - start;
+  pthread_mutex_lock(&gc_mutex);
+  gc_state.stats.collections++;
+  gc_state.stats.objects_freed += garbage.count - released;
+  gc_state.stats.total_ns += elapsed;
+  gc_state.stats.last_ns = elapsed;
+  if (elapsed > gc_state.stats.max_ns)
+    gc_state.stats.max_ns = elapsed;
+  pthread_mutex_unlock(&gc_mutex);
+}
+
+/**
+ * @brief Collect reference cycles among lists
  *
- * TODO: Implement mark-and-sweep cycle detection
+ * Only the lists the calling thread buffered are examined, so a run never
+ * touches lists that other threads are using.
  */
-void gc_collect_cycles(void) {
-  // TODO: Implement mark-and-sweep for cycles
-  // This will be needed when we have circular references
-  // (e.g., lists containing themselves, closures with circular refs)
+void gc_collect_cycles(void) { gc_collect_roots(gc_counters_local()); }
 
-  // For now, we rely on pure reference counting
+/**
+ * @brief Get cycle collector statistics
+ *
+ * @param out Receives the counters and the size of the calling thread's
+ * root buffer
+ */
+void gc_get_stats(GCStats *out) {
+  pthread_mutex_lock(&gc_mutex);
+  *out = gc_state.stats;
+  pthread_mutex_unlock(&gc_mutex);
+  out->roots_buffered = gc_local ? gc_local->roots.count : 0;
 }
 
 /**
  * @brief Get total allocated memory in bytes
  *
  * Returns an approximate count of memory allocated for KronosValue objects.
- * Includes the value structures and string data.
+ * Includes the value structures and string data. Sums the per-thread
+ * counters without locking.
  *
  * @return Total allocated bytes
  */
 size_t gc_get_allocated_bytes(void) {
-  pthread_mutex_lock(&gc_mutex);
-  size_t bytes = gc_state.allocated_bytes;
-  pthread_mutex_unlock(&gc_mutex);
-  return bytes;
+  size_t objects, bytes;
+  gc_counters_sum(&objects, &bytes);
+  return bytes - gc_base_bytes;
 }
 
 /**
  * @brief Get the number of currently tracked objects
  *
- * Useful for debugging and leak detection.
+ * Useful for debugging and leak detection. Sums the per-thread counters
+ * without locking.
  *
  * @return Number of tracked objects
  */
 size_t gc_get_object_count(void) {
-  pthread_mutex_lock(&gc_mutex);
-  size_t count = gc_state.count;
-  pthread_mutex_unlock(&gc_mutex);
-  return count;
+  size_t objects, bytes;
+  gc_counters_sum(&objects, &bytes);
+  return objects - gc_base_objects;
 }
@@ -2,10 +2,43 @@
 #define KRONOS_GC_H
 
 #include "runtime.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Garbage collector for reference counting and cycle detection
 
+/**
+ * Minimum number of allocations by one thread between automatic cycle
+ * collections. After each run the interval grows to the number of objects it
+ * traversed, so the collector's work stays proportional to allocation.
+ */
+#define GC_COLLECT_THRESHOLD 10000
+
+/** Cycle collector counters returned by gc_get_stats() */
+typedef struct {
+  size_t collections;    /**< Completed gc_collect_cycles() runs */
+  size_t objects_freed;  /**< Objects reclaimed as unreachable cycles */
+  size_t roots_buffered; /**< Roots the calling thread has buffered */
+  uint64_t total_ns;     /**< Time spent collecting, in nanoseconds */
+  uint64_t last_ns;      /**< Duration of the most recent run */
+  uint64_t max_ns;       /**< Longest single run */
+} GCStats;
+
+/**
+ * Heap budget of one VM. Objects tracked while a budget is the thread's
+ * current one (see gc_set_budget()) are charged to it and credited back when
+ * they are untracked on a thread where it is current. Objects shared by all
+ * VMs (VALUE_FLAG_SHARED, such as interned strings) are never charged.
+ */
+typedef struct {
+  size_t limit;      /**< Hard cap on used bytes (SIZE_MAX: unlimited) */
+  size_t soft_limit; /**< Past this, allocation runs the cycle collector */
+  size_t collect_at; /**< Usage that triggers the next collection */
+  size_t used;       /**< Bytes currently charged */
+  bool exceeded;     /**< gc_make_room() refused an allocation */
+} GCBudget;
+
 /**
  * @brief Initialize the garbage collector.
  *
@@ -17,6 +50,8 @@ void gc_init(void);
 /**
  * @brief Clean up and release all GC resources.
  *
+ * Detaches every tracked object and resets statistics. Objects that are
+ * still referenced are not freed.
  * Should be called once at program shutdown.
  * Thread-safety: NOT thread-safe. Call from main thread during shutdown.
  */
@@ -36,13 +71,14 @@ void gc_cleanup(void);
  * - Must be called exactly once per object lifetime
  *
  * Behavior:
- * - NOT idempotent: each call increments allocation statistics and must be
- *   paired with a matching gc_untrack() to keep memory accounting correct.
+ * - O(1) and lock-free: the object is flagged and stamped with the current
+ *   epoch, and the calling thread's own counters are updated.
+ * - Idempotent: tracking an already-tracked object is a no-op, so statistics
+ *   are counted exactly once per object.
  * - NULL-safe: Passing NULL is a no-op and does not affect statistics.
- * - Adds object to cycle detection tracking list
  *
  * Example usage:
- *   KronosValue *val = malloc(sizeof(KronosValue));
+ *   KronosValue *val = slab_alloc(sizeof(KronosValue));
  *   val->type = VAL_NUMBER;
  *   val->as.number = 42.0;
  *   val->refcount = 1;
@@ -51,7 +87,7 @@ void gc_cleanup(void);
  * @param val Value to track (may be NULL, in which case this is a no-op).
  * @note Does not modify refcount - tracking is separate from reference
  * counting.
- * @note Thread-safety: NOT thread-safe. Requires external synchronization.
+ * @note Thread-safety: safe to call concurrently for different objects.
  */
 void gc_track(KronosValue *val);
 
@@ -60,6 +96,7 @@ void gc_track(KronosValue *val);
  *
  * When to call:
  * - Only during object destruction (when refcount reaches 0)
+ * - O(1) and lock-free: the calling thread's own counters are updated
  * - Called by value_release() before freeing the object
  * - Must be called before the object is freed to keep statistics accurate
  * - Safe to call on untracked objects (no-op if not found)
@@ -67,43 +104,132 @@ void gc_track(KronosValue *val);
  * - Balanced with gc_track(): exactly one gc_untrack() per successful
  *   gc_track(); extra calls after removal are ignored.
  * - Updates memory statistics (subtracts allocated bytes)
- * - Removes object from cycle detection tracking list
+ * - Objects tracked before the last gc_init()/gc_cleanup() were detached
+ *   and are not subtracted
  *
  * Example usage:
  *   void value_release(KronosValue *val) {
  *       if (--val->refcount == 0) {
  *           gc_untrack(val);  // Untrack before freeing
  *           // ... free val->as.* data ...
- *           free(val);
+ *           slab_free(val, sizeof(KronosValue));
  *       }
  *   }
  *
  * @param val Value to untrack (may be NULL, in which case this is a no-op).
  * @note Must be called before freeing the value to keep stats accurate.
- * @note Thread-safety: NOT thread-safe. Requires external synchronization.
+ * @note Thread-safety: safe to call concurrently for different objects, from
+ * any thread.
  */
 void gc_untrack(KronosValue *val);
 
 /**
- * @brief Run cycle detection to free unreachable circular references.
+ * @brief Account a change in the memory owned by a tracked object.
+ *
+ * Call after growing or shrinking a string buffer or list storage, with the
+ * sizes before and after. Ignored for untracked objects.
+ *
+ * @param val Tracked object (must not be NULL)
+ * @param old_size Bytes owned before the change
+ * @param new_size Bytes owned after the change
+ * @note Thread-safety: same as gc_track().
+ */
+void gc_resize(KronosValue *val, size_t old_size, size_t new_size);
+
+/**
+ * @brief Set the heap budget charged by the calling thread.
+ *
+ * @param budget Budget to charge, or NULL for none
+ * @return The previous budget, which the caller should restore
+ * @note Thread-safety: affects only the calling thread.
+ */
+GCBudget *gc_set_budget(GCBudget *budget);
+
+/**
+ * @brief Configure the limits of a heap budget.
+ *
+ * @param budget Budget to configure (must not be NULL)
+ * @param soft_limit Usage above which allocation first runs the cycle
+ * collector (0: same as limit)
+ * @param limit Hard cap in bytes (0: unlimited)
+ */
+void gc_budget_set_limits(GCBudget *budget, size_t soft_limit, size_t limit);
+
+/**
+ * @brief Check that an allocation fits the current budget's soft limit.
  *
- * Performs mark-and-sweep garbage collection to detect and break reference
- * cycles that would otherwise leak memory. Should be called periodically or
- * when memory pressure is detected.
+ * The fast path of every value allocation: true when there is no budget or
+ * @p size more bytes stay below the next collection point. Otherwise the
+ * caller should free what it can and call gc_make_room().
  *
- * @note Currently not fully implemented - reference counting handles most
- * cases.
- * @note Thread-safety: NOT thread-safe. Requires external synchronization.
+ * @param size Bytes about to be allocated
+ * @return true if the allocation may proceed
+ */
+bool gc_reserve(size_t size);
+
+/**
+ * @brief Collect cycles and check an allocation against the hard limit.
+ *
+ * Called when gc_reserve() fails. Runs gc_collect_cycles() and moves the
+ * next collection point halfway to the hard limit, so a heap that stays
+ * above the soft limit is not rescanned on every allocation.
+ *
+ * @param size Bytes about to be allocated
+ * @return true if the allocation fits; otherwise the budget is marked
+ * exceeded and the allocation must fail
+ */
+bool gc_make_room(size_t size);
+
+/**
+ * @brief Buffer a list whose refcount dropped to a non-zero value.
+ *
+ * Such a list may now be kept alive only by a reference cycle, so it becomes
+ * a candidate root for the calling thread's next gc_collect_cycles() run.
+ * Called by value_release(); lists already buffered are skipped cheaply.
+ *
+ * @param val List value (must not be NULL)
+ * @note Thread-safety: lock-free; each thread has its own root buffer. A
+ * list must not be released on two threads at once.
+ */
+void gc_possible_root(KronosValue *val);
+
+/**
+ * @brief Free lists that are only kept alive by reference cycles.
+ *
+ * Synchronous trial deletion (Bacon and Rajan) over the candidate roots the
+ * calling thread buffered: references between lists reachable from the
+ * roots are subtracted, lists whose count stays positive are restored with
+ * everything they reach, and the remaining lists are freed together with
+ * their other contents. Runs automatically from gc_track() when the thread
+ * has buffered roots and enough allocations have happened since its last
+ * run (see GC_COLLECT_THRESHOLD), and when a thread exits.
+ *
+ * @note Every live reference must be counted in a refcount while this runs;
+ * a list referenced only through a borrowed pointer may be freed.
+ * @note Thread-safety: only the calling thread's roots are examined, so
+ * threads whose lists are disjoint (one per VM) may run it concurrently.
  */
 void gc_collect_cycles(void);
 
+/**
+ * @brief Report cycle collector statistics.
+ *
+ * Counters cover the runs of every thread; roots_buffered is the calling
+ * thread's.
+ *
+ * @param out Receives the statistics (must not be NULL)
+ * @note Thread-safety: safe to call from any thread.
+ */
+void gc_get_stats(GCStats *out);
+
 /**
  * @brief Get total bytes allocated by tracked objects.
  *
  * @return Total bytes of memory used by all tracked KronosValue objects.
  * @note Includes object headers and any associated data (e.g., string
  * contents).
- * @note Thread-safety: NOT thread-safe. Requires external synchronization.
+ * @note Thread-safety: lock-free; sums the counters of every thread, so a
+ * result taken while other threads allocate is approximate.
  */
 size_t gc_get_allocated_bytes(void);
 
@@ -111,7 +237,7 @@ size_t gc_get_allocated_bytes(void);
  * @brief Get count of currently tracked objects.
  *
  * @return Number of live KronosValue objects being tracked.
- * @note Thread-safety: NOT thread-safe. Requires external synchronization.
+ * @note Thread-safety: lock-free, like gc_get_allocated_bytes().
  */
 size_t gc_get_object_count(void);
 
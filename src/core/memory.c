@@ -0,0 +1,64 @@
+/**
+ * @file memory.c
+ * @brief Pluggable heap allocation
+ *
+ * The current allocator is thread-local, so VMs with different allocators
+ * can run on different threads at once, and installing one is a single
+ * store on the VM's API boundary rather than a pointer threaded through
+ * every constructor.
+ */
+
+#include "memory.h"
+#include <stdint.h>
+#include <string.h>
+
+_Thread_local MemAllocator *mem_allocator = NULL;
+
+MemAllocator *mem_allocator_new(const KronosAllocator *hooks) {
+  // A partial set would mix the C library with the caller's heap
+  if (!hooks || !hooks->alloc || !hooks->realloc || !hooks->free)
+    return NULL;
+  MemAllocator *allocator = malloc(sizeof(MemAllocator));
+  if (!allocator)
+    return NULL;
+  allocator->hooks = *hooks;
+  atomic_init(&allocator->refcount, 1);
+  return allocator;
+}
+
+MemAllocator *mem_allocator_retain(MemAllocator *allocator) {
+  if (allocator)
+    atomic_fetch_add_explicit(&allocator->refcount, 1, memory_order_relaxed);
+  return allocator;
+}
+
+void mem_allocator_release(MemAllocator *allocator) {
+  if (allocator && atomic_fetch_sub_explicit(&allocator->refcount, 1,
+                                             memory_order_acq_rel) == 1)
+    free(allocator);
+}
+
+MemAllocator *mem_set_allocator(MemAllocator *allocator) {
+  MemAllocator *previous = mem_allocator;
+  mem_allocator = allocator;
+  return previous;
+}
+
+void *mem_calloc(size_t count, size_t size) {
+  if (!mem_allocator)
+    return calloc(count, size);
+  if (size != 0 && count > SIZE_MAX / size)
+    return NULL;
+  void *ptr = mem_alloc(count * size);
+  if (ptr)
+    memset(ptr, 0, count * size);
+  return ptr;
+}
+
+char *mem_strdup(const char *str) {
+  size_t size = strlen(str) + 1;
+  char *copy = mem_alloc(size);
+  if (copy)
+    memcpy(copy, str, size);
+  return copy;
+}
@@ -0,0 +1,94 @@
+#ifndef KRONOS_MEMORY_H
+#define KRONOS_MEMORY_H
+
+#include "../../include/kronos.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Heap allocation through the calling thread's current allocator
+//
+// Every buffer the runtime, frontend, compiler and VM own goes through these
+// wrappers instead of malloc()/free(). A VM makes its allocator current for
+// the duration of each API call (see vm_use_allocator()), so a block must be
+// freed under the same allocator it was allocated under. Without a current
+// allocator the wrappers call the C library directly.
+
+/**
+ * A copy of a set of allocator callbacks, shared by the VM that owns it and
+ * by every list the VM creates. Lists can outlive their VM (a garbage cycle
+ * is freed by a later collection), so each holds a reference. The handle
+ * itself lives on the C library heap.
+ */
+typedef struct MemAllocator {
+  KronosAllocator hooks;   /**< All three callbacks are non-NULL */
+  _Atomic size_t refcount; /**< Owners: the VM and its live lists */
+} MemAllocator;
+
+/** The calling thread's allocator, or NULL for the C library */
+extern _Thread_local MemAllocator *mem_allocator;
+
+/**
+ * @brief Create an allocator handle holding a copy of hooks.
+ *
+ * @param hooks Callbacks to copy
+ * @return Handle with one reference, or NULL if hooks is NULL, any of its
+ * alloc, realloc and free callbacks is NULL, or the handle cannot be
+ * allocated
+ */
+MemAllocator *mem_allocator_new(const KronosAllocator *hooks);
+
+/** Add a reference to allocator (NULL: the C library, no-op); returns it */
+MemAllocator *mem_allocator_retain(MemAllocator *allocator);
+
+/** Drop a reference to allocator, freeing the handle with the last one */
+void mem_allocator_release(MemAllocator *allocator);
+
+/**
+ * @brief Make an allocator current on the calling thread.
+ *
+ * @param allocator Allocator to use (NULL: the C library). Must stay valid
+ * until it is replaced.
+ * @return The previous allocator, which the caller should restore
+ */
+MemAllocator *mem_set_allocator(MemAllocator *allocator);
+
+// Allocate, resize or free through a given allocator (NULL: the C library),
+// for blocks that remember the allocator they came from
+
+static inline void *mem_alloc_in(const MemAllocator *allocator, size_t size) {
+  return allocator ? allocator->hooks.alloc(allocator->hooks.user_data, size)
+                   : malloc(size);
+}
+
+static inline void *mem_realloc_in(const MemAllocator *allocator, void *ptr,
+                                   size_t size) {
+  return allocator ? allocator->hooks.realloc(allocator->hooks.user_data, ptr,
+                                              size)
+                   : realloc(ptr, size);
+}
+
+static inline void mem_free_in(const MemAllocator *allocator, void *ptr) {
+  if (!allocator)
+    free(ptr);
+  else if (ptr)
+    allocator->hooks.free(allocator->hooks.user_data, ptr);
+}
+
+static inline void *mem_alloc(size_t size) {
+  return mem_alloc_in(mem_allocator, size);
+}
+
+static inline void *mem_realloc(void *ptr, size_t size) {
+  return mem_realloc_in(mem_allocator, ptr, size);
+}
+
+static inline void mem_free(void *ptr) { mem_free_in(mem_allocator, ptr); }
+
+/** Zero-filled array of count elements of size bytes, or NULL */
+void *mem_calloc(size_t count, size_t size);
+
+/** Copy of a NUL-terminated string, or NULL */
+char *mem_strdup(const char *str);
+
+#endif // KRONOS_MEMORY_H
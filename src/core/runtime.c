@@ -12,9 +12,13 @@
 
 #include "runtime.h"
 #include "gc.h"
+#include "memory.h"
+#include "slab.h"
 #include <float.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,22 +26,36 @@
 /** Epsilon value for floating-point comparisons (handles rounding errors) */
 #define VALUE_COMPARE_EPSILON (1e-9)
 
-/** Size of the string interning hash table */
-#define INTERN_TABLE_SIZE 1024
+/** Initial bucket count of the string interning table (a power of two) */
+#define INTERN_TABLE_MIN_CAPACITY 256
 
-/** Hash table for string interning (reduces memory for duplicate strings) */
-static KronosValue *intern_table[INTERN_TABLE_SIZE] = {0};
+/**
+ * Interned strings: open addressing with linear probing, keyed by content
+ * and grown to keep the load factor at or below 3/4. Each entry holds one
+ * reference until runtime_cleanup().
+ */
+static struct {
+  KronosValue **entries;
+  size_t capacity;
+  size_t count;
+} intern_table;
+static pthread_mutex_t intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** runtime_init() calls not yet matched by runtime_cleanup() */
+static size_t runtime_users;
+static pthread_mutex_t runtime_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  * @brief Hash function for strings (FNV-1a algorithm)
  *
- * Used for string interning to quickly find existing strings.
+ * Used for string interning and by the VM/compiler symbol tables. Matches
+ * the hash cached in string values (as.string.hash).
  *
  * @param str String to hash
  * @param len Length of the string
  * @return 32-bit hash value
  */
-static uint32_t hash_string(const char *str, size_t len) {
+uint32_t string_hash(const char *str, size_t len) {
   uint32_t hash = 2166136261u;
   for (size_t i = 0; i < len; i++) {
     hash ^= (uint8_t)str[i];
@@ -49,124 +67,481 @@ static uint32_t hash_string(const char *str, size_t len) {
 /**
  * @brief Initialize the runtime system
  *
- * Must be called before creating any values. Initializes the string
- * interning table and garbage collector.
+ * Must be called before creating any values. Calls nest: only the first of
+ * several overlapping users (one per VM) initializes the garbage collector,
+ * so a VM created while others run leaves their state alone. The string
+ * interning table is allocated on first use.
  */
 void runtime_init(void) {
-  memset(intern_table, 0, sizeof(intern_table));
-  gc_init();
+  pthread_mutex_lock(&runtime_mutex);
+  if (runtime_users++ == 0)
+    gc_init();
+  pthread_mutex_unlock(&runtime_mutex);
 }
 
 /**
  * @brief Cleanup the runtime system
  *
- * Releases all interned strings and shuts down the garbage collector.
- * IMPORTANT: This must only be called after all external references to
- * interned strings have been released, otherwise values may be freed prematurely.
+ * Undoes one runtime_init(). The last user releases all interned strings and
+ * shuts down the garbage collector; interned strings that are still
+ * referenced elsewhere stay alive as ordinary strings, so a later
+ * string_intern() starts a fresh table.
  */
 void runtime_cleanup(void) {
+  pthread_mutex_lock(&runtime_mutex);
+  if (runtime_users > 0 && --runtime_users > 0) {
+    pthread_mutex_unlock(&runtime_mutex);
+    return;
+  }
+
   // Free interned strings
-  for (size_t i = 0; i < INTERN_TABLE_SIZE; i++) {
-    if (intern_table[i] != NULL) {
-      value_release(intern_table[i]); // Release intern table's reference
-      intern_table[i] = NULL;
+  pthread_mutex_lock(&intern_mutex);
+  for (size_t i = 0; i < intern_table.capacity; i++) {
+    KronosValue *entry = intern_table.entries[i];
+    if (entry != NULL) {
+      // Strings that outlive the table are no longer unique
+      entry->flags &= ~VALUE_FLAG_INTERNED;
+      value_release(entry); // Release intern table's reference
     }
   }
+  free(intern_table.entries);
+  intern_table.entries = NULL;
+  intern_table.capacity = 0;
+  intern_table.count = 0;
+  pthread_mutex_unlock(&intern_mutex);
   gc_cleanup();
+  pthread_mutex_unlock(&runtime_mutex);
+}
+
+/** String value whose bytes follow the header in the same allocation */
+typedef struct {
+  KronosValue header;
+  char data[];
+} InlineString;
+
+/** String value whose bytes live in a separate buffer */
+typedef struct {
+  KronosValue header;
+  // Allocator current when the buffer was allocated (a reference, or NULL
+  // for the C library); the buffer is grown and freed through it, since the
+  // string may die after its VM or while another VM's allocator is current
+  MemAllocator *allocator;
+} HeapString;
+
+/** Longest string stored inline (header, bytes and terminator in one slab
+ * slot) */
+#define INLINE_STRING_MAX (SLAB_MAX_SIZE - offsetof(InlineString, data) - 1)
+
+/** Queue that dead lists go to instead of being freed (see value_reclaim()) */
+static _Thread_local ReclaimQueue *reclaim_queue = NULL;
+
+/**
+ * @brief Check that size more bytes fit the thread's heap budget
+ *
+ * Past the soft limit, dead lists waiting on the reclaim queue are freed
+ * and the cycle collector runs before the hard limit is checked.
+ *
+ * @param size Bytes about to be allocated
+ * @return true if the allocation may proceed
+ */
+static bool value_reserve(size_t size) {
+  if (gc_reserve(size))
+    return true;
+  ReclaimQueue *queue = reclaim_queue;
+  if (queue)
+    value_reclaim(queue, SIZE_MAX);
+  return gc_make_room(size);
+}
+
+/**
+ * @brief Allocate and initialize a value header
+ *
+ * Sets the type, an initial refcount of 1 and clears GC bookkeeping. The
+ * caller fills in the payload and then calls gc_track(). Headers come from
+ * the slab allocator and go back with value_free_header(). Allocation is a
+ * safe point for deferred reclamation, so it first frees one slice of the
+ * thread's reclaim queue, if any. Fails when the thread's heap budget has
+ * no room for size bytes.
+ *
+ * @param type Type of the new value
+ * @param size Bytes to allocate (sizeof(KronosValue) plus any inline payload)
+ * @return New uninitialized-payload value, or NULL on allocation failure
+ */
+static KronosValue *value_alloc_size(ValueType type, size_t size) {
+  ReclaimQueue *queue = reclaim_queue;
+  if (queue && queue->count > 0)
+    value_reclaim(queue, queue->budget);
+  if (!value_reserve(size))
+    return NULL;
+
+  KronosValue *val = slab_alloc(size);
+  if (!val)
+    return NULL;
+
+  val->type = type;
+  val->refcount = 1;
+  val->flags = 0;
+  val->gc_epoch = 0;
+  return val;
+}
+
+// Allocate a value header with no inline payload
+static KronosValue *value_alloc(ValueType type) {
+  return value_alloc_size(type, sizeof(KronosValue));
+}
+
+// Return a header obtained from value_alloc() or value_alloc_size()
+static void value_free_header(KronosValue *val) {
+  size_t size = sizeof(KronosValue);
+  if (val->flags & VALUE_FLAG_INLINE)
+    size = offsetof(InlineString, data) + val->as.string.capacity + 1;
+  else if (val->type == VAL_STRING)
+    size = sizeof(HeapString);
+  slab_free(val, size);
+}
+
+/** Immortal nil, false and true shared by every value_new_nil/_bool call */
+static KronosValue immortal_nil = {.type = VAL_NIL,
+                                   .refcount = 1,
+                                   .flags = VALUE_FLAG_IMMORTAL};
+static KronosValue immortal_false = {.type = VAL_BOOL,
+                                     .refcount = 1,
+                                     .flags = VALUE_FLAG_IMMORTAL,
+                                     .as.boolean = false};
+static KronosValue immortal_true = {.type = VAL_BOOL,
+                                    .refcount = 1,
+                                    .flags = VALUE_FLAG_IMMORTAL,
+                                    .as.boolean = true};
+
+/** Immortal numbers VALUE_SMALL_INT_MIN..VALUE_SMALL_INT_MAX, built on first
+ * use */
+static KronosValue
+    small_ints[VALUE_SMALL_INT_MAX - VALUE_SMALL_INT_MIN + 1];
+static pthread_once_t small_ints_once = PTHREAD_ONCE_INIT;
+
+// Fill in the small-integer cache (the entries never change afterwards)
+static void small_ints_init(void) {
+  for (int i = 0; i <= VALUE_SMALL_INT_MAX - VALUE_SMALL_INT_MIN; i++) {
+    small_ints[i].type = VAL_NUMBER;
+    small_ints[i].refcount = 1;
+    small_ints[i].flags = VALUE_FLAG_IMMORTAL;
+    small_ints[i].as.number = (double)(i + VALUE_SMALL_INT_MIN);
+  }
+}
+
+/** Immortal empty string and single-byte strings, built on first use */
+typedef struct {
+  KronosValue header;
+  char data[2];
+} CharString;
+static CharString empty_string;
+static CharString char_strings[256];
+static pthread_once_t char_strings_once = PTHREAD_ONCE_INIT;
+
+// Point an immortal string header at its own inline bytes
+static void char_string_init(CharString *str, size_t len, char ch) {
+  str->header.type = VAL_STRING;
+  str->header.refcount = 1;
+  // Unique per content, so they count as interned without a table entry
+  str->header.flags = VALUE_FLAG_IMMORTAL | VALUE_FLAG_INTERNED;
+  str->data[0] = ch;
+  str->data[1] = '\0';
+  str->header.as.string.data = str->data;
+  str->header.as.string.length = len;
+  str->header.as.string.capacity = len;
+  str->header.as.string.hash = string_hash(str->data, len);
+}
+
+// Fill in the empty and single-byte string cache
+static void char_strings_init(void) {
+  char_string_init(&empty_string, 0, '\0');
+  for (int i = 0; i < 256; i++)
+    char_string_init(&char_strings[i], 1, (char)i);
 }
 
 /**
  * @brief Create a new number value
  *
- * Allocates a KronosValue representing a floating-point number.
- * The value is tracked by the garbage collector and uses reference counting.
+ * Integers in [VALUE_SMALL_INT_MIN, VALUE_SMALL_INT_MAX] (except -0) come
+ * from a cache of immortal instances; any other number is allocated and
+ * tracked by the garbage collector.
  *
  * @param num The numeric value
  * @return New value, or NULL on allocation failure
  */
 KronosValue *value_new_number(double num) {
-  KronosValue *val = malloc(sizeof(KronosValue));
+  if (num >= VALUE_SMALL_INT_MIN && num <= VALUE_SMALL_INT_MAX &&
+      num == (double)(int)num && !(num == 0 && signbit(num))) {
+    pthread_once(&small_ints_once, small_ints_init);
+    return &small_ints[(int)num - VALUE_SMALL_INT_MIN];
+  }
+
+  KronosValue *val = value_alloc(VAL_NUMBER);
   if (!val)
     return NULL;
 
-  val->type = VAL_NUMBER;
-  val->refcount = 1;
   val->as.number = num;
 
   gc_track(val);
   return val;
 }
 
+/**
+ * @brief Allocate a string value with room for len bytes
+ *
+ * Strings up to INLINE_STRING_MAX bytes are stored inline after the header
+ * in a single allocation, longer ones in a separate buffer. The caller
+ * copies in the bytes and then calls string_finish().
+ *
+ * @param len Length of the string (at least 2; shorter strings are immortal)
+ * @return New value with data, length and capacity set, or NULL on
+ * allocation failure
+ */
+static KronosValue *string_alloc(size_t len) {
+  KronosValue *val;
+  if (len <= INLINE_STRING_MAX) {
+    // Round up to the slab slot so short appends can reuse the slack
+    size_t size = offsetof(InlineString, data) + len + 1;
+    size = (size + SLAB_GRANULE - 1) / SLAB_GRANULE * SLAB_GRANULE;
+    val = value_alloc_size(VAL_STRING, size);
+    if (!val)
+      return NULL;
+    val->flags = VALUE_FLAG_INLINE;
+    val->as.string.data = ((InlineString *)val)->data;
+    val->as.string.capacity = size - offsetof(InlineString, data) - 1;
+  } else {
+    val = value_alloc_size(VAL_STRING, sizeof(HeapString));
+    if (!val)
+      return NULL;
+    val->as.string.data = value_reserve(len + 1) ? mem_alloc(len + 1) : NULL;
+    if (!val->as.string.data) {
+      value_free_header(val);
+      return NULL;
+    }
+    val->as.string.capacity = len;
+    ((HeapString *)val)->allocator = mem_allocator_retain(mem_allocator);
+  }
+  val->as.string.length = len;
+  return val;
+}
+
+// Free the byte buffer of a string that does not store its bytes inline
+static void string_free_data(KronosValue *val) {
+  if (val->flags & VALUE_FLAG_INLINE)
+    return;
+  MemAllocator *allocator = ((HeapString *)val)->allocator;
+  mem_free_in(allocator, val->as.string.data);
+  mem_allocator_release(allocator);
+}
+
+// Terminate, hash and track a string filled in after string_alloc()
+static KronosValue *string_finish(KronosValue *val) {
+  size_t len = val->as.string.length;
+  val->as.string.data[len] = '\0';
+  val->as.string.hash = string_hash(val->as.string.data, len);
+  gc_track(val);
+  return val;
+}
+
 /**
  * @brief Create a new string value
  *
  * Allocates a KronosValue containing a copy of the provided string.
  * The string data is stored with a null terminator for C compatibility.
+ * The empty string and single-byte strings are shared immortal instances;
+ * other short strings live inline in a single allocation (see
+ * string_alloc()).
  *
  * @param str String data (may contain null bytes, will be copied)
  * @param len Length of the string (not including null terminator)
  * @return New value, or NULL on allocation failure
  */
 KronosValue *value_new_string(const char *str, size_t len) {
-  KronosValue *val = malloc(sizeof(KronosValue));
+  if (len <= 1) {
+    pthread_once(&char_strings_once, char_strings_init);
+    return len == 0 ? &empty_string.header
+                    : &char_strings[(uint8_t)str[0]].header;
+  }
+
+  KronosValue *val = string_alloc(len);
   if (!val)
     return NULL;
+  memcpy(val->as.string.data, str, len);
+  return string_finish(val);
+}
 
-  val->type = VAL_STRING;
-  val->refcount = 1;
-  val->as.string.data = malloc(len + 1);
-  if (!val->as.string.data) {
-    free(val);
+/**
+ * @brief Create a string holding two byte ranges back to back
+ *
+ * Builds the result of a concatenation with one allocation and one copy of
+ * each side.
+ *
+ * @param a Left bytes
+ * @param len_a Length of a
+ * @param b Right bytes
+ * @param len_b Length of b
+ * @return New value, or NULL on allocation failure or length overflow
+ */
+KronosValue *value_new_string_concat(const char *a, size_t len_a,
+                                     const char *b, size_t len_b) {
+  if (len_b > SIZE_MAX - 1 - len_a)
+    return NULL;
+  size_t len = len_a + len_b;
+  if (len <= 1)
+    return value_new_string(len_a ? a : b, len);
+
+  KronosValue *val = string_alloc(len);
+  if (!val)
+    return NULL;
+  memcpy(val->as.string.data, a, len_a);
+  memcpy(val->as.string.data + len_a, b, len_b);
+  return string_finish(val);
+}
+
+/**
+ * @brief Create a string from several byte ranges joined end to end
+ *
+ * The total length is computed first, so the result is allocated once and
+ * each part copied once, however many parts there are.
+ *
+ * @param parts Byte ranges in order
+ * @param lengths Length of each part
+ * @param count Number of parts
+ * @return New value, or NULL on allocation failure or length overflow
+ */
+KronosValue *value_new_string_parts(const char *const *parts,
+                                    const size_t *lengths, size_t count) {
+  size_t len = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (lengths[i] > SIZE_MAX - 1 - len)
+      return NULL;
+    len += lengths[i];
+  }
+  if (len <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      if (lengths[i])
+        return value_new_string(parts[i], lengths[i]);
+    }
+    return value_new_string("", 0);
+  }
+
+  KronosValue *val = string_alloc(len);
+  if (!val)
     return NULL;
+  char *out = val->as.string.data;
+  for (size_t i = 0; i < count; i++) {
+    memcpy(out, parts[i], lengths[i]);
+    out += lengths[i];
   }
+  return string_finish(val);
+}
 
-  memcpy(val->as.string.data, str, len);
-  val->as.string.data[len] = '\0';
-  val->as.string.length = len;
-  val->as.string.hash = hash_string(str, len);
+/**
+ * @brief Append several byte ranges to a string value in place
+ *
+ * Heap buffers grow geometrically, so a chain of appends is linear overall.
+ * Inline strings only grow into the slack of their slab slot, and immortal
+ * and (formerly) interned strings never change; both report false once they
+ * cannot hold the result. The string is left untouched when false is
+ * returned. The cached hash is extended over the new bytes (FNV-1a is
+ * incremental).
+ *
+ * @param str String to extend (the caller must hold the only references
+ * that can observe the change)
+ * @param parts Byte ranges to append, in order (must not point into str)
+ * @param lengths Length of each part
+ * @param count Number of parts
+ * @return true if appended, false if the caller must build a new string
+ */
+bool value_string_append_parts(KronosValue *str, const char *const *parts,
+                               const size_t *lengths, size_t count) {
+  if (!str || str->type != VAL_STRING ||
+      (str->flags &
+       (VALUE_FLAG_IMMORTAL | VALUE_FLAG_INTERNED | VALUE_FLAG_SHARED)))
+    return false;
 
-  gc_track(val);
-  return val;
+  size_t length = str->as.string.length;
+  size_t needed = length;
+  for (size_t i = 0; i < count; i++) {
+    if (lengths[i] > SIZE_MAX - 1 - needed)
+      return false;
+    needed += lengths[i];
+  }
+  if (needed > str->as.string.capacity) {
+    if (str->flags & VALUE_FLAG_INLINE)
+      return false;
+    size_t old_capacity = str->as.string.capacity;
+    size_t capacity =
+        old_capacity > (SIZE_MAX - 1) / 2 ? needed : old_capacity * 2;
+    if (capacity < needed)
+      capacity = needed;
+    if (!value_reserve(capacity - old_capacity))
+      return false;
+    char *buffer = mem_realloc_in(((HeapString *)str)->allocator,
+                                  str->as.string.data, capacity + 1);
+    if (!buffer)
+      return false;
+
+    // The GC accounts strings by capacity
+    str->as.string.data = buffer;
+    str->as.string.capacity = capacity;
+    gc_resize(str, old_capacity, capacity);
+  }
+
+  uint32_t hash = str->as.string.hash;
+  char *out = str->as.string.data + length;
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < lengths[i]; j++) {
+      hash ^= (uint8_t)parts[i][j];
+      hash *= 16777619;
+    }
+    memcpy(out, parts[i], lengths[i]);
+    out += lengths[i];
+  }
+  str->as.string.data[needed] = '\0';
+  str->as.string.length = needed;
+  str->as.string.hash = hash;
+  return true;
+}
+
+// Append one byte range in place (see value_string_append_parts())
+bool value_string_append(KronosValue *str, const char *data, size_t len) {
+  return value_string_append_parts(str, &data, &len, 1);
+}
+
+/**
+ * @brief Get the immortal string holding a single byte
+ *
+ * Used by string indexing and splitting, which produce one-character strings
+ * in bulk.
+ *
+ * @param ch The byte
+ * @return Shared immortal string (never NULL)
+ */
+KronosValue *value_new_char(uint8_t ch) {
+  pthread_once(&char_strings_once, char_strings_init);
+  return &char_strings[ch].header;
 }
 
 /**
- * @brief Create a new boolean value
+ * @brief Get a boolean value
  *
  * @param val Boolean value (true or false)
- * @return New value, or NULL on allocation failure
+ * @return The immortal true or false instance (never NULL)
  */
 KronosValue *value_new_bool(bool val) {
-  KronosValue *v = malloc(sizeof(KronosValue));
-  if (!v)
-    return NULL;
-
-  v->type = VAL_BOOL;
-  v->refcount = 1;
-  v->as.boolean = val;
-
-  gc_track(v);
-  return v;
+  return val ? &immortal_true : &immortal_false;
 }
 
 /**
- * @brief Create a new nil (null) value
+ * @brief Get the nil (null) value
  *
  * Represents the absence of a value. Used for uninitialized variables
  * and as a default return value.
  *
- * @return New nil value, or NULL on allocation failure
+ * @return The immortal nil instance (never NULL)
  */
-KronosValue *value_new_nil(void) {
-  KronosValue *val = malloc(sizeof(KronosValue));
-  if (!val)
-    return NULL;
-
-  val->type = VAL_NIL;
-  val->refcount = 1;
-
-  gc_track(val);
-  return val;
-}
+KronosValue *value_new_nil(void) { return &immortal_nil; }
 
 /**
  * @brief Create a new function value
@@ -183,21 +558,20 @@ KronosValue *value_new_function(uint8_t *bytecode, size_t length, int arity) {
   if (!bytecode || length == 0)
     return NULL;
 
-  KronosValue *val = malloc(sizeof(KronosValue));
+  KronosValue *val = value_alloc(VAL_FUNCTION);
   if (!val)
     return NULL;
 
-  uint8_t *buffer = malloc(length);
+  uint8_t *buffer = value_reserve(length) ? mem_alloc(length) : NULL;
   if (!buffer) {
-    free(val);
+    value_free_header(val);
     return NULL;
   }
   memcpy(buffer, bytecode, length);
 
-  val->type = VAL_FUNCTION;
-  val->refcount = 1;
   val->as.function.bytecode = buffer;
   val->as.function.length = length;
+  val->as.function.allocator = mem_allocator_retain(mem_allocator);
   val->as.function.arity = arity;
 
   gc_track(val);
@@ -216,21 +590,25 @@ KronosValue *value_new_function(uint8_t *bytecode, size_t length, int arity) {
 KronosValue *value_new_list(size_t initial_capacity) {
   size_t capacity = initial_capacity == 0 ? 4 : initial_capacity;
 
-  KronosValue *val = malloc(sizeof(KronosValue));
+  if (capacity > SIZE_MAX / sizeof(Value))
+    return NULL;
+
+  KronosValue *val = value_alloc(VAL_LIST);
   if (!val)
     return NULL;
 
-  KronosValue **items = calloc(capacity, sizeof(KronosValue *));
+  Value *items = value_reserve(capacity * sizeof(Value))
+                     ? mem_alloc(capacity * sizeof(Value))
+                     : NULL;
   if (!items) {
-    free(val);
+    value_free_header(val);
     return NULL;
   }
 
-  val->type = VAL_LIST;
-  val->refcount = 1;
   val->as.list.items = items;
   val->as.list.count = 0;
   val->as.list.capacity = capacity;
+  val->as.list.allocator = mem_allocator_retain(mem_allocator);
 
   gc_track(val);
   return val;
@@ -249,12 +627,10 @@ KronosValue *value_new_channel(Channel *channel) {
   if (!channel)
     return NULL;
 
-  KronosValue *val = malloc(sizeof(KronosValue));
+  KronosValue *val = value_alloc(VAL_CHANNEL);
   if (!val)
     return NULL;
 
-  val->type = VAL_CHANNEL;
-  val->refcount = 1;
   val->as.channel = channel;
 
   gc_track(val);
@@ -270,30 +646,176 @@ KronosValue *value_new_channel(Channel *channel) {
  * @param val Value to retain (safe to pass NULL)
  */
 void value_retain(KronosValue *val) {
-  if (val) {
-    if (val->refcount == UINT32_MAX) {
+  if (!val || (val->flags & VALUE_FLAG_IMMORTAL))
+    return;
+
+  if (val->flags & VALUE_FLAG_SHARED) {
+    // Other VMs may retain and release it concurrently
+    if (__atomic_fetch_add(&val->refcount, 1, __ATOMIC_RELAXED) ==
+        UINT32_MAX) {
       fprintf(stderr, "KronosValue refcount overflow\n");
       abort();
     }
-    val->refcount++;
+    return;
+  }
+
+  if (val->refcount == UINT32_MAX) {
+    fprintf(stderr, "KronosValue refcount overflow\n");
+    abort();
   }
+  val->refcount++;
 }
 
-static void release_stack_push(KronosValue ***stack, size_t *count,
-                               size_t *capacity, KronosValue *val) {
-  if (*count == *capacity) {
-    size_t new_capacity = (*capacity == 0) ? 8 : (*capacity * 2);
-    KronosValue **new_stack =
-        realloc(*stack, new_capacity * sizeof(KronosValue *));
-    if (!new_stack) {
-      fprintf(stderr, "Failed to grow release stack\n");
-      abort();
+/** Entries of a release work stack kept in the caller's frame */
+#define RELEASE_STACK_LOCAL 32
+
+/** Work stack of value_release(); moves to the heap past RELEASE_STACK_LOCAL */
+typedef struct {
+  KronosValue **items;
+  size_t count;
+  size_t capacity;
+  KronosValue *local[RELEASE_STACK_LOCAL];
+} ReleaseStack;
+
+// Push onto a release stack; false if it cannot grow
+static bool release_stack_push(ReleaseStack *stack, KronosValue *val) {
+  if (stack->count == stack->capacity) {
+    size_t new_capacity = stack->capacity * 2;
+    KronosValue **new_items =
+        stack->items == stack->local
+            ? mem_alloc(new_capacity * sizeof(KronosValue *))
+            : mem_realloc(stack->items, new_capacity * sizeof(KronosValue *));
+    if (!new_items)
+      return false;
+    if (stack->items == stack->local)
+      memcpy(new_items, stack->local, stack->count * sizeof(KronosValue *));
+    stack->items = new_items;
+    stack->capacity = new_capacity;
+  }
+
+  stack->items[stack->count++] = val;
+  return true;
+}
+
+// value_unref() for a value other VMs may reference concurrently. Strings
+// cannot form cycles, so there is nothing to buffer.
+static bool value_unref_shared(KronosValue *val) {
+  uint32_t count = __atomic_load_n(&val->refcount, __ATOMIC_RELAXED);
+  do {
+    if (count == 0) {
+      fprintf(stderr, "KronosValue refcount underflow\n");
+      return false;
+    }
+  } while (!__atomic_compare_exchange_n(&val->refcount, &count, count - 1,
+                                        true, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED));
+  return count == 1;
+}
+
+/**
+ * @brief Drop one reference to a value
+ *
+ * A list that stays referenced may now be held only by a cycle, so it is
+ * buffered for the cycle collector.
+ *
+ * @param val Value to release (safe to pass NULL)
+ * @return true if that was the last reference and val must be freed
+ */
+static inline bool value_unref(KronosValue *val) {
+  if (!val || (val->flags & VALUE_FLAG_IMMORTAL))
+    return false;
+
+  if (val->flags & VALUE_FLAG_SHARED)
+    return value_unref_shared(val);
+
+  if (val->refcount == 0) {
+    fprintf(stderr, "KronosValue refcount underflow\n");
+    return false;
+  }
+
+  if (--val->refcount > 0) {
+    // Only lists can form cycles; the rest is freed by refcounting alone
+    if (val->type == VAL_LIST && !(val->flags & VALUE_FLAG_BUFFERED))
+      gc_possible_root(val);
+    return false;
+  }
+  return true;
+}
+
+// Free the header of a dead value. The cycle collector's root buffer may
+// still point at it, in which case it is left (emptied) for
+// gc_collect_cycles() to free.
+static void value_free_dead_header(KronosValue *val) {
+  if (val->flags & VALUE_FLAG_BUFFERED) {
+    memset(&val->as, 0, sizeof(val->as));
+    return;
+  }
+  value_free_header(val);
+}
+
+// Free a value whose last reference is gone; the object items of a list
+// under the current allocator are pushed onto stack for the caller to release
+static void value_destroy(KronosValue *val, ReleaseStack *stack) {
+  gc_untrack(val);
+
+  // Free any owned memory
+  switch (val->type) {
+  case VAL_STRING:
+    string_free_data(val);
+    break;
+  case VAL_FUNCTION:
+    mem_free_in(val->as.function.allocator, val->as.function.bytecode);
+    mem_allocator_release(val->as.function.allocator);
+    break;
+  case VAL_LIST: {
+    MemAllocator *allocator = val->as.list.allocator;
+    if (allocator != mem_allocator) {
+      // The items came from the list's allocator, not the current one (the
+      // list outlived its VM), so release them under it right away
+      MemAllocator *previous = mem_set_allocator(allocator);
+      for (size_t i = 0; i < val->as.list.count; i++)
+        val_release(val->as.list.items[i]);
+      mem_set_allocator(previous);
+    } else {
+      for (size_t i = 0; i < val->as.list.count; i++) {
+        Value child = val->as.list.items[i];
+        // Out of memory for the stack: release the item with a fresh one
+        if (IS_OBJ(child) && !release_stack_push(stack, AS_OBJ(child)))
+          value_release(AS_OBJ(child));
+      }
     }
-    *stack = new_stack;
-    *capacity = new_capacity;
+    mem_free_in(allocator, val->as.list.items);
+    mem_allocator_release(allocator);
+    break;
   }
+  case VAL_CHANNEL:
+    // Channels are currently managed externally.
+    break;
+  default:
+    break;
+  }
+
+  value_free_dead_header(val);
+}
 
-  (*stack)[(*count)++] = val;
+// Queue a dead list on the thread's reclaim queue; false if there is no
+// queue or it cannot grow, and the list must be freed now
+static bool reclaim_defer(KronosValue *list) {
+  ReclaimQueue *queue = reclaim_queue;
+  if (!queue)
+    return false;
+  if (queue->count == queue->capacity) {
+    size_t new_capacity = queue->capacity == 0 ? 64 : queue->capacity * 2;
+    KronosValue **items =
+        mem_realloc(queue->items, new_capacity * sizeof(KronosValue *));
+    if (!items)
+      return false;
+    queue->items = items;
+    queue->capacity = new_capacity;
+  }
+  list->flags |= VALUE_FLAG_RECLAIM;
+  queue->items[queue->count++] = list;
+  return true;
 }
 
 /**
@@ -301,71 +823,557 @@ static void release_stack_push(KronosValue ***stack, size_t *count,
  *
  * Call this when removing a reference to a value. When the refcount
  * reaches zero, the value and its owned memory are automatically freed.
- * Uses iterative release to handle nested structures (lists containing lists).
+ * Uses iterative release to handle nested structures (lists containing
+ * lists), with a work stack that stays in this frame for shallow graphs.
+ * When the thread has a reclaim queue, a dead list with items is queued for
+ * value_reclaim() instead.
  *
  * @param val Value to release (safe to pass NULL)
  */
 void value_release(KronosValue *val) {
-  if (!val)
+  if (!value_unref(val))
     return;
 
-  if (val->refcount == 0) {
-    fprintf(stderr, "KronosValue refcount underflow\n");
+  if (val->type == VAL_LIST && val->as.list.count > 0 && reclaim_defer(val))
     return;
+
+  ReleaseStack stack;
+  stack.items = stack.local;
+  stack.count = 0;
+  stack.capacity = RELEASE_STACK_LOCAL;
+  value_destroy(val, &stack);
+
+  while (stack.count > 0) {
+    KronosValue *current = stack.items[--stack.count];
+    if (value_unref(current))
+      value_destroy(current, &stack);
   }
 
-  KronosValue **stack = NULL;
-  size_t stack_count = 0;
-  size_t stack_capacity = 0;
-  release_stack_push(&stack, &stack_count, &stack_capacity, val);
+  if (stack.items != stack.local)
+    mem_free(stack.items);
+}
 
-  while (stack_count > 0) {
-    KronosValue *current = stack[--stack_count];
-    if (!current)
-      continue;
+/**
+ * @brief Set the calling thread's reclaim queue
+ *
+ * @param queue Queue for dead lists, or NULL to free them synchronously
+ * @return The previously set queue
+ */
+ReclaimQueue *value_set_reclaim_queue(ReclaimQueue *queue) {
+  ReclaimQueue *previous = reclaim_queue;
+  reclaim_queue = queue;
+  return previous;
+}
 
-    if (current->refcount == 0) {
-      fprintf(stderr, "KronosValue refcount underflow\n");
+/**
+ * @brief Free queued dead lists in a bounded slice
+ *
+ * Each step releases one item of the most recently queued list, or frees
+ * that list once it is empty. Released items are freed on the spot when
+ * they are not lists; dead lists among them are queued (when queue is the
+ * thread's queue), which keeps every step O(1).
+ *
+ * @param queue Queue to drain
+ * @param budget Maximum number of steps
+ * @return true if queued lists remain
+ */
+bool value_reclaim(ReclaimQueue *queue, size_t budget) {
+  for (size_t steps = 0; queue->count > 0 && steps < budget; steps++) {
+    KronosValue *list = queue->items[queue->count - 1];
+    if (list->as.list.count > 0) {
+      // The count doubles as the cursor, so the list is always consistent.
+      // Items are released under the allocator they came from.
+      MemAllocator *previous = mem_set_allocator(list->as.list.allocator);
+      val_release(list->as.list.items[--list->as.list.count]);
+      mem_set_allocator(previous);
       continue;
     }
+    queue->count--;
+    gc_untrack(list);
+    mem_free_in(list->as.list.allocator, list->as.list.items);
+    mem_allocator_release(list->as.list.allocator);
+    list->flags &= ~VALUE_FLAG_RECLAIM;
+    value_free_dead_header(list);
+  }
+  return queue->count > 0;
+}
 
-    current->refcount--;
-    if (current->refcount > 0)
-      continue;
-
-    gc_untrack(current);
+/**
+ * @brief Drain a reclaim queue and free its storage
+ *
+ * @param queue Queue to free (its structure itself is owned by the caller)
+ */
+void reclaim_queue_free(ReclaimQueue *queue) {
+  value_reclaim(queue, SIZE_MAX);
+  mem_free(queue->items);
+  queue->items = NULL;
+  queue->count = 0;
+  queue->capacity = 0;
+}
 
-    // Free any owned memory
-    switch (current->type) {
+/**
+ * @brief Free values that the cycle collector found unreachable
+ *
+ * Lists inside the values are not released: the collector has already
+ * removed these references from their counts, and lists in the same garbage
+ * cycle are in the array too. Strings and other children are released as
+ * usual, under the allocator of the list holding them. Headers are freed
+ * last, since any value may still be an item of another one.
+ *
+ * @param values Values to free (their refcounts are ignored)
+ * @param count Number of values
+ */
+void value_free_unreachable(KronosValue **values, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    KronosValue *val = values[i];
+    switch (val->type) {
     case VAL_STRING:
-      free(current->as.string.data);
+      string_free_data(val);
       break;
     case VAL_FUNCTION:
-      free(current->as.function.bytecode);
+      mem_free_in(val->as.function.allocator, val->as.function.bytecode);
+      mem_allocator_release(val->as.function.allocator);
       break;
-    case VAL_LIST:
-      for (size_t i = 0; i < current->as.list.count; i++) {
-        KronosValue *child = current->as.list.items[i];
-        if (child)
-          release_stack_push(&stack, &stack_count, &stack_capacity, child);
+    case VAL_LIST: {
+      MemAllocator *previous = mem_set_allocator(val->as.list.allocator);
+      for (size_t j = 0; j < val->as.list.count; j++) {
+        Value child = val->as.list.items[j];
+        if (IS_OBJ(child) && AS_OBJ(child)->type != VAL_LIST)
+          value_release(AS_OBJ(child));
       }
-      free(current->as.list.items);
-      break;
-    case VAL_CHANNEL:
-      // Channels are currently managed externally.
+      mem_free(val->as.list.items);
+      mem_set_allocator(previous);
+      mem_allocator_release(val->as.list.allocator);
       break;
+    }
     default:
       break;
     }
+  }
+  for (size_t i = 0; i < count; i++) {
+    gc_untrack(values[i]);
+    value_free_header(values[i]);
+  }
+}
+
+/**
+ * @brief Append an item to a list value
+ *
+ * Retains the item when it is a heap object and doubles the backing store
+ * when full.
+ *
+ * @param list List value to append to
+ * @param item Item to append (borrowed; retained on success)
+ * @return true on success, false on invalid input or allocation failure
+ */
+bool value_list_append(KronosValue *list, Value item) {
+  if (!list || list->type != VAL_LIST)
+    return false;
+
+  if (list->as.list.count >= list->as.list.capacity) {
+    size_t new_capacity =
+        list->as.list.capacity == 0 ? 4 : list->as.list.capacity * 2;
+    if (new_capacity <= list->as.list.capacity ||
+        new_capacity > SIZE_MAX / sizeof(Value))
+      return false;
+    size_t old_size = list->as.list.capacity * sizeof(Value);
+    size_t new_size = new_capacity * sizeof(Value);
+    if (!value_reserve(new_size - old_size))
+      return false;
+    Value *new_items =
+        mem_realloc_in(list->as.list.allocator, list->as.list.items, new_size);
+    if (!new_items)
+      return false;
+    list->as.list.items = new_items;
+    list->as.list.capacity = new_capacity;
+    gc_resize(list, old_size, new_size);
+  }
+
+  val_retain(item);
+  list->as.list.items[list->as.list.count++] = item;
+  return true;
+}
+
+// Ordering used by value_list_sort: numbers are pre-converted to ordered keys
+typedef bool (*ListSortLess)(Value a, Value b);
+
+/** Below this many items the sort finishes with insertion sort */
+#define LIST_SORT_INSERTION_THRESHOLD 24
+/** Above this many items the pivot is a median of three medians */
+#define LIST_SORT_NINTHER_THRESHOLD 128
+/** Element moves allowed before partial insertion sort gives up */
+#define LIST_SORT_PARTIAL_LIMIT 8
+
+// Map a number's double bits to a key whose unsigned order is numeric order
+// (-0 sorts before +0; the canonical NaN sorts after +infinity). Integers
+// in the immediate form are converted first, since their tagged bits do not
+// follow the IEEE-754 order.
+static inline uint64_t list_sort_number_key(Value v) {
+  double num = value_to_number(v);
+  uint64_t bits;
+  memcpy(&bits, &num, sizeof(bits));
+  return bits ^ ((uint64_t)((int64_t)bits >> 63) | VALUE_SIGN_BIT);
+}
+
+// Inverse of list_sort_number_key, in the canonical number form
+static inline Value list_sort_number_value(uint64_t key) {
+  uint64_t bits = (key & VALUE_SIGN_BIT) ? key ^ VALUE_SIGN_BIT : ~key;
+  double num;
+  memcpy(&num, &bits, sizeof(num));
+  return value_from_number(num);
+}
+
+static bool list_sort_less_key(Value a, Value b) { return a < b; }
+
+// Byte-wise string order; a proper prefix sorts first
+static bool list_sort_less_string(Value a, Value b) {
+  size_t a_len = AS_STRING_LEN(a);
+  size_t b_len = AS_STRING_LEN(b);
+  int cmp = memcmp(AS_CSTRING(a), AS_CSTRING(b), a_len < b_len ? a_len : b_len);
+  return cmp < 0 || (cmp == 0 && a_len < b_len);
+}
+
+static inline void list_sort_swap(Value *items, size_t i, size_t j) {
+  Value tmp = items[i];
+  items[i] = items[j];
+  items[j] = tmp;
+}
+
+// Order items[i] <= items[j]
+static inline void list_sort2(Value *items, size_t i, size_t j,
+                              ListSortLess less) {
+  if (less(items[j], items[i]))
+    list_sort_swap(items, i, j);
+}
+
+// Order items[i] <= items[j] <= items[k]
+static inline void list_sort3(Value *items, size_t i, size_t j, size_t k,
+                              ListSortLess less) {
+  list_sort2(items, i, j, less);
+  list_sort2(items, j, k, less);
+  list_sort2(items, i, j, less);
+}
+
+static void list_insertion_sort(Value *items, size_t count,
+                                ListSortLess less) {
+  for (size_t i = 1; i < count; i++) {
+    Value tmp = items[i];
+    size_t j = i;
+    while (j > 0 && less(tmp, items[j - 1])) {
+      items[j] = items[j - 1];
+      j--;
+    }
+    items[j] = tmp;
+  }
+}
+
+// Insertion sort that gives up after a few moves; true if items are sorted
+static bool list_partial_insertion_sort(Value *items, size_t count,
+                                        ListSortLess less) {
+  size_t moves = 0;
+  for (size_t i = 1; i < count; i++) {
+    if (!less(items[i], items[i - 1]))
+      continue;
+    Value tmp = items[i];
+    size_t j = i;
+    do {
+      items[j] = items[j - 1];
+      j--;
+    } while (j > 0 && less(tmp, items[j - 1]));
+    items[j] = tmp;
+    moves += i - j;
+    if (moves > LIST_SORT_PARTIAL_LIMIT)
+      return false;
+  }
+  return true;
+}
+
+static void list_sift_down(Value *items, size_t root, size_t count,
+                           ListSortLess less) {
+  for (;;) {
+    size_t child = root * 2 + 1;
+    if (child >= count)
+      return;
+    if (child + 1 < count && less(items[child], items[child + 1]))
+      child++;
+    if (!less(items[root], items[child]))
+      return;
+    list_sort_swap(items, root, child);
+    root = child;
+  }
+}
+
+// Worst-case O(n log n) fallback once partitioning keeps going badly
+static void list_heap_sort(Value *items, size_t count, ListSortLess less) {
+  for (size_t i = count / 2; i-- > 0;)
+    list_sift_down(items, i, count, less);
+  for (size_t end = count; end-- > 1;) {
+    list_sort_swap(items, 0, end);
+    list_sift_down(items, 0, end, less);
+  }
+}
+
+// Partition around items[0]: smaller items to its left, the rest to its
+// right. Returns the pivot's final position; *already is set when no item
+// had to move.
+static size_t list_partition_right(Value *items, size_t count,
+                                   ListSortLess less, bool *already) {
+  Value pivot = items[0];
+  size_t first = 0;
+  size_t last = count;
+
+  do {
+    first++;
+  } while (first < count && less(items[first], pivot));
+  do {
+    last--;
+  } while (last > first && !less(items[last], pivot));
+
+  *already = first >= last;
+  // items[last] >= pivot and items[first] < pivot bound both scans
+  while (first < last) {
+    list_sort_swap(items, first, last);
+    do {
+      first++;
+    } while (less(items[first], pivot));
+    do {
+      last--;
+    } while (!less(items[last], pivot));
+  }
+
+  size_t pivot_pos = first - 1;
+  items[0] = items[pivot_pos];
+  items[pivot_pos] = pivot;
+  return pivot_pos;
+}
+
+// Partition around items[0], putting items equal to the pivot on its left.
+// Used when the pivot equals the item before this range, so the whole left
+// side is already in its final place.
+static size_t list_partition_left(Value *items, size_t count,
+                                  ListSortLess less) {
+  Value pivot = items[0];
+  size_t first = 0;
+  size_t last = count;
+
+  do {
+    last--;
+  } while (less(pivot, items[last]));
+  if (last + 1 == count) {
+    while (first < last && !less(pivot, items[++first]))
+      ;
+  } else {
+    while (!less(pivot, items[++first]))
+      ;
+  }
+
+  while (first < last) {
+    list_sort_swap(items, first, last);
+    do {
+      last--;
+    } while (less(pivot, items[last]));
+    do {
+      first++;
+    } while (!less(pivot, items[first]));
+  }
+
+  items[0] = items[last];
+  items[last] = pivot;
+  return last;
+}
+
+// Break up patterns that caused an unbalanced partition
+static void list_sort_shuffle(Value *items, size_t count) {
+  if (count < LIST_SORT_INSERTION_THRESHOLD)
+    return;
+  size_t quarter = count / 4;
+  list_sort_swap(items, 0, quarter);
+  list_sort_swap(items, count - 1, count - 1 - quarter);
+  if (count > LIST_SORT_NINTHER_THRESHOLD) {
+    list_sort_swap(items, 1, quarter + 1);
+    list_sort_swap(items, 2, quarter + 2);
+    list_sort_swap(items, count - 2, count - 2 - quarter);
+    list_sort_swap(items, count - 3, count - 3 - quarter);
+  }
+}
+
+/**
+ * @brief Pattern-defeating quicksort over items[0..count)
+ *
+ * @param items Items to sort
+ * @param count Number of items
+ * @param less Strict weak ordering
+ * @param bad_allowed Unbalanced partitions left before switching to heapsort
+ * @param leftmost false if items[-1] exists and is <= every item in range
+ */
+static void list_pdq_sort(Value *items, size_t count, ListSortLess less,
+                          int bad_allowed, bool leftmost) {
+  for (;;) {
+    if (count < LIST_SORT_INSERTION_THRESHOLD) {
+      list_insertion_sort(items, count, less);
+      return;
+    }
+
+    // Move the pivot candidate to items[0]
+    size_t half = count / 2;
+    if (count > LIST_SORT_NINTHER_THRESHOLD) {
+      list_sort3(items, 0, half, count - 1, less);
+      list_sort3(items, 1, half - 1, count - 2, less);
+      list_sort3(items, 2, half + 1, count - 3, less);
+      list_sort3(items, half - 1, half, half + 1, less);
+      list_sort_swap(items, 0, half);
+    } else {
+      list_sort3(items, half, 0, count - 1, less);
+    }
+
+    // Runs of items equal to the previous pivot need no further sorting
+    if (!leftmost && !less(items[-1], items[0])) {
+      size_t pivot_pos = list_partition_left(items, count, less);
+      items += pivot_pos + 1;
+      count -= pivot_pos + 1;
+      continue;
+    }
+
+    bool already = false;
+    size_t pivot_pos = list_partition_right(items, count, less, &already);
+    size_t left_count = pivot_pos;
+    size_t right_count = count - pivot_pos - 1;
+
+    if (left_count < count / 8 || right_count < count / 8) {
+      if (--bad_allowed == 0) {
+        list_heap_sort(items, count, less);
+        return;
+      }
+      list_sort_shuffle(items, left_count);
+      list_sort_shuffle(items + pivot_pos + 1, right_count);
+    } else if (already &&
+               list_partial_insertion_sort(items, left_count, less) &&
+               list_partial_insertion_sort(items + pivot_pos + 1,
+                                           right_count, less)) {
+      // Input was (nearly) sorted already
+      return;
+    }
 
-    free(current);
+    list_pdq_sort(items, left_count, less, bad_allowed, leftmost);
+    items += pivot_pos + 1;
+    count = right_count;
+    leftmost = false;
   }
+}
+
+/**
+ * @brief Sort a list of numbers or strings in place
+ *
+ * A single pass classifies the items, then the list is sorted with a
+ * pattern-defeating quicksort (O(n log n) worst case, linear on sorted runs)
+ * using a comparator specialized for the item type. Numbers are ordered
+ * numerically and strings byte-wise. Lists with fewer than two items are
+ * accepted whatever they contain.
+ *
+ * @param list List to sort
+ * @return true on success, false if list is not a list or its items are
+ * not all numbers or all strings (the list is left unchanged)
+ */
+bool value_list_sort(KronosValue *list) {
+  if (!list || list->type != VAL_LIST)
+    return false;
 
-  free(stack);
+  Value *items = list->as.list.items;
+  size_t count = list->as.list.count;
+  if (count < 2)
+    return true;
+
+  bool numbers = IS_NUMBER(items[0]);
+  if (!numbers && !IS_STRING(items[0]))
+    return false;
+  for (size_t i = 1; i < count; i++) {
+    if (numbers ? !IS_NUMBER(items[i]) : !IS_STRING(items[i]))
+      return false;
+  }
+
+  int bad_allowed = 1;
+  for (size_t n = count; n > 1; n >>= 1)
+    bad_allowed++;
+
+  if (!numbers) {
+    list_pdq_sort(items, count, list_sort_less_string, bad_allowed, true);
+    return true;
+  }
+
+  // Sort numbers as integer keys so each comparison is a single compare
+  for (size_t i = 0; i < count; i++)
+    items[i] = list_sort_number_key(items[i]);
+  list_pdq_sort(items, count, list_sort_less_key, bad_allowed, true);
+  for (size_t i = 0; i < count; i++)
+    items[i] = list_sort_number_value(items[i]);
+  return true;
 }
 
 /**
- * @brief Print a value to a file stream
+ * @brief Get the runtime type of a tagged value
+ *
+ * @param v Value to inspect
+ * @return Value type (EMPTY_VAL reports VAL_NIL)
+ */
+ValueType val_type(Value v) {
+  if (IS_NUMBER(v))
+    return VAL_NUMBER;
+  if (IS_BOOL(v))
+    return VAL_BOOL;
+  if (IS_OBJ(v))
+    return AS_OBJ(v)->type;
+  return VAL_NIL;
+}
+
+/**
+ * @brief Box a tagged value into a heap object
+ *
+ * Heap objects are retained and returned as-is; immediates become a
+ * KronosValue (nil, booleans and small integers are shared immortals).
+ *
+ * @param v Value to box
+ * @return New reference owned by the caller, or NULL on allocation failure
+ */
+KronosValue *val_box(Value v) {
+  if (IS_OBJ(v)) {
+    KronosValue *obj = AS_OBJ(v);
+    value_retain(obj);
+    return obj;
+  }
+  if (IS_NUMBER(v))
+    return value_new_number(AS_NUMBER(v));
+  if (IS_BOOL(v))
+    return value_new_bool(AS_BOOL(v));
+  return value_new_nil();
+}
+
+/**
+ * @brief Convert a heap object into a tagged value
+ *
+ * Number, boolean and nil cells become immediates. Other objects are
+ * borrowed: the result does not own a reference.
+ *
+ * @param obj Object to convert (NULL yields NIL_VAL)
+ * @return Tagged value
+ */
+Value val_unbox(KronosValue *obj) {
+  if (!obj)
+    return NIL_VAL;
+
+  switch (obj->type) {
+  case VAL_NUMBER:
+    return NUMBER_VAL(obj->as.number);
+  case VAL_BOOL:
+    return BOOL_VAL(obj->as.boolean);
+  case VAL_NIL:
+    return NIL_VAL;
+  default:
+    return OBJ_VAL(obj);
+  }
+}
+
+/**
+ * @brief Print a tagged value to a file stream
  *
  * Formats the value in a human-readable way:
  * - Numbers: printed as integers if whole, otherwise as floats
@@ -375,36 +1383,45 @@ void value_release(KronosValue *val) {
  * - Lists: [item1, item2, ...]
  *
  * @param out File stream to print to (defaults to stdout if NULL)
- * @param val Value to print (prints "null" if NULL)
+ * @param v Value to print
  */
-void value_fprint(FILE *out, KronosValue *val) {
+void val_fprint(FILE *out, Value v) {
   if (!out)
     out = stdout;
 
-  if (!val) {
-    fprintf(out, "null");
+  if (IS_INT(v)) {
+    fprintf(out, "%" PRId64, AS_INT(v));
     return;
   }
-
-  switch (val->type) {
-  case VAL_NUMBER: {
+  if (IS_NUMBER(v)) {
+    double num = AS_NUMBER(v);
     double intpart;
-    double frac = modf(val->as.number, &intpart);
+    double frac = modf(num, &intpart);
     if (frac == 0.0) {
-      fprintf(out, "%.0f", val->as.number);
+      fprintf(out, "%.0f", num);
     } else {
-      fprintf(out, "%g", val->as.number);
+      fprintf(out, "%g", num);
     }
-    break;
+    return;
   }
-  case VAL_STRING:
-    fprintf(out, "%s", val->as.string.data);
-    break;
+  if (IS_BOOL(v)) {
+    fprintf(out, "%s", AS_BOOL(v) ? "true" : "false");
+    return;
+  }
+  if (!IS_OBJ(v)) {
+    fprintf(out, "null");
+    return;
+  }
+
+  KronosValue *val = AS_OBJ(v);
+  switch (val->type) {
+  case VAL_NUMBER:
   case VAL_BOOL:
-    fprintf(out, "%s", val->as.boolean ? "true" : "false");
-    break;
   case VAL_NIL:
-    fprintf(out, "null");
+    val_fprint(out, val_unbox(val));
+    break;
+  case VAL_STRING:
+    fprintf(out, "%s", val->as.string.data);
     break;
   case VAL_FUNCTION:
     fprintf(out, "<function>");
@@ -414,7 +1431,7 @@ void value_fprint(FILE *out, KronosValue *val) {
     for (size_t i = 0; i < val->as.list.count; i++) {
       if (i > 0)
         fprintf(out, ", ");
-      value_fprint(out, val->as.list.items[i]);
+      val_fprint(out, val->as.list.items[i]);
     }
     fprintf(out, "]");
     break;
@@ -427,6 +1444,18 @@ void value_fprint(FILE *out, KronosValue *val) {
   }
 }
 
+/**
+ * @brief Print a value to a file stream
+ *
+ * Boxed counterpart of val_fprint().
+ *
+ * @param out File stream to print to (defaults to stdout if NULL)
+ * @param val Value to print (prints "null" if NULL)
+ */
+void value_fprint(FILE *out, KronosValue *val) {
+  val_fprint(out, val_unbox(val));
+}
+
 /**
  * @brief Print a value to stdout
  *
@@ -446,13 +1475,18 @@ void value_print(KronosValue *val) { value_fprint(stdout, val); }
  * - String: false if empty, true otherwise
  * - Other types: true
  *
- * @param val Value to check
+ * @param v Value to check
  * @return true if truthy, false otherwise
  */
-bool value_is_truthy(KronosValue *val) {
-  if (!val)
+bool val_is_truthy(Value v) {
+  if (IS_BOOL(v))
+    return AS_BOOL(v);
+  if (IS_NUMBER(v))
+    return AS_NUMBER(v) != 0.0;
+  if (!IS_OBJ(v))
     return false;
 
+  KronosValue *val = AS_OBJ(v);
   switch (val->type) {
   case VAL_NIL:
     return false;
@@ -467,6 +1501,16 @@ bool value_is_truthy(KronosValue *val) {
   }
 }
 
+/**
+ * @brief Check if a boxed value is truthy
+ *
+ * @param val Value to check (NULL is falsy)
+ * @return true if truthy, false otherwise
+ */
+bool value_is_truthy(KronosValue *val) {
+  return val ? val_is_truthy(val_unbox(val)) : false;
+}
+
 /**
  * @brief Check if two values are equal
  *
@@ -482,81 +1526,139 @@ bool value_is_truthy(KronosValue *val) {
  * @param b Second value
  * @return true if equal, false otherwise
  */
-bool value_equals(KronosValue *a, KronosValue *b) {
+bool val_equals(Value a, Value b) {
+  if (IS_INT(a) && IS_INT(b))
+    return a == b;
+  if (IS_NUMBER(a) || IS_NUMBER(b)) {
+    if (!IS_NUMBER(a) || !IS_NUMBER(b))
+      return false;
+    return fabs(AS_NUMBER(a) - AS_NUMBER(b)) < VALUE_COMPARE_EPSILON;
+  }
   if (a == b)
     return true;
-  if (!a || !b)
+  if (!IS_OBJ(a) || !IS_OBJ(b))
     return false;
-  if (a->type != b->type)
+
+  KronosValue *x = AS_OBJ(a);
+  KronosValue *y = AS_OBJ(b);
+  if (x->type != y->type)
     return false;
 
-  switch (a->type) {
-  case VAL_NUMBER:
-    return fabs(a->as.number - b->as.number) < VALUE_COMPARE_EPSILON;
+  switch (x->type) {
   case VAL_STRING:
-    return a->as.string.length == b->as.string.length &&
-           memcmp(a->as.string.data, b->as.string.data, a->as.string.length) ==
+    // Interned strings are unique per content, so distinct ones differ
+    if (x->flags & y->flags & VALUE_FLAG_INTERNED)
+      return false;
+    return x->as.string.length == y->as.string.length &&
+           x->as.string.hash == y->as.string.hash &&
+           memcmp(x->as.string.data, y->as.string.data, x->as.string.length) ==
                0;
-  case VAL_BOOL:
-    return a->as.boolean == b->as.boolean;
-  case VAL_NIL:
-    return true;
   case VAL_LIST:
-    if (a->as.list.count != b->as.list.count)
+    if (x->as.list.count != y->as.list.count)
       return false;
-    for (size_t i = 0; i < a->as.list.count; i++) {
-      if (!value_equals(a->as.list.items[i], b->as.list.items[i]))
+    for (size_t i = 0; i < x->as.list.count; i++) {
+      if (!val_equals(x->as.list.items[i], y->as.list.items[i]))
         return false;
     }
     return true;
   default:
-    return a == b; // Pointer equality for complex types
+    return x == y; // Pointer equality for complex types
+  }
+}
+
+/**
+ * @brief Check if two boxed values are equal
+ *
+ * @param a First value
+ * @param b Second value
+ * @return true if equal, false otherwise
+ */
+bool value_equals(KronosValue *a, KronosValue *b) {
+  if (a == b)
+    return true;
+  if (!a || !b)
+    return false;
+  return val_equals(val_unbox(a), val_unbox(b));
+}
+
+// Rehash the intern table into twice as many buckets (caller holds the lock)
+static bool intern_table_grow(void) {
+  size_t capacity = intern_table.capacity ? intern_table.capacity * 2
+                                          : INTERN_TABLE_MIN_CAPACITY;
+  KronosValue **entries = calloc(capacity, sizeof(KronosValue *));
+  if (!entries)
+    return false;
+  for (size_t i = 0; i < intern_table.capacity; i++) {
+    KronosValue *entry = intern_table.entries[i];
+    if (!entry)
+      continue;
+    size_t bucket = entry->as.string.hash & (capacity - 1);
+    while (entries[bucket])
+      bucket = (bucket + 1) & (capacity - 1);
+    entries[bucket] = entry;
   }
+  free(intern_table.entries);
+  intern_table.entries = entries;
+  intern_table.capacity = capacity;
+  return true;
 }
 
 /**
  * @brief Intern a string (deduplicate identical strings)
  *
- * Returns an existing string value if one with the same content exists,
- * otherwise creates a new one. This reduces memory usage when the same
- * string appears multiple times (e.g., variable names, keywords).
+ * Returns the one string value holding these bytes, creating it on first
+ * use. Interned strings carry VALUE_FLAG_INTERNED, are never modified, and
+ * live until runtime_cleanup(), so two interned strings are equal exactly
+ * when they are the same pointer. The compiler interns every identifier and
+ * string literal.
  *
- * Uses linear probing for collision resolution. Falls back to creating
- * a non-interned string if the table is full.
+ * The table grows as needed; it never falls back to an uninterned string.
  *
  * @param str String to intern
  * @param len Length of the string
- * @return Interned string value (may be existing or newly created)
+ * @return New reference to the interned string, or NULL on allocation failure
+ * @note Thread-safety: Safe to call from any thread.
  */
 KronosValue *string_intern(const char *str, size_t len) {
-  uint32_t hash = hash_string(str, len);
-  size_t index = hash % INTERN_TABLE_SIZE;
-
-  // Linear probing
-  for (size_t i = 0; i < INTERN_TABLE_SIZE; i++) {
-    size_t probe = (index + i) % INTERN_TABLE_SIZE;
-    KronosValue *entry = intern_table[probe];
-
-    if (entry == NULL) {
-      // Not found, create new interned string
-      KronosValue *val = value_new_string(str, len);
-      if (val) {
-        intern_table[probe] = val;
-        value_retain(val); // Extra ref for intern table
-      }
-      return val;
-    }
+  if (len <= 1)
+    return value_new_string(str, len); // Immortal and already unique
 
-    if (entry->type == VAL_STRING && entry->as.string.hash == hash &&
-        entry->as.string.length == len &&
+  uint32_t hash = string_hash(str, len);
+  pthread_mutex_lock(&intern_mutex);
+  if ((intern_table.count + 1) * 4 > intern_table.capacity * 3 &&
+      !intern_table_grow()) {
+    pthread_mutex_unlock(&intern_mutex);
+    return NULL;
+  }
+
+  size_t mask = intern_table.capacity - 1;
+  size_t bucket = hash & mask;
+  KronosValue *entry;
+  while ((entry = intern_table.entries[bucket]) != NULL) {
+    if (entry->as.string.hash == hash && entry->as.string.length == len &&
         memcmp(entry->as.string.data, str, len) == 0) {
-      // Found existing interned string
+      value_retain(entry);
+      pthread_mutex_unlock(&intern_mutex);
       return entry;
     }
+    bucket = (bucket + 1) & mask;
   }
 
-  // Table full, fallback to non-interned string
-  return value_new_string(str, len);
+  // Interned strings are shared by every VM, so they cannot come from one
+  // VM's allocator or count against the budget of the VM that got here first
+  MemAllocator *allocator = mem_set_allocator(NULL);
+  GCBudget *budget = gc_set_budget(NULL);
+  entry = value_new_string(str, len);
+  gc_set_budget(budget);
+  mem_set_allocator(allocator);
+  if (entry) {
+    entry->flags |= VALUE_FLAG_INTERNED | VALUE_FLAG_SHARED;
+    value_retain(entry); // Extra ref for intern table
+    intern_table.entries[bucket] = entry;
+    intern_table.count++;
+  }
+  pthread_mutex_unlock(&intern_mutex);
+  return entry;
 }
 
 /**
@@ -568,23 +1670,36 @@ KronosValue *string_intern(const char *str, size_t len) {
  * - "boolean" for VAL_BOOL
  * - "null" for VAL_NIL
  *
- * @param val Value to check
+ * @param v Value to check
  * @param type_name Type name string (e.g., "number", "string")
  * @return true if value matches the type, false otherwise
  */
-bool value_is_type(KronosValue *val, const char *type_name) {
-  if (!val || !type_name)
+bool val_is_type(Value v, const char *type_name) {
+  if (!type_name)
     return false;
 
   if (strcmp(type_name, "number") == 0) {
-    return val->type == VAL_NUMBER;
+    return IS_NUMBER(v);
   } else if (strcmp(type_name, "string") == 0) {
-    return val->type == VAL_STRING;
+    return IS_STRING(v);
   } else if (strcmp(type_name, "boolean") == 0) {
-    return val->type == VAL_BOOL;
+    return IS_BOOL(v);
   } else if (strcmp(type_name, "null") == 0) {
-    return val->type == VAL_NIL;
+    return IS_NIL(v);
   }
 
   return false;
 }
+
+/**
+ * @brief Check if a boxed value matches a type name
+ *
+ * @param val Value to check
+ * @param type_name Type name string (e.g., "number", "string")
+ * @return true if value matches the type, false otherwise
+ */
+bool value_is_type(KronosValue *val, const char *type_name) {
+  if (!val)
+    return false;
+  return val_is_type(val_unbox(val), type_name);
+}
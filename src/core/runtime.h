@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 typedef struct Channel Channel;
 
@@ -19,27 +20,199 @@ typedef enum {
   VAL_CHANNEL,
 } ValueType;
 
-// Reference-counted value
+// Tagged value word (NaN-boxing)
+//
+// A Value is a 64-bit word that lives directly in stack slots, locals,
+// globals and list storage. Numbers, booleans and nil are immediates and never
+// touch the allocator; only strings, functions, lists and channels are heap
+// objects (KronosValue) reached through a pointer in the low 48 bits.
+//
+// Layout:
+// - Any word whose VALUE_QNAN bits are not all set is an IEEE-754 double.
+//   NaN results are canonicalized so they can never collide with a tag.
+// - VALUE_QNAN | tag encodes nil (1), false (2) and true (3).
+// - VALUE_QNAN | VALUE_INT_TAG | 48-bit two's complement payload encodes an
+//   integral number in [VALUE_INT_MIN, VALUE_INT_MAX]. NUMBER_VAL stores
+//   every such number (except -0) this way, while arithmetic on doubles
+//   keeps its double result even when it is integral, so the form is a fast
+//   path hint rather than an identity: compare numbers with val_equals().
+//   IS_NUMBER and AS_NUMBER treat both forms alike, and scripts cannot tell
+//   them apart. The integer form lets counters and indices stay in integer
+//   arithmetic (see val_number_add()).
+// - VALUE_SIGN_BIT | VALUE_QNAN | pointer encodes a heap object.
+// - VALUE_QNAN with no tag is EMPTY_VAL, an internal "no value" marker used
+//   for stack underflow and unset slots. It is never visible to scripts.
+typedef uint64_t Value;
+
+#define VALUE_SIGN_BIT ((uint64_t)0x8000000000000000)
+#define VALUE_QNAN ((uint64_t)0x7ffc000000000000)
+#define VALUE_CANONICAL_NAN ((uint64_t)0x7ff8000000000000)
+
+#define VALUE_TAG_NIL 1
+#define VALUE_TAG_FALSE 2
+#define VALUE_TAG_TRUE 3
+
+#define VALUE_INT_TAG ((uint64_t)0x0002000000000000)
+#define VALUE_INT_MASK ((uint64_t)0x0000ffffffffffff)
+#define VALUE_INT_MIN (-((int64_t)1 << 47))
+#define VALUE_INT_MAX (((int64_t)1 << 47) - 1)
+
+#define EMPTY_VAL ((Value)VALUE_QNAN)
+#define NIL_VAL ((Value)(VALUE_QNAN | VALUE_TAG_NIL))
+#define FALSE_VAL ((Value)(VALUE_QNAN | VALUE_TAG_FALSE))
+#define TRUE_VAL ((Value)(VALUE_QNAN | VALUE_TAG_TRUE))
+#define BOOL_VAL(b) ((b) ? TRUE_VAL : FALSE_VAL)
+#define NUMBER_VAL(num) value_from_number(num)
+// i must lie in [VALUE_INT_MIN, VALUE_INT_MAX]; see value_from_int()
+#define INT_VAL(i)                                                             \
+  ((Value)(VALUE_QNAN | VALUE_INT_TAG | ((uint64_t)(i) & VALUE_INT_MASK)))
+#define OBJ_VAL(obj)                                                           \
+  ((Value)(VALUE_SIGN_BIT | VALUE_QNAN | (uint64_t)(uintptr_t)(obj)))
+
+#define IS_INT(v)                                                              \
+  (((v) & (VALUE_SIGN_BIT | VALUE_QNAN | VALUE_INT_TAG)) ==                    \
+   (VALUE_QNAN | VALUE_INT_TAG))
+#define IS_NUMBER(v) (((v) & VALUE_QNAN) != VALUE_QNAN || IS_INT(v))
+#define IS_NIL(v) ((v) == NIL_VAL)
+#define IS_BOOL(v) (((v) | 1) == TRUE_VAL)
+#define IS_EMPTY(v) ((v) == EMPTY_VAL)
+#define IS_OBJ(v)                                                              \
+  (((v) & (VALUE_QNAN | VALUE_SIGN_BIT)) == (VALUE_QNAN | VALUE_SIGN_BIT))
+#define IS_STRING(v) (IS_OBJ(v) && AS_OBJ(v)->type == VAL_STRING)
+#define IS_LIST(v) (IS_OBJ(v) && AS_OBJ(v)->type == VAL_LIST)
+
+#define AS_NUMBER(v) value_to_number(v)
+#define AS_INT(v) ((int64_t)((v) << 16) >> 16) // Sign-extend the payload
+#define AS_BOOL(v) ((v) == TRUE_VAL)
+#define AS_OBJ(v)                                                              \
+  ((KronosValue *)(uintptr_t)((v) & ~(VALUE_SIGN_BIT | VALUE_QNAN)))
+#define AS_CSTRING(v) (AS_OBJ(v)->as.string.data)
+#define AS_STRING_LEN(v) (AS_OBJ(v)->as.string.length)
+#define AS_LIST(v) (&AS_OBJ(v)->as.list)
+
+// Store a double as is, without looking for the integer form
+static inline Value value_from_double(double num) {
+  Value v;
+  if (num != num)
+    return (Value)VALUE_CANONICAL_NAN;
+  memcpy(&v, &num, sizeof(v));
+  return v;
+}
+
+static inline Value value_from_number(double num) {
+  Value v = value_from_double(num);
+  if (num >= (double)VALUE_INT_MIN && num <= (double)VALUE_INT_MAX) {
+    int64_t i = (int64_t)num;
+    if ((double)i == num && v != VALUE_SIGN_BIT) // -0 stays a double
+      return INT_VAL(i);
+  }
+  return v;
+}
+
+// Integers outside the immediate range become the nearest double
+static inline Value value_from_int(int64_t i) {
+  if (i >= VALUE_INT_MIN && i <= VALUE_INT_MAX)
+    return INT_VAL(i);
+  return value_from_double((double)i);
+}
+
+static inline double value_to_number(Value v) {
+  if (IS_INT(v))
+    return (double)AS_INT(v);
+  double num;
+  memcpy(&num, &v, sizeof(num));
+  return num;
+}
+
+// Truncate a number toward zero for use as an index or count
+static inline int64_t value_to_index(Value v) {
+  if (IS_INT(v))
+    return AS_INT(v);
+  return (int64_t)value_to_number(v);
+}
+
+// Arithmetic on two numbers (IS_NUMBER must hold for both). Integer operands
+// use overflow-checked integer arithmetic; the result is the double the
+// floating-point operation would give, so the integer form stays invisible.
+// Double operands give a double result, which is not put in integer form.
+static inline Value val_number_add(Value a, Value b) {
+  if (IS_INT(a) && IS_INT(b))
+    return value_from_int(AS_INT(a) + AS_INT(b)); // 48-bit: cannot overflow
+  return value_from_double(value_to_number(a) + value_to_number(b));
+}
+
+static inline Value val_number_sub(Value a, Value b) {
+  if (IS_INT(a) && IS_INT(b))
+    return value_from_int(AS_INT(a) - AS_INT(b));
+  return value_from_double(value_to_number(a) - value_to_number(b));
+}
+
+// Multiply two immediate integers; false if the product overflows int64_t
+static inline bool value_int_mul(int64_t a, int64_t b, int64_t *out) {
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_mul_overflow(a, b, out);
+#else
+  // Operands are at most 2^47 in magnitude, so neither negation overflows
+  int64_t abs_a = a < 0 ? -a : a;
+  int64_t abs_b = b < 0 ? -b : b;
+  if (abs_a != 0 && abs_b > INT64_MAX / abs_a)
+    return false;
+  *out = a * b;
+  return true;
+#endif
+}
+
+static inline Value val_number_mul(Value a, Value b) {
+  int64_t product;
+  // A zero product with a negative operand is -0, which only a double holds
+  if (IS_INT(a) && IS_INT(b) && value_int_mul(AS_INT(a), AS_INT(b), &product) &&
+      (product != 0 || (AS_INT(a) >= 0 && AS_INT(b) >= 0)))
+    return value_from_int(product);
+  return value_from_double(value_to_number(a) * value_to_number(b));
+}
+
+// Object header flags
+#define VALUE_FLAG_GC_TRACKED 0x1u // Counted in the GC statistics
+#define VALUE_FLAG_IMMORTAL 0x2u   // Shared static instance, never counted
+#define VALUE_FLAG_INLINE 0x4u     // String bytes follow the header in one block
+#define VALUE_FLAG_INTERNED 0x8u   // Unique string from string_intern()
+#define VALUE_FLAG_BUFFERED 0x10u  // Candidate root of the cycle collector
+#define VALUE_FLAG_GC_COLOR 0x60u  // Cycle collector scratch color (gc.c)
+#define VALUE_FLAG_RECLAIM 0x80u   // Dead list waiting on a ReclaimQueue
+#define VALUE_FLAG_SHARED 0x100u   // Used by several VMs; atomic refcount
+
+// Reference-counted heap object
 typedef struct KronosValue {
   ValueType type;
   uint32_t refcount;
+  uint32_t flags;    // VALUE_FLAG_* bits
+  uint32_t gc_epoch; // gc_init() generation the object was tracked in
   union {
     double number;
     struct {
       char *data;
       size_t length;
+      size_t capacity; // Bytes data can hold before the terminator
       uint32_t hash;
     } string;
     bool boolean;
     struct {
       uint8_t *bytecode;
       size_t length;
+      // Allocator current when the function was created (a reference, or
+      // NULL for the C library); bytecode is freed through it
+      struct MemAllocator *allocator;
       int arity;
     } function;
     struct {
-      struct KronosValue **items;
+      Value *items;
       size_t count;
       size_t capacity;
+      // Allocator current when the list was created (a reference, or NULL
+      // for the C library); items and the values they hold are freed
+      // through it, since the list may die after its VM or while another
+      // VM's allocator is current
+      struct MemAllocator *allocator;
     } list;
     Channel *channel;
   } as;
@@ -48,17 +221,43 @@ typedef struct KronosValue {
 // Factory/ownership rules:
 // - Each factory returns a new KronosValue with refcount 1 owned by caller.
 // - Callers must eventually release the value via value_release().
+// - value_new_nil, value_new_bool and value_new_number for integers in
+//   [VALUE_SMALL_INT_MIN, VALUE_SMALL_INT_MAX] return shared immortal
+//   instances (VALUE_FLAG_IMMORTAL): retain and release ignore them and the
+//   GC never tracks them. Releasing them like any other value is still fine.
 // - value_new_string copies the provided bytes (treats NULL as "") and owns the
 //   resulting buffer; callers may free their original buffer immediately.
+//   The empty string and single-byte strings are immortal, and short strings
+//   are stored inline (VALUE_FLAG_INLINE), so as.string.data must never be
+//   freed or reallocated by callers.
+// - value_new_char returns the immortal single-byte string for a byte.
+// - value_string_append and value_string_append_parts mutate their string in
+//   place; callers must hold the only references that can observe the change.
+// - string_intern returns a new reference to the unique string with the given
+//   bytes (VALUE_FLAG_INTERNED); interned strings are never mutated. They are
+//   shared by every VM in the process (VALUE_FLAG_SHARED), so retain and
+//   release update their refcount atomically.
 // - value_new_function copies the bytecode buffer (returns NULL when bytecode
 // is
 //   NULL or length == 0) and retains the copy internally.
 // - value_new_list accepts initial_capacity == 0 and picks a default size.
 // - value_new_channel adopts ownership of the Channel* (callers must not free
 //   it after passing it in) and returns NULL on invalid inputs.
+// Integral numbers served from the immortal small-integer cache
+#define VALUE_SMALL_INT_MIN (-128)
+#define VALUE_SMALL_INT_MAX 1023
+
 // Value creation functions
 KronosValue *value_new_number(double num);
 KronosValue *value_new_string(const char *str, size_t len);
+KronosValue *value_new_char(uint8_t ch);
+KronosValue *value_new_string_concat(const char *a, size_t len_a,
+                                     const char *b, size_t len_b);
+KronosValue *value_new_string_parts(const char *const *parts,
+                                    const size_t *lengths, size_t count);
+bool value_string_append(KronosValue *str, const char *data, size_t len);
+bool value_string_append_parts(KronosValue *str, const char *const *parts,
+                               const size_t *lengths, size_t count);
 KronosValue *value_new_bool(bool val);
 KronosValue *value_new_nil(void);
 KronosValue *value_new_function(uint8_t *bytecode, size_t length, int arity);
@@ -69,6 +268,64 @@ KronosValue *value_new_channel(Channel *channel);
 // Both helpers treat NULL inputs as no-ops for convenience.
 void value_retain(KronosValue *val);  // increments refcount if val != NULL
 void value_release(KronosValue *val); // decrements refcount, frees at 0
+// For the cycle collector only: frees values (whose refcounts are ignored)
+// without releasing the lists they contain, whose counts no longer include
+// those references. Their other children are released normally.
+void value_free_unreachable(KronosValue **values, size_t count);
+
+// Deferred reclamation
+// While a thread has a reclaim queue set, value_release() does not tear down
+// a dead list with items: it queues the list, and value_reclaim() later
+// releases its items a few at a time. Lists dying during that work are
+// queued too, so no single call does more than `budget` steps however large
+// the graph. Other values are still freed immediately.
+typedef struct {
+  KronosValue **items; // Dead lists (VALUE_FLAG_RECLAIM), last one first
+  size_t count;
+  size_t capacity;
+  size_t budget; // Steps per slice, used by the owner of the queue
+} ReclaimQueue;
+
+// Sets the calling thread's queue (NULL frees synchronously again) and
+// returns the previous one, which the caller should restore
+ReclaimQueue *value_set_reclaim_queue(ReclaimQueue *queue);
+// Releases at most budget items of queued lists or queued lists themselves;
+// returns true while work remains
+bool value_reclaim(ReclaimQueue *queue, size_t budget);
+// Frees everything still queued and the queue's storage
+void reclaim_queue_free(ReclaimQueue *queue);
+
+static inline void val_retain(Value v) {
+  if (IS_OBJ(v))
+    value_retain(AS_OBJ(v));
+}
+
+static inline void val_release(Value v) {
+  if (IS_OBJ(v))
+    value_release(AS_OBJ(v));
+}
+
+// List helpers
+// value_list_append retains item (if it is a heap object) and grows the
+// backing store as needed. Returns false on allocation failure.
+bool value_list_append(KronosValue *list, Value item);
+// value_list_sort sorts a list of all numbers or all strings in place.
+// Returns false, leaving the list unchanged, for any other mix of items.
+bool value_list_sort(KronosValue *list);
+
+// Tagged value operations
+// - val_retain/val_release forward to value_retain/value_release for heap
+//   objects and are no-ops for immediates.
+// - val_box returns a new KronosValue reference for any Value (allocating a
+//   heap cell for immediates); val_unbox borrows obj and converts number,
+//   boolean and nil cells to immediates. val_unbox(NULL) yields NIL_VAL.
+ValueType val_type(Value v);
+KronosValue *val_box(Value v);
+Value val_unbox(KronosValue *obj);
+void val_fprint(FILE *out, Value v);
+bool val_is_truthy(Value v);
+bool val_equals(Value a, Value b);
+bool val_is_type(Value v, const char *type_name);
 
 // Value operations
 void value_fprint(FILE *out, KronosValue *val);
@@ -78,6 +335,7 @@ bool value_equals(KronosValue *a, KronosValue *b);
 bool value_is_type(KronosValue *val, const char *type_name);
 
 // String interning
+uint32_t string_hash(const char *str, size_t len);
 KronosValue *string_intern(const char *str, size_t len);
 
 // Cleanup
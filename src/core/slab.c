@@ -0,0 +1,497 @@
+/**
+ * @file slab.c
+ * @brief Size-class slab allocator for small runtime objects
+ *
+ * Value headers are small, fixed-size and short-lived, which is the worst
+ * case for a general-purpose malloc. This allocator carves them out of
+ * 64 KiB pages that each hold slots of one size:
+ * - every thread owns a heap with one set of pages per size class, so the
+ *   allocation and same-thread free paths are a pointer pop/push with no lock
+ * - pages are aligned to their size, so a slot finds its page header by
+ *   masking its address
+ * - slots freed by another thread are pushed onto a lock-free list in the
+ *   page and reclaimed by the owner the next time it runs out of slots
+ * - a page whose slots are all free goes back to the system (one spare page
+ *   per class is kept to absorb alloc/free churn at a page boundary)
+ * - pages still in use when their thread exits are orphaned and adopted by
+ *   the next heap that needs a page of the same size
+ */
+
+#include "slab.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** A free slot; the link lives in the slot's own first bytes */
+typedef struct SlabFree {
+  struct SlabFree *next;
+} SlabFree;
+
+/** Where a page currently sits in its heap */
+typedef enum {
+  PAGE_CURRENT, /**< Serving allocations for its class */
+  PAGE_PARTIAL, /**< On the partial list: has locally free slots */
+  PAGE_FULL,    /**< On the full list: every slot handed out */
+  PAGE_SPARE,   /**< Empty page cached for reuse */
+  PAGE_ORPHAN   /**< Owner thread exited; on the global orphan list */
+} SlabPageState;
+
+typedef struct SlabHeap SlabHeap;
+
+/** Page header, stored at the start of every SLAB_PAGE_SIZE-aligned page */
+typedef struct SlabPage {
+  _Atomic(SlabHeap *) heap;       /**< Owning heap (NULL while orphaned) */
+  struct SlabPage *prev;          /**< Links in a heap or orphan list */
+  struct SlabPage *next;
+  SlabFree *free_list;            /**< Slots freed by the owning thread */
+  _Atomic(SlabFree *) remote_free; /**< Slots freed by other threads */
+  uint32_t slot_size;             /**< Bytes per slot */
+  uint32_t capacity;              /**< Slots that fit in the page */
+  uint32_t used;                  /**< Slots not on free_list or unused */
+  uint32_t carved;                /**< Slots handed out at least once */
+  uint8_t size_class;             /**< Index into SlabHeap.classes */
+  uint8_t state;                  /**< SlabPageState */
+} SlabPage;
+
+/** Page header size rounded up so slots stay SLAB_GRANULE-aligned */
+#define SLAB_HEADER_SIZE                                                       \
+  ((sizeof(SlabPage) + SLAB_GRANULE - 1) / SLAB_GRANULE * SLAB_GRANULE)
+
+/**
+ * Pages of one size class in a heap. The counters are written only by the
+ * owning thread and read by slab_get_stats(), hence relaxed atomics.
+ */
+typedef struct {
+  SlabPage *current;         /**< Page allocations are served from */
+  SlabPage *partial;         /**< Pages with free slots */
+  SlabPage *full;            /**< Pages without local free slots */
+  SlabPage *spare;           /**< Cached empty page (may be NULL) */
+  _Atomic size_t page_count; /**< Pages owned, including current and spare */
+  _Atomic size_t live_count; /**< Slots handed out and not reclaimed */
+} SlabClass;
+
+/** Per-thread allocator state */
+struct SlabHeap {
+  SlabClass classes[SLAB_CLASS_COUNT];
+  SlabHeap *prev; /**< Links in the heap registry */
+  SlabHeap *next;
+};
+
+/** Guards the heap registry and the orphan list */
+static pthread_mutex_t slab_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Every live heap, for slab_get_stats() */
+static SlabHeap *slab_heaps = NULL;
+
+/** Pages left behind by exited threads, and their counters */
+static SlabPage *slab_orphans = NULL;
+static size_t orphan_pages[SLAB_CLASS_COUNT];
+static size_t orphan_live[SLAB_CLASS_COUNT];
+static _Atomic size_t orphan_count = 0;
+
+/** Runs heap_destroy() when a thread with a heap exits */
+static pthread_key_t slab_key;
+static pthread_once_t slab_key_once = PTHREAD_ONCE_INIT;
+
+/** The calling thread's heap (NULL until its first allocation) */
+static _Thread_local SlabHeap *slab_heap = NULL;
+
+// Add to a counter that only the calling thread writes
+static void counter_add(_Atomic size_t *counter, size_t delta) {
+  size_t value = atomic_load_explicit(counter, memory_order_relaxed);
+  atomic_store_explicit(counter, value + delta, memory_order_relaxed);
+}
+
+// Subtract from a counter that only the calling thread writes
+static void counter_sub(_Atomic size_t *counter, size_t delta) {
+  size_t value = atomic_load_explicit(counter, memory_order_relaxed);
+  atomic_store_explicit(counter, value - delta, memory_order_relaxed);
+}
+
+// Slots of the given class that fit in one page
+static uint32_t class_capacity(size_t index) {
+  return (uint32_t)((SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) /
+                    ((index + 1) * SLAB_GRANULE));
+}
+
+// Page header of a slot
+static SlabPage *page_of(void *ptr) {
+  return (SlabPage *)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+}
+
+static void list_push(SlabPage **head, SlabPage *page) {
+  page->prev = NULL;
+  page->next = *head;
+  if (*head)
+    (*head)->prev = page;
+  *head = page;
+}
+
+static void list_remove(SlabPage **head, SlabPage *page) {
+  if (page->prev)
+    page->prev->next = page->next;
+  else
+    *head = page->next;
+  if (page->next)
+    page->next->prev = page->prev;
+  page->prev = NULL;
+  page->next = NULL;
+}
+
+/**
+ * @brief Reserve and initialize an empty page
+ *
+ * Slots are carved lazily by page_pop(), so a new page touches only its
+ * header.
+ *
+ * @param heap Owning heap
+ * @param index Size class of the page
+ * @return New page, or NULL on allocation failure
+ */
+static SlabPage *page_new(SlabHeap *heap, size_t index) {
+  SlabPage *page = aligned_alloc(SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+  if (!page)
+    return NULL;
+
+  atomic_init(&page->heap, heap);
+  page->prev = NULL;
+  page->next = NULL;
+  page->free_list = NULL;
+  atomic_init(&page->remote_free, NULL);
+  page->slot_size = (uint32_t)((index + 1) * SLAB_GRANULE);
+  page->capacity = class_capacity(index);
+  page->used = 0;
+  page->carved = 0;
+  page->size_class = (uint8_t)index;
+  page->state = PAGE_CURRENT;
+  return page;
+}
+
+// Take a free slot from a page, or NULL if it has none locally
+static SlabFree *page_pop(SlabPage *page) {
+  SlabFree *slot = page->free_list;
+  if (slot) {
+    page->free_list = slot->next;
+  } else if (page->carved < page->capacity) {
+    slot = (SlabFree *)((char *)page + SLAB_HEADER_SIZE +
+                        (size_t)page->carved * page->slot_size);
+    page->carved++;
+  } else {
+    return NULL;
+  }
+  page->used++;
+  return slot;
+}
+
+// Move slots freed by other threads onto the page's own free list
+static size_t page_collect_remote(SlabPage *page) {
+  SlabFree *slot = atomic_exchange_explicit(&page->remote_free, NULL,
+                                            memory_order_acquire);
+  size_t count = 0;
+  while (slot) {
+    SlabFree *next = slot->next;
+    slot->next = page->free_list;
+    page->free_list = slot;
+    slot = next;
+    count++;
+  }
+  page->used -= (uint32_t)count;
+  return count;
+}
+
+// Keep an empty page as the class spare, or give it back to the system
+static void page_retire(SlabClass *cls, SlabPage *page) {
+  if (!cls->spare) {
+    page->state = PAGE_SPARE;
+    cls->spare = page;
+    return;
+  }
+  free(page);
+  counter_sub(&cls->page_count, 1);
+}
+
+/**
+ * @brief Take over a page left behind by an exited thread
+ *
+ * @param heap Adopting heap
+ * @param index Size class wanted
+ * @return Adopted page, or NULL if no orphan of that class exists
+ */
+static SlabPage *orphan_adopt(SlabHeap *heap, size_t index) {
+  if (atomic_load_explicit(&orphan_count, memory_order_relaxed) == 0)
+    return NULL;
+
+  pthread_mutex_lock(&slab_mutex);
+  SlabPage *page = slab_orphans;
+  while (page && page->size_class != index)
+    page = page->next;
+  if (page) {
+    list_remove(&slab_orphans, page);
+    orphan_pages[index]--;
+    orphan_live[index] -= page->used;
+    atomic_fetch_sub_explicit(&orphan_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&page->heap, heap, memory_order_relaxed);
+  }
+  pthread_mutex_unlock(&slab_mutex);
+
+  if (page) {
+    SlabClass *cls = &heap->classes[index];
+    counter_add(&cls->page_count, 1);
+    counter_add(&cls->live_count, page->used);
+  }
+  return page;
+}
+
+/**
+ * @brief Install a new current page once the old one has run out
+ *
+ * Tries, in order: a page on the partial list, a full page that other
+ * threads have freed slots into, the spare page, an orphaned page and
+ * finally a fresh page from the system.
+ *
+ * @param heap Calling thread's heap
+ * @param index Size class to refill
+ * @return The new current page, or NULL on allocation failure
+ */
+static SlabPage *class_refill(SlabHeap *heap, size_t index) {
+  SlabClass *cls = &heap->classes[index];
+  SlabPage *page = cls->current;
+  if (page) {
+    page->state = PAGE_FULL;
+    list_push(&cls->full, page);
+    cls->current = NULL;
+  }
+
+  page = cls->partial;
+  if (page) {
+    list_remove(&cls->partial, page);
+  } else {
+    for (page = cls->full; page; page = page->next) {
+      if (atomic_load_explicit(&page->remote_free, memory_order_relaxed)) {
+        list_remove(&cls->full, page);
+        break;
+      }
+    }
+  }
+  if (!page && cls->spare) {
+    page = cls->spare;
+    cls->spare = NULL;
+  }
+  if (!page)
+    page = orphan_adopt(heap, index);
+  if (!page) {
+    page = page_new(heap, index);
+    if (!page)
+      return NULL;
+    counter_add(&cls->page_count, 1);
+  }
+
+  page->state = PAGE_CURRENT;
+  cls->current = page;
+  counter_sub(&cls->live_count, page_collect_remote(page));
+  return page;
+}
+
+/**
+ * @brief Release a heap when its thread exits
+ *
+ * Empty pages are freed; pages that still hold live slots are orphaned so
+ * their slots can be freed from other threads and the page reused.
+ *
+ * @param arg The exiting thread's heap
+ */
+static void heap_destroy(void *arg) {
+  SlabHeap *heap = arg;
+  slab_heap = NULL;
+
+  SlabPage *orphans = NULL;
+  for (size_t index = 0; index < SLAB_CLASS_COUNT; index++) {
+    SlabClass *cls = &heap->classes[index];
+    if (cls->current)
+      list_push(&cls->partial, cls->current);
+    if (cls->spare)
+      list_push(&cls->partial, cls->spare);
+    SlabPage *lists[] = {cls->partial, cls->full};
+    for (size_t l = 0; l < 2; l++) {
+      SlabPage *page = lists[l];
+      while (page) {
+        SlabPage *next = page->next;
+        page_collect_remote(page);
+        if (page->used == 0) {
+          free(page);
+        } else {
+          page->state = PAGE_ORPHAN;
+          list_push(&orphans, page);
+        }
+        page = next;
+      }
+    }
+  }
+
+  pthread_mutex_lock(&slab_mutex);
+  if (heap->prev)
+    heap->prev->next = heap->next;
+  else
+    slab_heaps = heap->next;
+  if (heap->next)
+    heap->next->prev = heap->prev;
+  while (orphans) {
+    SlabPage *page = orphans;
+    list_remove(&orphans, page);
+    atomic_store_explicit(&page->heap, NULL, memory_order_relaxed);
+    list_push(&slab_orphans, page);
+    orphan_pages[page->size_class]++;
+    orphan_live[page->size_class] += page->used;
+    atomic_fetch_add_explicit(&orphan_count, 1, memory_order_relaxed);
+  }
+  pthread_mutex_unlock(&slab_mutex);
+
+  free(heap);
+}
+
+static void slab_key_init(void) { pthread_key_create(&slab_key, heap_destroy); }
+
+// The calling thread's heap, created on first use
+static SlabHeap *heap_get(void) {
+  SlabHeap *heap = slab_heap;
+  if (heap)
+    return heap;
+
+  pthread_once(&slab_key_once, slab_key_init);
+  heap = calloc(1, sizeof(SlabHeap));
+  if (!heap)
+    return NULL;
+
+  pthread_mutex_lock(&slab_mutex);
+  heap->next = slab_heaps;
+  if (slab_heaps)
+    slab_heaps->prev = heap;
+  slab_heaps = heap;
+  pthread_mutex_unlock(&slab_mutex);
+
+  pthread_setspecific(slab_key, heap);
+  slab_heap = heap;
+  return heap;
+}
+
+/**
+ * @brief Allocate a small block from the calling thread's heap
+ *
+ * @param size Bytes requested
+ * @return Block, or NULL on allocation failure
+ */
+void *slab_alloc(size_t size) {
+  if (size > SLAB_MAX_SIZE)
+    return malloc(size);
+
+  SlabHeap *heap = heap_get();
+  if (!heap)
+    return NULL;
+
+  size_t index = size == 0 ? 0 : (size - 1) / SLAB_GRANULE;
+  SlabClass *cls = &heap->classes[index];
+  SlabFree *slot = cls->current ? page_pop(cls->current) : NULL;
+  while (!slot) {
+    SlabPage *page = class_refill(heap, index);
+    if (!page)
+      return NULL;
+    slot = page_pop(page);
+  }
+  counter_add(&cls->live_count, 1);
+  return slot;
+}
+
+/**
+ * @brief Return a block to its page
+ *
+ * @param ptr Block from slab_alloc() (NULL is a no-op)
+ * @param size Size passed to slab_alloc()
+ */
+void slab_free(void *ptr, size_t size) {
+  if (!ptr)
+    return;
+  if (size > SLAB_MAX_SIZE) {
+    free(ptr);
+    return;
+  }
+
+  SlabPage *page = page_of(ptr);
+  SlabFree *slot = ptr;
+  SlabHeap *heap = slab_heap;
+  if (!heap ||
+      atomic_load_explicit(&page->heap, memory_order_relaxed) != heap) {
+    // Another thread owns the page: hand the slot over without a lock
+    SlabFree *head =
+        atomic_load_explicit(&page->remote_free, memory_order_relaxed);
+    do {
+      slot->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &page->remote_free, &head, slot, memory_order_release,
+        memory_order_relaxed));
+    return;
+  }
+
+  slot->next = page->free_list;
+  page->free_list = slot;
+  page->used--;
+
+  SlabClass *cls = &heap->classes[page->size_class];
+  counter_sub(&cls->live_count, 1);
+  if (page->state == PAGE_CURRENT)
+    return;
+
+  SlabPage **list = page->state == PAGE_FULL ? &cls->full : &cls->partial;
+  if (page->used == 0) {
+    list_remove(list, page);
+    page_retire(cls, page);
+  } else if (page->state == PAGE_FULL) {
+    list_remove(list, page);
+    page->state = PAGE_PARTIAL;
+    list_push(&cls->partial, page);
+  }
+}
+
+/**
+ * @brief Sum the per-heap and orphan counters into a snapshot
+ *
+ * @param out Receives the statistics
+ */
+void slab_get_stats(SlabStats *out) {
+  memset(out, 0, sizeof(*out));
+  for (size_t index = 0; index < SLAB_CLASS_COUNT; index++)
+    out->classes[index].slot_size = (index + 1) * SLAB_GRANULE;
+
+  pthread_mutex_lock(&slab_mutex);
+  for (SlabHeap *heap = slab_heaps; heap; heap = heap->next) {
+    for (size_t index = 0; index < SLAB_CLASS_COUNT; index++) {
+      SlabClass *cls = &heap->classes[index];
+      out->classes[index].page_count +=
+          atomic_load_explicit(&cls->page_count, memory_order_relaxed);
+      out->classes[index].live_count +=
+          atomic_load_explicit(&cls->live_count, memory_order_relaxed);
+    }
+  }
+  for (size_t index = 0; index < SLAB_CLASS_COUNT; index++) {
+    out->classes[index].page_count += orphan_pages[index];
+    out->classes[index].live_count += orphan_live[index];
+  }
+  pthread_mutex_unlock(&slab_mutex);
+
+  for (size_t index = 0; index < SLAB_CLASS_COUNT; index++) {
+    SlabClassStats *cls = &out->classes[index];
+    cls->slot_count = cls->page_count * class_capacity(index);
+    out->page_count += cls->page_count;
+    out->slot_count += cls->slot_count;
+    out->live_count += cls->live_count;
+    out->live_bytes += cls->live_count * cls->slot_size;
+  }
+  out->page_bytes = out->page_count * SLAB_PAGE_SIZE;
+  if (out->slot_count > 0)
+    out->occupancy = (double)out->live_count / (double)out->slot_count;
+  if (out->page_bytes > 0)
+    out->fragmentation =
+        1.0 - (double)out->live_bytes / (double)out->page_bytes;
+}
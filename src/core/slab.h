@@ -0,0 +1,81 @@
+#ifndef KRONOS_SLAB_H
+#define KRONOS_SLAB_H
+
+#include <stddef.h>
+
+// Size-class slab allocator for small fixed-size runtime objects
+
+/** Slot sizes are multiples of this many bytes */
+#define SLAB_GRANULE 16
+
+/** Largest request served from a slab; bigger ones go to malloc */
+#define SLAB_MAX_SIZE 256
+
+/** Number of size classes (SLAB_GRANULE, 2 * SLAB_GRANULE, ...) */
+#define SLAB_CLASS_COUNT (SLAB_MAX_SIZE / SLAB_GRANULE)
+
+/** Bytes per slab page; pages are aligned to their size */
+#define SLAB_PAGE_SIZE (64 * 1024)
+
+/** Occupancy of one size class */
+typedef struct {
+  size_t slot_size;  /**< Bytes per slot */
+  size_t page_count; /**< Pages holding slots of this size */
+  size_t slot_count; /**< Slots those pages can hold */
+  size_t live_count; /**< Slots handed out and not yet freed */
+} SlabClassStats;
+
+/** Snapshot of the allocator returned by slab_get_stats() */
+typedef struct {
+  size_t page_count;   /**< Pages reserved from the system */
+  size_t page_bytes;   /**< page_count * SLAB_PAGE_SIZE */
+  size_t slot_count;   /**< Slots the reserved pages can hold */
+  size_t live_count;   /**< Slots currently handed out */
+  size_t live_bytes;   /**< Bytes in live slots */
+  double occupancy;    /**< live_count / slot_count (0 when empty) */
+  double fragmentation; /**< 1 - live_bytes / page_bytes (0 when empty) */
+  SlabClassStats classes[SLAB_CLASS_COUNT];
+} SlabStats;
+
+/**
+ * @brief Allocate a small block from the calling thread's slab heap.
+ *
+ * Requests are rounded up to the next multiple of SLAB_GRANULE and served
+ * from 64 KiB pages that hold slots of a single size. Each thread has its
+ * own heap, so allocation takes no lock. Requests larger than SLAB_MAX_SIZE
+ * fall back to malloc().
+ *
+ * @param size Bytes requested (0 is treated as 1)
+ * @return Block aligned to at least 16 bytes, or NULL on allocation failure
+ * @note Thread-safety: Safe to call from any thread.
+ */
+void *slab_alloc(size_t size);
+
+/**
+ * @brief Return a block obtained from slab_alloc().
+ *
+ * Blocks freed by the thread that allocated them go straight back to their
+ * page; blocks freed by another thread are handed to the owning heap
+ * through a lock-free list and reused on its next allocation miss. A page
+ * whose slots are all free is released to the system, except for one spare
+ * page per size class that is kept for reuse.
+ *
+ * @param ptr Block to free (NULL is a no-op)
+ * @param size The size passed to slab_alloc() for this block
+ * @note Thread-safety: Safe to call from any thread.
+ */
+void slab_free(void *ptr, size_t size);
+
+/**
+ * @brief Report slab occupancy and fragmentation across all threads.
+ *
+ * Counters are sampled without stopping other threads, so the snapshot is
+ * approximate while they allocate. Slots freed by a thread other than
+ * their owner count as live until the owner reclaims them.
+ *
+ * @param out Receives the statistics (must not be NULL)
+ * @note Thread-safety: Safe to call from any thread.
+ */
+void slab_get_stats(SlabStats *out);
+
+#endif // KRONOS_SLAB_H
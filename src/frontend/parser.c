@@ -13,6 +13,7 @@
 
 #define _POSIX_C_SOURCE 200809L
 #include "parser.h"
+#include "../core/memory.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -99,7 +100,7 @@ static ASTNode *parse_fstring(Parser *p);
 
 // Create AST node helpers
 static ASTNode *ast_node_new(ASTNodeType type) {
-  ASTNode *node = calloc(1, sizeof(ASTNode));
+  ASTNode *node = mem_calloc(1, sizeof(ASTNode));
   if (!node)
     return NULL;
   node->type = type;
@@ -161,10 +162,10 @@ static ASTNode *parse_value(Parser *p) {
     // Tokenizer already strips quotes, so tok->text contains only the content
     ASTNode *node = ast_node_new_checked(AST_STRING);
     size_t len = tok->length;
-    node->as.string.value = malloc(len + 1);
+    node->as.string.value = mem_alloc(len + 1);
     if (!node->as.string.value) {
       fprintf(stderr, "Memory allocation failed for string value\n");
-      free(node);
+      mem_free(node);
       return NULL;
     }
     strncpy(node->as.string.value, tok->text, len);
@@ -180,10 +181,10 @@ static ASTNode *parse_value(Parser *p) {
   if (tok->type == TOK_NAME) {
     consume_any(p);
     ASTNode *node = ast_node_new_checked(AST_VAR);
-    char *var_name = strdup(tok->text);
+    char *var_name = mem_strdup(tok->text);
     if (!var_name) {
       fprintf(stderr, "Memory allocation failed for variable name\n");
-      free(node);
+      mem_free(node);
       return NULL;
     }
     node->as.var_name = var_name;
@@ -319,7 +320,7 @@ static ASTNode *parse_list_literal(Parser *p) {
   size_t element_count = 0;
   size_t element_capacity = 4;
 
-  elements = malloc(sizeof(ASTNode *) * element_capacity);
+  elements = mem_alloc(sizeof(ASTNode *) * element_capacity);
   if (!elements) {
     fprintf(stderr, "Failed to allocate memory for list elements\n");
     return NULL;
@@ -342,7 +343,7 @@ static ASTNode *parse_list_literal(Parser *p) {
   // Parse first element
   ASTNode *first = parse_expression(p);
   if (!first) {
-    free(elements);
+    mem_free(elements);
     return NULL;
   }
   elements[element_count++] = first;
@@ -354,14 +355,14 @@ static ASTNode *parse_list_literal(Parser *p) {
     if (element_count == element_capacity) {
       size_t new_capacity = element_capacity * 2;
       ASTNode **new_elements =
-          realloc(elements, sizeof(ASTNode *) * new_capacity);
+          mem_realloc(elements, sizeof(ASTNode *) * new_capacity);
       if (!new_elements) {
         fprintf(stderr, "Failed to grow list elements array\n");
         // Cleanup
         for (size_t i = 0; i < element_count; i++) {
           ast_node_free(elements[i]);
         }
-        free(elements);
+        mem_free(elements);
         return NULL;
       }
       elements = new_elements;
@@ -374,7 +375,7 @@ static ASTNode *parse_list_literal(Parser *p) {
       for (size_t i = 0; i < element_count; i++) {
         ast_node_free(elements[i]);
       }
-      free(elements);
+      mem_free(elements);
       return NULL;
     }
     elements[element_count++] = elem;
@@ -407,7 +408,7 @@ static ASTNode *parse_fstring(Parser *p) {
   // Allocate parts array (alternating: string, expr, string, expr, ...)
   size_t part_capacity = 4;
   size_t part_count = 0;
-  ASTNode **parts = malloc(sizeof(ASTNode *) * part_capacity);
+  ASTNode **parts = mem_alloc(sizeof(ASTNode *) * part_capacity);
   if (!parts) {
     fprintf(stderr, "Failed to allocate memory for f-string parts\n");
     return NULL;
@@ -435,14 +436,14 @@ static ASTNode *parse_fstring(Parser *p) {
     if (brace_start > start) {
       size_t str_len = brace_start - start;
       ASTNode *str_node = ast_node_new_checked(AST_STRING);
-      str_node->as.string.value = malloc(str_len + 1);
+      str_node->as.string.value = mem_alloc(str_len + 1);
       if (!str_node->as.string.value) {
         // Cleanup
         for (size_t j = 0; j < part_count; j++) {
           ast_node_free(parts[j]);
         }
-        free(parts);
-        free(str_node);
+        mem_free(parts);
+        mem_free(str_node);
         return NULL;
       }
       memcpy(str_node->as.string.value, content + start, str_len);
@@ -451,13 +452,14 @@ static ASTNode *parse_fstring(Parser *p) {
 
       if (part_count >= part_capacity) {
         size_t new_capacity = part_capacity * 2;
-        ASTNode **new_parts = realloc(parts, sizeof(ASTNode *) * new_capacity);
+        ASTNode **new_parts =
+            mem_realloc(parts, sizeof(ASTNode *) * new_capacity);
         if (!new_parts) {
           ast_node_free(str_node);
           for (size_t j = 0; j < part_count; j++) {
             ast_node_free(parts[j]);
           }
-          free(parts);
+          mem_free(parts);
           return NULL;
         }
         parts = new_parts;
@@ -499,18 +501,18 @@ static ASTNode *parse_fstring(Parser *p) {
         for (size_t j = 0; j < part_count; j++) {
           ast_node_free(parts[j]);
         }
-        free(parts);
+        mem_free(parts);
         return NULL;
       }
 
       // Extract expression string
       size_t expr_len = brace_end - expr_start;
-      char *expr_str = malloc(expr_len + 1);
+      char *expr_str = mem_alloc(expr_len + 1);
       if (!expr_str) {
         for (size_t j = 0; j < part_count; j++) {
           ast_node_free(parts[j]);
         }
-        free(parts);
+        mem_free(parts);
         return NULL;
       }
       memcpy(expr_str, content + expr_start, expr_len);
@@ -518,12 +520,12 @@ static ASTNode *parse_fstring(Parser *p) {
 
       // Tokenize and parse the expression
       TokenArray *expr_tokens = tokenize(expr_str, NULL);
-      free(expr_str);
+      mem_free(expr_str);
       if (!expr_tokens) {
         for (size_t j = 0; j < part_count; j++) {
           ast_node_free(parts[j]);
         }
-        free(parts);
+        mem_free(parts);
         return NULL;
       }
 
@@ -543,19 +545,20 @@ static ASTNode *parse_fstring(Parser *p) {
         for (size_t j = 0; j < part_count; j++) {
           ast_node_free(parts[j]);
         }
-        free(parts);
+        mem_free(parts);
         return NULL;
       }
 
       if (part_count >= part_capacity) {
         size_t new_capacity = part_capacity * 2;
-        ASTNode **new_parts = realloc(parts, sizeof(ASTNode *) * new_capacity);
+        ASTNode **new_parts =
+            mem_realloc(parts, sizeof(ASTNode *) * new_capacity);
         if (!new_parts) {
           ast_node_free(expr_node);
           for (size_t j = 0; j < part_count; j++) {
             ast_node_free(parts[j]);
           }
-          free(parts);
+          mem_free(parts);
           return NULL;
         }
         parts = new_parts;
@@ -570,10 +573,10 @@ static ASTNode *parse_fstring(Parser *p) {
   // If no parts, add empty string
   if (part_count == 0) {
     ASTNode *empty_str = ast_node_new_checked(AST_STRING);
-    empty_str->as.string.value = malloc(1);
+    empty_str->as.string.value = mem_alloc(1);
     if (!empty_str->as.string.value) {
-      free(parts);
-      free(empty_str);
+      mem_free(parts);
+      mem_free(empty_str);
       return NULL;
     }
     empty_str->as.string.value[0] = '\0';
@@ -864,7 +867,7 @@ static ASTNode *parse_assignment(Parser *p, int indent) {
       ast_node_free(value);
       return NULL;
     }
-    type_name = strdup(type_tok->text);
+    type_name = mem_strdup(type_tok->text);
     if (!type_name) {
       fprintf(stderr,
               "Memory allocation failed for assignment type annotation\n");
@@ -875,17 +878,17 @@ static ASTNode *parse_assignment(Parser *p, int indent) {
 
   if (!consume(p, TOK_NEWLINE)) {
     ast_node_free(value);
-    free(type_name);
+    mem_free(type_name);
     return NULL;
   }
 
   ASTNode *node = ast_node_new_checked(AST_ASSIGN);
   node->indent = indent;
-  node->as.assign.name = strdup(name->text);
+  node->as.assign.name = mem_strdup(name->text);
   if (!node->as.assign.name) {
     ast_node_free(value);
-    free(type_name);
-    free(node);
+    mem_free(type_name);
+    mem_free(node);
     return NULL;
   }
   node->as.assign.value = value;
@@ -932,7 +935,7 @@ static ASTNode **parse_block(Parser *p, int parent_indent, size_t *block_size) {
 
   size_t capacity = 8;
   size_t count = 0;
-  ASTNode **block = malloc(sizeof(ASTNode *) * capacity);
+  ASTNode **block = mem_alloc(sizeof(ASTNode *) * capacity);
   if (!block) {
     fprintf(stderr, "Parser failed to allocate block statements\n");
     return NULL;
@@ -984,7 +987,7 @@ static ASTNode **parse_block(Parser *p, int parent_indent, size_t *block_size) {
       for (size_t i = 0; i < count; i++) {
         ast_node_free(block[i]);
       }
-      free(block);
+      mem_free(block);
       if (block_size)
         *block_size = 0;
       return NULL;
@@ -992,13 +995,13 @@ static ASTNode **parse_block(Parser *p, int parent_indent, size_t *block_size) {
 
     if (count >= capacity) {
       capacity *= 2;
-      ASTNode **new_block = realloc(block, sizeof(ASTNode *) * capacity);
+      ASTNode **new_block = mem_realloc(block, sizeof(ASTNode *) * capacity);
       if (!new_block) {
         fprintf(stderr, "Parser failed to grow block statements\n");
         for (size_t i = 0; i < count; i++) {
           ast_node_free(block[i]);
         }
-        free(block);
+        mem_free(block);
         if (block_size)
           *block_size = 0;
         return NULL;
@@ -1102,19 +1105,21 @@ static ASTNode *parse_if(Parser *p, int indent) {
 
         // Grow arrays
         size_t new_count = node->as.if_stmt.else_if_count + 1;
-        ASTNode **new_conditions = realloc(node->as.if_stmt.else_if_conditions,
-                                           sizeof(ASTNode *) * new_count);
-        ASTNode ***new_blocks = realloc(node->as.if_stmt.else_if_blocks,
-                                        sizeof(ASTNode **) * new_count);
-        size_t *new_block_sizes = realloc(node->as.if_stmt.else_if_block_sizes,
-                                          sizeof(size_t) * new_count);
+        ASTNode **new_conditions =
+            mem_realloc(node->as.if_stmt.else_if_conditions,
+                        sizeof(ASTNode *) * new_count);
+        ASTNode ***new_blocks = mem_realloc(node->as.if_stmt.else_if_blocks,
+                                            sizeof(ASTNode **) * new_count);
+        size_t *new_block_sizes =
+            mem_realloc(node->as.if_stmt.else_if_block_sizes,
+                        sizeof(size_t) * new_count);
 
         if (!new_conditions || !new_blocks || !new_block_sizes) {
           ast_node_free(else_if_condition);
           for (size_t i = 0; i < else_if_block_size; i++) {
             ast_node_free(else_if_block[i]);
           }
-          free(else_if_block);
+          mem_free(else_if_block);
           ast_node_free(node);
           return NULL;
         }
@@ -1252,7 +1257,7 @@ static ASTNode *parse_for(Parser *p, int indent) {
 
   ASTNode *node = ast_node_new_checked(AST_FOR);
   node->indent = indent;
-  node->as.for_stmt.var = strdup(var->text);
+  node->as.for_stmt.var = mem_strdup(var->text);
   if (!node->as.for_stmt.var) {
     ast_node_free(iterable);
     if (end)
@@ -1264,9 +1269,9 @@ static ASTNode *parse_for(Parser *p, int indent) {
       for (size_t i = 0; i < block_size; i++) {
         ast_node_free(block[i]);
       }
-      free(block);
+      mem_free(block);
     }
-    free(node);
+    mem_free(node);
     return NULL;
   }
   node->as.for_stmt.iterable = iterable;
@@ -1324,7 +1329,7 @@ static ASTNode *parse_function(Parser *p, int indent) {
   // Parse parameters
   size_t param_capacity = 4;
   size_t param_count = 0;
-  char **params = malloc(sizeof(char *) * param_capacity);
+  char **params = mem_alloc(sizeof(char *) * param_capacity);
   if (!params) {
     fprintf(stderr, "parse_function: failed to allocate params array\n");
     return NULL;
@@ -1336,12 +1341,12 @@ static ASTNode *parse_function(Parser *p, int indent) {
 
     Token *param = consume(p, TOK_NAME);
     if (!param) {
-      free(params);
+      mem_free(params);
       return NULL;
     }
-    char *param_name = strdup(param->text);
+    char *param_name = mem_strdup(param->text);
     if (!param_name) {
-      free(params);
+      mem_free(params);
       return NULL;
     }
     params[param_count++] = param_name;
@@ -1351,29 +1356,29 @@ static ASTNode *parse_function(Parser *p, int indent) {
       param = consume(p, TOK_NAME);
       if (!param) {
         for (size_t i = 0; i < param_count; i++)
-          free(params[i]);
-        free(params);
+          mem_free(params[i]);
+        mem_free(params);
         return NULL;
       }
 
       if (param_count >= param_capacity) {
         size_t new_capacity = param_capacity * 2;
-        char **new_params = realloc(params, sizeof(char *) * new_capacity);
+        char **new_params = mem_realloc(params, sizeof(char *) * new_capacity);
         if (!new_params) {
           fprintf(stderr, "parse_function: failed to grow params array\n");
           for (size_t i = 0; i < param_count; i++)
-            free(params[i]);
-          free(params);
+            mem_free(params[i]);
+          mem_free(params);
           return NULL;
         }
         params = new_params;
         param_capacity = new_capacity;
       }
-      char *param_name_loop = strdup(param->text);
+      char *param_name_loop = mem_strdup(param->text);
       if (!param_name_loop) {
         for (size_t i = 0; i < param_count; i++)
-          free(params[i]);
-        free(params);
+          mem_free(params[i]);
+        mem_free(params);
         return NULL;
       }
       params[param_count++] = param_name_loop;
@@ -1382,15 +1387,15 @@ static ASTNode *parse_function(Parser *p, int indent) {
 
   if (!consume(p, TOK_COLON)) {
     for (size_t i = 0; i < param_count; i++)
-      free(params[i]);
-    free(params);
+      mem_free(params[i]);
+    mem_free(params);
     return NULL;
   }
 
   if (!consume(p, TOK_NEWLINE)) {
     for (size_t i = 0; i < param_count; i++)
-      free(params[i]);
-    free(params);
+      mem_free(params[i]);
+    mem_free(params);
     return NULL;
   }
 
@@ -1398,27 +1403,27 @@ static ASTNode *parse_function(Parser *p, int indent) {
   ASTNode **block = parse_block(p, indent, &block_size);
   if (!block) {
     for (size_t i = 0; i < param_count; i++)
-      free(params[i]);
-    free(params);
+      mem_free(params[i]);
+    mem_free(params);
     return NULL;
   }
 
   ASTNode *node = ast_node_new_checked(AST_FUNCTION);
   node->indent = indent;
-  node->as.function.name = strdup(name->text);
+  node->as.function.name = mem_strdup(name->text);
   if (!node->as.function.name) {
     // Free params
     for (size_t i = 0; i < param_count; i++)
-      free(params[i]);
-    free(params);
+      mem_free(params[i]);
+    mem_free(params);
     // Free block and its statements
     if (block) {
       for (size_t i = 0; i < block_size; i++) {
         ast_node_free(block[i]);
       }
-      free(block);
+      mem_free(block);
     }
-    free(node);
+    mem_free(node);
     return NULL;
   }
   node->as.function.params = params;
@@ -1442,7 +1447,7 @@ static ASTNode *parse_call(Parser *p, int indent) {
   // Parse arguments
   size_t arg_capacity = 4;
   size_t arg_count = 0;
-  ASTNode **args = malloc(sizeof(ASTNode *) * arg_capacity);
+  ASTNode **args = mem_alloc(sizeof(ASTNode *) * arg_capacity);
   if (!args) {
     fprintf(stderr, "parse_call: failed to allocate argument array\n");
     return NULL;
@@ -1454,7 +1459,7 @@ static ASTNode *parse_call(Parser *p, int indent) {
 
     ASTNode *arg = parse_expression(p);
     if (!arg) {
-      free(args);
+      mem_free(args);
       return NULL;
     }
     args[arg_count++] = arg;
@@ -1465,18 +1470,19 @@ static ASTNode *parse_call(Parser *p, int indent) {
       if (!arg) {
         for (size_t i = 0; i < arg_count; i++)
           ast_node_free(args[i]);
-        free(args);
+        mem_free(args);
         return NULL;
       }
 
       if (arg_count >= arg_capacity) {
         size_t new_capacity = arg_capacity * 2;
-        ASTNode **new_args = realloc(args, sizeof(ASTNode *) * new_capacity);
+        ASTNode **new_args =
+            mem_realloc(args, sizeof(ASTNode *) * new_capacity);
         if (!new_args) {
           fprintf(stderr, "parse_call: failed to grow argument array\n");
           for (size_t i = 0; i < arg_count; i++)
             ast_node_free(args[i]);
-          free(args);
+          mem_free(args);
           return NULL;
         }
         args = new_args;
@@ -1491,20 +1497,20 @@ static ASTNode *parse_call(Parser *p, int indent) {
     if (!consume(p, TOK_NEWLINE)) {
       for (size_t i = 0; i < arg_count; i++)
         ast_node_free(args[i]);
-      free(args);
+      mem_free(args);
       return NULL;
     }
   }
 
   ASTNode *node = ast_node_new_checked(AST_CALL);
   node->indent = indent;
-  node->as.call.name = strdup(name->text);
+  node->as.call.name = mem_strdup(name->text);
   if (!node->as.call.name) {
     // Free args
     for (size_t i = 0; i < arg_count; i++)
       ast_node_free(args[i]);
-    free(args);
-    free(node);
+    mem_free(args);
+    mem_free(node);
     return NULL;
   }
   node->as.call.args = args;
@@ -1547,9 +1553,9 @@ static ASTNode *parse_import(Parser *p, int indent) {
 
   ASTNode *node = ast_node_new_checked(AST_IMPORT);
   node->indent = indent;
-  node->as.import.module_name = strdup(module_name->text);
+  node->as.import.module_name = mem_strdup(module_name->text);
   if (!node->as.import.module_name) {
-    free(node);
+    mem_free(node);
     return NULL;
   }
 
@@ -1642,15 +1648,15 @@ static ASTNode *parse_statement(Parser *p) {
 AST *parse(TokenArray *tokens) {
   Parser p = {tokens, 0};
 
-  AST *ast = malloc(sizeof(AST));
+  AST *ast = mem_alloc(sizeof(AST));
   if (!ast)
     return NULL;
 
   ast->capacity = 16;
   ast->count = 0;
-  ast->statements = malloc(sizeof(ASTNode *) * ast->capacity);
+  ast->statements = mem_alloc(sizeof(ASTNode *) * ast->capacity);
   if (!ast->statements) {
-    free(ast);
+    mem_free(ast);
     return NULL;
   }
 
@@ -1669,7 +1675,7 @@ AST *parse(TokenArray *tokens) {
       if (ast->count >= ast->capacity) {
         ast->capacity *= 2;
         ast->statements =
-            realloc(ast->statements, sizeof(ASTNode *) * ast->capacity);
+            mem_realloc(ast->statements, sizeof(ASTNode *) * ast->capacity);
       }
       ast->statements[ast->count++] = stmt;
     } else {
@@ -1698,19 +1704,19 @@ void ast_node_free(ASTNode *node) {
 
   switch (node->type) {
   case AST_STRING:
-    free(node->as.string.value);
+    mem_free(node->as.string.value);
     break;
   case AST_BOOL:
   case AST_NULL:
     // No allocated memory
     break;
   case AST_VAR:
-    free(node->as.var_name);
+    mem_free(node->as.var_name);
     break;
   case AST_ASSIGN:
-    free(node->as.assign.name);
+    mem_free(node->as.assign.name);
     ast_node_free(node->as.assign.value);
-    free(node->as.assign.type_name);
+    mem_free(node->as.assign.type_name);
     break;
   case AST_PRINT:
     ast_node_free(node->as.print.value);
@@ -1724,24 +1730,24 @@ void ast_node_free(ASTNode *node) {
     for (size_t i = 0; i < node->as.if_stmt.block_size; i++) {
       ast_node_free(node->as.if_stmt.block[i]);
     }
-    free(node->as.if_stmt.block);
+    mem_free(node->as.if_stmt.block);
     // Free else-if chains
     for (size_t i = 0; i < node->as.if_stmt.else_if_count; i++) {
       ast_node_free(node->as.if_stmt.else_if_conditions[i]);
       for (size_t j = 0; j < node->as.if_stmt.else_if_block_sizes[i]; j++) {
         ast_node_free(node->as.if_stmt.else_if_blocks[i][j]);
       }
-      free(node->as.if_stmt.else_if_blocks[i]);
+      mem_free(node->as.if_stmt.else_if_blocks[i]);
     }
-    free(node->as.if_stmt.else_if_conditions);
-    free(node->as.if_stmt.else_if_blocks);
-    free(node->as.if_stmt.else_if_block_sizes);
+    mem_free(node->as.if_stmt.else_if_conditions);
+    mem_free(node->as.if_stmt.else_if_blocks);
+    mem_free(node->as.if_stmt.else_if_block_sizes);
     // Free else block
     if (node->as.if_stmt.else_block) {
       for (size_t i = 0; i < node->as.if_stmt.else_block_size; i++) {
         ast_node_free(node->as.if_stmt.else_block[i]);
       }
-      free(node->as.if_stmt.else_block);
+      mem_free(node->as.if_stmt.else_block);
     }
     break;
   case AST_BREAK:
@@ -1749,7 +1755,7 @@ void ast_node_free(ASTNode *node) {
     // No allocated memory
     break;
   case AST_FOR:
-    free(node->as.for_stmt.var);
+    mem_free(node->as.for_stmt.var);
     ast_node_free(node->as.for_stmt.iterable);
     if (node->as.for_stmt.end)
       ast_node_free(node->as.for_stmt.end);
@@ -1758,44 +1764,44 @@ void ast_node_free(ASTNode *node) {
     for (size_t i = 0; i < node->as.for_stmt.block_size; i++) {
       ast_node_free(node->as.for_stmt.block[i]);
     }
-    free(node->as.for_stmt.block);
+    mem_free(node->as.for_stmt.block);
     break;
   case AST_WHILE:
     ast_node_free(node->as.while_stmt.condition);
     for (size_t i = 0; i < node->as.while_stmt.block_size; i++) {
       ast_node_free(node->as.while_stmt.block[i]);
     }
-    free(node->as.while_stmt.block);
+    mem_free(node->as.while_stmt.block);
     break;
   case AST_FUNCTION:
-    free(node->as.function.name);
+    mem_free(node->as.function.name);
     for (size_t i = 0; i < node->as.function.param_count; i++) {
-      free(node->as.function.params[i]);
+      mem_free(node->as.function.params[i]);
     }
-    free(node->as.function.params);
+    mem_free(node->as.function.params);
     for (size_t i = 0; i < node->as.function.block_size; i++) {
       ast_node_free(node->as.function.block[i]);
     }
-    free(node->as.function.block);
+    mem_free(node->as.function.block);
     break;
   case AST_CALL:
-    free(node->as.call.name);
+    mem_free(node->as.call.name);
     for (size_t i = 0; i < node->as.call.arg_count; i++) {
       ast_node_free(node->as.call.args[i]);
     }
-    free(node->as.call.args);
+    mem_free(node->as.call.args);
     break;
   case AST_RETURN:
     ast_node_free(node->as.return_stmt.value);
     break;
   case AST_IMPORT:
-    free(node->as.import.module_name);
+    mem_free(node->as.import.module_name);
     break;
   case AST_LIST:
     for (size_t i = 0; i < node->as.list.element_count; i++) {
       ast_node_free(node->as.list.elements[i]);
     }
-    free(node->as.list.elements);
+    mem_free(node->as.list.elements);
     break;
   case AST_INDEX:
     ast_node_free(node->as.index.list_expr);
@@ -1810,13 +1816,13 @@ void ast_node_free(ASTNode *node) {
     for (size_t i = 0; i < node->as.fstring.part_count; i++) {
       ast_node_free(node->as.fstring.parts[i]);
     }
-    free(node->as.fstring.parts);
+    mem_free(node->as.fstring.parts);
     break;
   default:
     break;
   }
 
-  free(node);
+  mem_free(node);
 }
 
 /**
@@ -1831,8 +1837,8 @@ void ast_free(AST *ast) {
   for (size_t i = 0; i < ast->count; i++) {
     ast_node_free(ast->statements[i]);
   }
-  free(ast->statements);
-  free(ast);
+  mem_free(ast->statements);
+  mem_free(ast);
 }
 
 // Debug print AST
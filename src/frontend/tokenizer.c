@@ -13,6 +13,7 @@
 
 #define _POSIX_C_SOURCE 200809L
 #include "tokenizer.h"
+#include "../core/memory.h"
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -44,15 +45,15 @@ static const char *token_type_names[] = {
  * @return New token array, or NULL on allocation failure
  */
 static TokenArray *token_array_new(void) {
-  TokenArray *arr = malloc(sizeof(TokenArray));
+  TokenArray *arr = mem_alloc(sizeof(TokenArray));
   if (!arr)
     return NULL;
 
   arr->capacity = 32;
   arr->count = 0;
-  arr->tokens = malloc(sizeof(Token) * arr->capacity);
+  arr->tokens = mem_alloc(sizeof(Token) * arr->capacity);
   if (!arr->tokens) {
-    free(arr);
+    mem_free(arr);
     return NULL;
   }
 
@@ -75,11 +76,11 @@ static bool token_array_add(TokenArray *arr, Token token) {
 
   if (arr->count >= arr->capacity) {
     size_t new_capacity = arr->capacity ? arr->capacity * 2 : 1;
-    Token *new_tokens = realloc(arr->tokens, sizeof(Token) * new_capacity);
+    Token *new_tokens = mem_realloc(arr->tokens, sizeof(Token) * new_capacity);
     if (!new_tokens) {
       fprintf(stderr, "Fatal: tokenizer failed to grow token array\n");
       if (token.text)
-        free((void *)token.text);
+        mem_free((void *)token.text);
       return false;
     }
     arr->tokens = new_tokens;
@@ -217,7 +218,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
         }
       }
       Token tok = {TOK_NUMBER, NULL, col - start, 0};
-      char *text_buf = malloc(tok.length + 1);
+      char *text_buf = mem_alloc(tok.length + 1);
       if (!text_buf) {
         fprintf(stderr, "Failed to allocate memory for number literal\n");
         return false;
@@ -226,7 +227,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
       text_buf[tok.length] = '\0';
       tok.text = text_buf;
       if (!token_array_add(arr, tok)) {
-        free(text_buf);
+        mem_free(text_buf);
         return false;
       }
       continue;
@@ -271,7 +272,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
 
       size_t content_len = cursor - content_start;
       Token tok = {is_fstring ? TOK_FSTRING : TOK_STRING, NULL, content_len, 0};
-      char *text_buf = malloc(content_len + 1);
+      char *text_buf = mem_alloc(content_len + 1);
       if (!text_buf) {
         fprintf(stderr, "Failed to allocate memory for string literal\n");
         return false;
@@ -280,7 +281,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
       text_buf[content_len] = '\0';
       tok.text = text_buf;
       if (!token_array_add(arr, tok)) {
-        free(text_buf);
+        mem_free(text_buf);
         return false;
       }
       col = cursor + 1; // Skip closing quote
@@ -299,7 +300,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
       size_t word_len = col - start;
       TokenType type = match_keyword(line + start, word_len);
       Token tok = {type, NULL, word_len, 0};
-      char *text_buf = malloc(tok.length + 1);
+      char *text_buf = mem_alloc(tok.length + 1);
       if (!text_buf) {
         fprintf(stderr, "Failed to allocate memory for identifier token\n");
         return false;
@@ -308,7 +309,7 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
       text_buf[tok.length] = '\0';
       tok.text = text_buf;
       if (!token_array_add(arr, tok)) {
-        free(text_buf);
+        mem_free(text_buf);
         return false;
       }
       continue;
@@ -318,13 +319,13 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
     // Colon is used for if/for/while statement headers
     if (line[col] == ':') {
       Token tok = {TOK_COLON, NULL, 1, 0};
-      tok.text = strdup(":");
+      tok.text = mem_strdup(":");
       if (!tok.text) {
         fprintf(stderr, "Failed to allocate colon token\n");
         return false;
       }
       if (!token_array_add(arr, tok)) {
-        free((void *)tok.text);
+        mem_free((void *)tok.text);
         return false;
       }
       col++;
@@ -333,13 +334,13 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
 
     if (line[col] == ',') {
       Token tok = {TOK_COMMA, NULL, 1, 0};
-      tok.text = strdup(",");
+      tok.text = mem_strdup(",");
       if (!tok.text) {
         fprintf(stderr, "Failed to allocate comma token\n");
         return false;
       }
       if (!token_array_add(arr, tok)) {
-        free((void *)tok.text);
+        mem_free((void *)tok.text);
         return false;
       }
       col++;
@@ -354,14 +355,14 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
   // Add newline token to mark end of line (if line had content)
   // Empty lines don't get newline tokens to avoid clutter
   if (len > 0) {
-    char *newline_text = strdup("\n");
+    char *newline_text = mem_strdup("\n");
     if (!newline_text) {
       fprintf(stderr, "Failed to allocate newline token text\n");
       return false;
     }
     Token tok = {TOK_NEWLINE, newline_text, 1, 0};
     if (!token_array_add(arr, tok)) {
-      free(newline_text);
+      mem_free(newline_text);
       return false;
     }
   }
@@ -379,8 +380,8 @@ static bool tokenize_line(TokenArray *arr, const char *line, int indent) {
 void tokenize_error_free(TokenizeError *err) {
   if (!err)
     return;
-  free(err->message);
-  free(err);
+  mem_free(err->message);
+  mem_free(err);
 }
 
 /**
@@ -399,13 +400,13 @@ static void tokenizer_report_error(TokenizeError **out_err, const char *message,
   if (!out_err || *out_err)
     return;
 
-  TokenizeError *err = malloc(sizeof(TokenizeError));
+  TokenizeError *err = mem_alloc(sizeof(TokenizeError));
   if (!err)
     return;
 
-  err->message = strdup(message ? message : "Tokenizer error");
+  err->message = mem_strdup(message ? message : "Tokenizer error");
   if (!err->message) {
-    free(err);
+    mem_free(err);
     return;
   }
   err->line = line;
@@ -432,9 +433,9 @@ TokenArray *tokenize(const char *source, TokenizeError **out_err) {
   // Validate input
   if (!source) {
     if (out_err) {
-      TokenizeError *err = malloc(sizeof(TokenizeError));
+      TokenizeError *err = mem_alloc(sizeof(TokenizeError));
       if (err) {
-        err->message = strdup("Source code must not be NULL");
+        err->message = mem_strdup("Source code must not be NULL");
         err->line = 0;
         err->column = 0;
         *out_err = err;
@@ -446,9 +447,9 @@ TokenArray *tokenize(const char *source, TokenizeError **out_err) {
   TokenArray *arr = token_array_new();
   if (!arr) {
     if (out_err) {
-      TokenizeError *err = malloc(sizeof(TokenizeError));
+      TokenizeError *err = mem_alloc(sizeof(TokenizeError));
       if (err) {
-        err->message = strdup("Failed to allocate TokenArray");
+        err->message = mem_strdup("Failed to allocate TokenArray");
         err->line = 0;
         err->column = 0;
         *out_err = err;
@@ -509,7 +510,7 @@ TokenArray *tokenize(const char *source, TokenizeError **out_err) {
     size_t content_len = line_len - i;
 
     if (content_len > 0) {
-      char *line = malloc(content_len + 1);
+      char *line = mem_alloc(content_len + 1);
       if (!line) {
         fprintf(stderr, "Failed to allocate memory for line copy on line %zu\n",
                 line_number);
@@ -525,11 +526,11 @@ TokenArray *tokenize(const char *source, TokenizeError **out_err) {
       if (!tokenize_line(arr, line, indent)) {
         tokenizer_report_error(
             out_err, "Failed to tokenize line (out of memory)", line_number, 1);
-        free(line);
+        mem_free(line);
         token_array_free(arr);
         return NULL;
       }
-      free(line);
+      mem_free(line);
     }
 
     // Move to next line
@@ -561,7 +562,7 @@ TokenArray *tokenize(const char *source, TokenizeError **out_err) {
 void token_free(Token *token) {
   if (!token)
     return;
-  free((char *)token->text);
+  mem_free((char *)token->text);
   token->text = NULL;
 }
 
@@ -577,10 +578,10 @@ void token_array_free(TokenArray *array) {
     return;
 
   for (size_t i = 0; i < array->count; i++) {
-    free((char *)array->tokens[i].text);
+    mem_free((char *)array->tokens[i].text);
   }
-  free(array->tokens);
-  free(array);
+  mem_free(array->tokens);
+  mem_free(array);
 }
 
 /**
@@ -64,8 +64,8 @@ typedef struct {
   TokenType type;
   const char
       *text; // Heap-allocated, nul-terminated string owned by this Token.
-             // Allocated via malloc()/strdup() during tokenization.
-             // Must be freed with token_free() or free((char *)text) when
+             // Allocated via mem_alloc()/mem_strdup() during tokenization.
+             // Must be freed with token_free() or mem_free((char *)text) when
              // the Token is no longer part of a TokenArray. If the Token
              // is part of a TokenArray, token_array_free() will free it
              // automatically. The pointer becomes invalid after freeing.
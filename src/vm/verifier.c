@@ -0,0 +1,370 @@
+/**
+ * @file verifier.c
+ * @brief Load-time bytecode verifier
+ *
+ * Walks every reachable instruction once, tracking the operand stack depth
+ * along each path. Bytecode that passes can be executed by the VM's unchecked
+ * loop, which skips operand bounds, constant index and stack depth checks.
+ */
+
+#include "verifier.h"
+#include "../core/memory.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Deepest stack the verifier will track (far beyond STACK_MAX)
+#define VERIFY_DEPTH_LIMIT 65535
+
+typedef struct {
+  const Bytecode *bytecode;
+  size_t local_count;
+  bool is_function;
+  int32_t *depth;    // Stack depth on entry to each offset (-1 = not reached)
+  size_t *worklist;  // Offsets whose instruction still has to be checked
+  size_t work_count;
+  size_t max_depth;
+  const char *error;
+} Verifier;
+
+// Record a failure (keeps the first message)
+static bool verify_fail(Verifier *v, const char *message) {
+  if (!v->error)
+    v->error = message;
+  return false;
+}
+
+// Enter offset with the given stack depth, queueing it on first visit
+static bool verify_edge(Verifier *v, size_t offset, int32_t depth) {
+  if (offset >= v->bytecode->count)
+    return verify_fail(v, "control flow leaves the bytecode");
+  if (depth < 0)
+    return verify_fail(v, "operand stack underflow");
+  if (depth > VERIFY_DEPTH_LIMIT)
+    return verify_fail(v, "operand stack too deep");
+  if ((size_t)depth > v->max_depth)
+    v->max_depth = (size_t)depth;
+
+  if (v->depth[offset] < 0) {
+    v->depth[offset] = depth;
+    v->worklist[v->work_count++] = offset;
+    return true;
+  }
+  if (v->depth[offset] != depth)
+    return verify_fail(v, "inconsistent stack depth at join");
+  return true;
+}
+
+// Ensure n operand bytes follow the opcode at pc
+static bool verify_operands(Verifier *v, size_t pc, size_t n) {
+  if (pc + 1 + n > v->bytecode->count)
+    return verify_fail(v, "truncated instruction operands");
+  return true;
+}
+
+// Read a big-endian 16-bit operand (bounds already checked)
+static uint16_t verify_u16(const Verifier *v, size_t offset) {
+  const uint8_t *code = v->bytecode->code;
+  return (uint16_t)((code[offset] << 8) | code[offset + 1]);
+}
+
+// Constant operand at offset: must index the pool (and be a string if asked)
+static bool verify_constant(Verifier *v, size_t offset, bool need_string) {
+  uint16_t idx = verify_u16(v, offset);
+  if (idx >= v->bytecode->const_count)
+    return verify_fail(v, "constant index out of range");
+  KronosValue *constant = v->bytecode->constants[idx];
+  if (!constant || (need_string && constant->type != VAL_STRING))
+    return verify_fail(v, "name operand is not a string constant");
+  return true;
+}
+
+// Store flags at offset: [mutable:1][has_type:1][type:2 if has_type].
+// Returns the operand length, or 0 on failure.
+static size_t verify_store_flags(Verifier *v, size_t pc, size_t offset) {
+  if (!verify_operands(v, pc, offset - pc + 1))
+    return 0;
+  if (!v->bytecode->code[offset + 1])
+    return offset - pc + 1;
+  if (!verify_operands(v, pc, offset - pc + 3) ||
+      !verify_constant(v, offset + 2, true))
+    return 0;
+  return offset - pc + 3;
+}
+
+/**
+ * @brief Check the instruction at pc and queue its successors
+ *
+ * @param v Verifier state
+ * @param pc Offset of the opcode (already reached with a known depth)
+ * @return true if the instruction is valid
+ */
+static bool verify_instruction(Verifier *v, size_t pc) {
+  const uint8_t *code = v->bytecode->code;
+  int32_t depth = v->depth[pc];
+  size_t next;
+
+  switch (code[pc]) {
+  case OP_LOAD_CONST:
+  case OP_LOAD_VAR:
+    if (!verify_operands(v, pc, 2) ||
+        !verify_constant(v, pc + 1, code[pc] == OP_LOAD_VAR))
+      return false;
+    return verify_edge(v, pc + 3, depth + 1);
+
+  case OP_STORE_VAR:
+    if (!verify_operands(v, pc, 2) || !verify_constant(v, pc + 1, true))
+      return false;
+    next = verify_store_flags(v, pc, pc + 3);
+    return next && verify_edge(v, pc + 1 + next, depth - 1);
+
+  case OP_PRINT:
+  case OP_POP:
+    return verify_edge(v, pc + 1, depth - 1);
+
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_DIV:
+  case OP_EQ:
+  case OP_NEQ:
+  case OP_GT:
+  case OP_LT:
+  case OP_GTE:
+  case OP_LTE:
+  case OP_LIST_GET:
+  case OP_LIST_APPEND:
+    if (depth < 2)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 1, depth - 1);
+
+  case OP_NOT:
+  case OP_LIST_LEN:
+    if (depth < 1)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 1, depth);
+
+  case OP_LIST_SLICE:
+    if (depth < 3)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 1, depth - 2);
+
+  case OP_LIST_ITER:
+    if (depth < 1)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 1, depth + 1);
+
+  case OP_LIST_NEW:
+    if (!verify_operands(v, pc, 2))
+      return false;
+    return verify_edge(v, pc + 3, depth + 1);
+
+  case OP_ADD_CONST:
+  case OP_SUB_CONST:
+    if (!verify_operands(v, pc, 2) || !verify_constant(v, pc + 1, false))
+      return false;
+    if (depth < 1)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 3, depth);
+
+  case OP_INC_LOCAL:
+    if (!verify_operands(v, pc, 3) || !verify_constant(v, pc + 2, false))
+      return false;
+    if (code[pc + 1] >= v->local_count)
+      return verify_fail(v, "frame slot out of range");
+    return verify_edge(v, pc + 4, depth);
+
+  case OP_INC_GLOBAL:
+    if (!verify_operands(v, pc, 4) || !verify_constant(v, pc + 3, false))
+      return false;
+    if (verify_u16(v, pc + 1) >= v->bytecode->global_count)
+      return verify_fail(v, "global index out of range");
+    return verify_edge(v, pc + 5, depth);
+
+  case OP_JUMP: {
+    if (!verify_operands(v, pc, 1))
+      return false;
+    long target = (long)pc + 2 + (int8_t)code[pc + 1];
+    if (target < 0)
+      return verify_fail(v, "control flow leaves the bytecode");
+    return verify_edge(v, (size_t)target, depth);
+  }
+
+  case OP_JUMP_IF_FALSE:
+  case OP_JUMP_IF_TRUE:
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (depth < 1)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 2, depth - 1) &&
+           verify_edge(v, pc + 2 + code[pc + 1], depth - 1);
+
+  case OP_JUMP_IF_NOT_EQ:
+  case OP_JUMP_IF_NOT_NEQ:
+  case OP_JUMP_IF_NOT_GT:
+  case OP_JUMP_IF_NOT_LT:
+  case OP_JUMP_IF_NOT_GTE:
+  case OP_JUMP_IF_NOT_LTE:
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (depth < 2)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 2, depth - 2) &&
+           verify_edge(v, pc + 2 + code[pc + 1], depth - 2);
+
+  case OP_LIST_NEXT:
+    // [list, index] -> [list, index+1, item], or a jump with [list, index]
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (depth < 2)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 2, depth + 1) &&
+           verify_edge(v, pc + 2 + code[pc + 1], depth);
+
+  case OP_RANGE_ITER:
+    if (depth < 3)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 1, depth);
+
+  case OP_RANGE_NEXT:
+    // [counter, end, step] -> [counter+step, end, step, counter], or a jump
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (depth < 3)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 2, depth + 1) &&
+           verify_edge(v, pc + 2 + code[pc + 1], depth);
+
+  case OP_RANGE_TEST:
+    // [counter, end, step] -> [step], jumping or not
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (depth < 3)
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 2, depth - 2) &&
+           verify_edge(v, pc + 2 + code[pc + 1], depth - 2);
+
+  case OP_DEFINE_FUNC: {
+    // [name:2][param_count:1][params:2N][local_count:1][named_count:1]
+    // [names:2K][body_start:2][OP_JUMP][skip:1][body...]
+    if (!verify_operands(v, pc, 3) || !verify_constant(v, pc + 1, true))
+      return false;
+    size_t offset = pc + 4;
+    for (uint8_t i = 0; i < code[pc + 3]; i++, offset += 2) {
+      if (!verify_operands(v, pc, offset + 2 - pc - 1) ||
+          !verify_constant(v, offset, true))
+        return false;
+    }
+    if (!verify_operands(v, pc, offset + 2 - pc - 1))
+      return false;
+    uint8_t named_count = code[offset + 1];
+    offset += 2;
+    for (uint8_t i = 0; i < named_count; i++, offset += 2) {
+      if (!verify_operands(v, pc, offset + 2 - pc - 1) ||
+          !verify_constant(v, offset, true))
+        return false;
+    }
+    if (!verify_operands(v, pc, offset + 4 - pc - 1))
+      return false;
+    // The body is verified when the function is defined
+    return verify_edge(v, offset + 4 + code[offset + 3], depth);
+  }
+
+  case OP_CALL_FUNC:
+    if (!verify_operands(v, pc, 3) || !verify_constant(v, pc + 1, true))
+      return false;
+    if (depth < code[pc + 3])
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 4, depth - code[pc + 3] + 1);
+
+  case OP_CALL_BUILTIN:
+    if (!verify_operands(v, pc, 2))
+      return false;
+    if (code[pc + 1] >= BUILTIN_COUNT)
+      return verify_fail(v, "unknown built-in function id");
+    if (depth < code[pc + 2])
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 3, depth - code[pc + 2] + 1);
+
+  case OP_BUILD_STRING:
+    if (!verify_operands(v, pc, 2))
+      return false;
+    if (code[pc + 1] == 0)
+      return verify_fail(v, "string built from no values");
+    if (depth < code[pc + 1])
+      return verify_fail(v, "operand stack underflow");
+    return verify_edge(v, pc + 3, depth - code[pc + 1] + 1);
+
+  case OP_RETURN_VAL:
+    if (depth < 1)
+      return verify_fail(v, "operand stack underflow");
+    if (!v->is_function)
+      return verify_edge(v, pc + 1, depth); // Top level: value stays pushed
+    // The caller resumes with exactly the return value added to its stack
+    if (depth != 1)
+      return verify_fail(v, "values left on the stack at return");
+    return true;
+
+  case OP_LOAD_LOCAL:
+  case OP_STORE_LOCAL:
+    if (!verify_operands(v, pc, 1))
+      return false;
+    if (code[pc + 1] >= v->local_count)
+      return verify_fail(v, "frame slot out of range");
+    if (code[pc] == OP_LOAD_LOCAL)
+      return verify_edge(v, pc + 2, depth + 1);
+    next = verify_store_flags(v, pc, pc + 2);
+    return next && verify_edge(v, pc + 1 + next, depth - 1);
+
+  case OP_LOAD_GLOBAL:
+  case OP_STORE_GLOBAL:
+    if (!verify_operands(v, pc, 2))
+      return false;
+    if (verify_u16(v, pc + 1) >= v->bytecode->global_count)
+      return verify_fail(v, "global index out of range");
+    if (code[pc] == OP_LOAD_GLOBAL)
+      return verify_edge(v, pc + 3, depth + 1);
+    next = verify_store_flags(v, pc, pc + 3);
+    return next && verify_edge(v, pc + 1 + next, depth - 1);
+
+  case OP_HALT:
+    return true;
+
+  default:
+    return verify_fail(v, "instruction not supported by the VM");
+  }
+}
+
+bool bytecode_verify(const Bytecode *bytecode, size_t local_count,
+                     bool is_function, size_t *max_stack, const char **error) {
+  Verifier v = {.bytecode = bytecode,
+                .local_count = local_count,
+                .is_function = is_function};
+  if (max_stack)
+    *max_stack = 0;
+
+  if (!bytecode || !bytecode->code || bytecode->count == 0) {
+    verify_fail(&v, "empty bytecode");
+  } else {
+    v.depth = mem_alloc(sizeof(int32_t) * bytecode->count);
+    v.worklist = mem_alloc(sizeof(size_t) * bytecode->count);
+    if (!v.depth || !v.worklist) {
+      verify_fail(&v, "out of memory");
+    } else {
+      for (size_t i = 0; i < bytecode->count; i++)
+        v.depth[i] = -1;
+      verify_edge(&v, 0, 0);
+      while (!v.error && v.work_count > 0)
+        verify_instruction(&v, v.worklist[--v.work_count]);
+    }
+    mem_free(v.depth);
+    mem_free(v.worklist);
+  }
+
+  if (error)
+    *error = v.error;
+  if (v.error)
+    return false;
+  if (max_stack)
+    *max_stack = v.max_depth;
+  return true;
+}
@@ -0,0 +1,38 @@
+#ifndef KRONOS_VERIFIER_H
+#define KRONOS_VERIFIER_H
+
+#include "../compiler/compiler.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Load-time bytecode verification for the unchecked interpreter loop
+
+/**
+ * @brief Prove that bytecode is safe to run without per-instruction checks.
+ *
+ * Follows every path from the first instruction and checks that:
+ * - every operand fits inside the code
+ * - constant, global, frame slot and built-in indices are in range, and name
+ *   and type operands are string constants
+ * - jump targets stay inside the code and no path falls off its end
+ * - the operand stack has the same depth on every path into an instruction,
+ *   never drops below zero and holds exactly the return value at each
+ *   OP_RETURN_VAL of a function body
+ *
+ * Function bodies embedded by OP_DEFINE_FUNC are skipped; the VM verifies
+ * each body separately when the function is defined.
+ *
+ * @param bytecode Bytecode to verify (must not be NULL)
+ * @param local_count Frame slots available to the code (0 for top-level code)
+ * @param is_function true for a function body, false for top-level code
+ * @param max_stack Receives the deepest operand stack the code can reach,
+ * relative to its starting depth (may be NULL)
+ * @param error Receives a static description of the first problem found
+ * (may be NULL)
+ * @return true if the bytecode was verified, false otherwise
+ * @note Bytecode modified after verification must be verified again.
+ */
+bool bytecode_verify(const Bytecode *bytecode, size_t local_count,
+                     bool is_function, size_t *max_stack, const char **error);
+
+#endif // KRONOS_VERIFIER_H
@@ -14,8 +14,10 @@
 
 #define _POSIX_C_SOURCE 200809L
 #include "vm.h"
+#include "verifier.h"
 #include <ctype.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <math.h>
 #include <stdarg.h>
@@ -23,6 +25,74 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+
+/*
+ * Opcode pair profiling. Builds with -DKRONOS_OPCODE_STATS count every
+ * dispatched (previous, next) opcode pair across all VMs and print the most
+ * frequent pairs to stderr whenever a VM is freed. The superinstructions
+ * (OP_ADD_CONST, OP_INC_LOCAL, OP_JUMP_IF_NOT_LT, ...) were chosen from this
+ * report; rerun it on new workloads before adding more.
+ */
+#ifdef KRONOS_OPCODE_STATS
+#define OPCODE_STATS_TOP 24
+
+static uint64_t opcode_pair_counts[OP_HALT + 1][OP_HALT + 1];
+static uint8_t opcode_stats_prev = OP_HALT; // HALT -> x marks a run start
+
+static inline void opcode_stats_record(uint8_t op) {
+  if (op > OP_HALT)
+    return;
+  opcode_pair_counts[opcode_stats_prev][op]++;
+  opcode_stats_prev = op;
+}
+
+typedef struct {
+  uint64_t count;
+  uint8_t first;
+  uint8_t second;
+} OpcodePair;
+
+static int opcode_pair_compare(const void *a, const void *b) {
+  uint64_t ca = ((const OpcodePair *)a)->count;
+  uint64_t cb = ((const OpcodePair *)b)->count;
+  return ca < cb ? 1 : ca > cb ? -1 : 0;
+}
+
+// Print the most frequent pairs recorded so far, then reset the counters
+static void opcode_stats_dump(FILE *out) {
+  OpcodePair pairs[(OP_HALT + 1) * (OP_HALT + 1)];
+  size_t pair_count = 0;
+  uint64_t total = 0;
+  for (int i = 0; i <= OP_HALT; i++) {
+    for (int j = 0; j <= OP_HALT; j++) {
+      if (!opcode_pair_counts[i][j])
+        continue;
+      pairs[pair_count++] = (OpcodePair){opcode_pair_counts[i][j],
+                                         (uint8_t)i, (uint8_t)j};
+      total += opcode_pair_counts[i][j];
+    }
+  }
+  if (total == 0)
+    return;
+  qsort(pairs, pair_count, sizeof(OpcodePair), opcode_pair_compare);
+
+  fprintf(out, "=== Opcode pairs (%llu dispatches) ===\n",
+          (unsigned long long)total);
+  for (size_t i = 0; i < pair_count && i < OPCODE_STATS_TOP; i++) {
+    fprintf(out, "%12llu %5.1f%%  %s -> %s\n",
+            (unsigned long long)pairs[i].count,
+            100.0 * (double)pairs[i].count / (double)total,
+            opcode_name(pairs[i].first), opcode_name(pairs[i].second));
+  }
+  memset(opcode_pair_counts, 0, sizeof(opcode_pair_counts));
+  opcode_stats_prev = OP_HALT;
+}
+
+#define RECORD_OPCODE(op) opcode_stats_record(op)
+#else
+#define RECORD_OPCODE(op) ((void)0)
+#endif
 
 /**
  * @brief Finalize error state in the VM
@@ -34,12 +104,25 @@
  * @param owned_message Error message (will be owned by VM, can be NULL)
  * @param fallback_msg Fallback message if owned_message is NULL
  */
-static void vm_finalize_error(KronosVM *vm, KronosErrorCode code,
-                              char *owned_message, const char *fallback_msg) {
-  if (!vm)
-    return;
+static KronosErrorCode vm_finalize_error(KronosVM *vm, KronosErrorCode code,
+                                         char *owned_message,
+                                         const char *fallback_msg) {
+  if (!vm) {
+    mem_free(owned_message);
+    return code;
+  }
+
+  // Whatever operation reported it, a failure caused by the heap budget
+  // refusing an allocation is reported as the memory limit
+  if (code != KRONOS_OK && vm->memory.exceeded) {
+    vm->memory.exceeded = false;
+    mem_free(owned_message);
+    fallback_msg = "memory limit exceeded";
+    owned_message = mem_strdup(fallback_msg);
+    code = KRONOS_ERR_RUNTIME;
+  }
 
-  free(vm->last_error_message);
+  mem_free(vm->last_error_message);
   vm->last_error_message = owned_message;
   vm->last_error_code = code;
 
@@ -49,6 +132,7 @@ static void vm_finalize_error(KronosVM *vm, KronosErrorCode code,
                                    : (fallback_msg ? fallback_msg : "");
     vm->error_callback(vm, code, callback_msg);
   }
+  return code;
 }
 
 static char *vm_format_message(const char *fmt, va_list args) {
@@ -64,12 +148,12 @@ static char *vm_format_message(const char *fmt, va_list args) {
     return NULL;
 
   size_t size = (size_t)needed + 1;
-  char *buffer = malloc(size);
+  char *buffer = mem_alloc(size);
   if (!buffer)
     return NULL;
 
   if (vsnprintf(buffer, size, fmt, args) < 0) {
-    free(buffer);
+    mem_free(buffer);
     return NULL;
   }
 
@@ -83,7 +167,7 @@ void vm_clear_error(KronosVM *vm) {
 void vm_set_error(KronosVM *vm, KronosErrorCode code, const char *message) {
   char *copy = NULL;
   if (message) {
-    copy = strdup(message);
+    copy = mem_strdup(message);
   }
   vm_finalize_error(vm, code, copy, message);
 }
@@ -97,7 +181,8 @@ void vm_set_errorf(KronosVM *vm, KronosErrorCode code, const char *fmt, ...) {
 }
 
 int vm_error(KronosVM *vm, KronosErrorCode code, const char *message) {
-  vm_set_error(vm, code, message);
+  code = vm_finalize_error(vm, code, message ? mem_strdup(message) : NULL,
+                           message);
   return code == KRONOS_OK ? 0 : -(int)code;
 }
 
@@ -106,36 +191,63 @@ int vm_errorf(KronosVM *vm, KronosErrorCode code, const char *fmt, ...) {
   va_start(args, fmt);
   char *message = vm_format_message(fmt, args);
   va_end(args);
-  vm_finalize_error(vm, code, message, fmt);
+  code = vm_finalize_error(vm, code, message, fmt);
   return code == KRONOS_OK ? 0 : -(int)code;
 }
 
 static int vm_propagate_error(KronosVM *vm, KronosErrorCode fallback) {
+  // An allocation refused by the heap budget has not been recorded yet
+  if (vm && vm->memory.exceeded)
+    return vm_error(vm, fallback, NULL);
   KronosErrorCode code =
       (vm && vm->last_error_code != KRONOS_OK) ? vm->last_error_code : fallback;
   return code == KRONOS_OK ? -(int)fallback : -(int)code;
 }
 
+static int vm_store_global(KronosVM *vm, const char *name, Value value,
+                           bool is_mutable, const char *type_name);
+static void code_links_release(CodeLinks *links);
+
 /**
  * @brief Create a new virtual machine instance
  *
  * Initializes a VM with empty stack, no globals, and the built-in Pi constant.
- * The VM is ready to execute bytecode after creation.
+ * The VM is ready to execute bytecode after creation. It holds a reference
+ * to the calling thread's current allocator (see mem_set_allocator()) for
+ * its lifetime.
  *
  * @return New VM instance, or NULL on allocation failure
  */
 KronosVM *vm_new(void) {
-  KronosVM *vm = malloc(sizeof(KronosVM));
+  KronosVM *vm = mem_alloc(sizeof(KronosVM));
   if (!vm)
     return NULL;
 
+  vm->allocator = mem_allocator_retain(mem_allocator);
+
   vm->stack_top = vm->stack;
+  vm->globals = NULL;
   vm->global_count = 0;
+  vm->global_capacity = 0;
+  vm->global_index = NULL;
+  vm->global_index_capacity = 0;
+  vm->links = NULL;
+  vm->verified = false;
+  vm->functions = NULL;
   vm->function_count = 0;
+  vm->function_capacity = 0;
+  vm->retired_functions = NULL;
+  vm->retired_count = 0;
+  vm->retired_capacity = 0;
+  vm->function_epoch = 1;
   vm->call_stack_size = 0;
   vm->current_frame = NULL;
   vm->ip = NULL;
   vm->bytecode = NULL;
+  memset(&vm->reclaim, 0, sizeof(vm->reclaim));
+  vm->reclaim.budget = VM_RECLAIM_BUDGET;
+  memset(&vm->memory, 0, sizeof(vm->memory));
+  gc_budget_set_limits(&vm->memory, 0, 0);
 
   vm->last_error_message = NULL;
   vm->last_error_code = KRONOS_OK;
@@ -143,37 +255,12 @@ KronosVM *vm_new(void) {
 
   // Initialize Pi constant - immutable
   // Note: double precision provides ~15-17 decimal digits of precision
-  KronosValue *pi_value = value_new_number(3.1415926535897932);
-  if (!pi_value) {
-    free(vm);
-    return NULL;
-  }
-
-  // Manually add Pi as immutable global
-  if (vm->global_count < GLOBALS_MAX) {
-    // Allocate into temporary pointers first
-    char *name_copy = strdup("Pi");
-    if (!name_copy) {
-      value_release(pi_value);
-      free(vm);
-      return NULL;
-    }
+  Value pi_value = NUMBER_VAL(3.1415926535897932);
 
-    char *type_copy = strdup("number");
-    if (!type_copy) {
-      free(name_copy);
-      value_release(pi_value);
-      free(vm);
-      return NULL;
-    }
-
-    // Only assign to vm->globals after both allocations succeed
-    vm->globals[vm->global_count].name = name_copy;
-    vm->globals[vm->global_count].value = pi_value;
-    vm->globals[vm->global_count].is_mutable = false; // Immutable!
-    vm->globals[vm->global_count].type_name = type_copy;
-    // No value_retain needed - globals array owns the single reference
-    vm->global_count++;
+  // Add Pi as an immutable, number-typed global
+  if (vm_store_global(vm, "Pi", pi_value, false, "number") != 0) {
+    vm_free(vm);
+    return NULL;
   }
 
   return vm;
@@ -191,36 +278,61 @@ void vm_free(KronosVM *vm) {
   if (!vm)
     return;
 
+  // The VM itself goes last, so keep its allocator in a local
+  MemAllocator *allocator = vm->allocator;
+  MemAllocator *previous_allocator = mem_set_allocator(allocator);
+
   // Release all values on stack
   while (vm->stack_top > vm->stack) {
     vm->stack_top--;
-    value_release(*vm->stack_top);
+    val_release(*vm->stack_top);
   }
 
   // Release call frames
   for (size_t i = 0; i < vm->call_stack_size; i++) {
     CallFrame *frame = &vm->call_stack[i];
     for (size_t j = 0; j < frame->local_count; j++) {
-      free(frame->locals[j].name);
-      value_release(frame->locals[j].value);
-      free(frame->locals[j].type_name);
+      val_release(frame->locals[j].value);
     }
   }
 
   // Release global variables
   for (size_t i = 0; i < vm->global_count; i++) {
-    free(vm->globals[i].name);
-    value_release(vm->globals[i].value);
-    free(vm->globals[i].type_name);
+    value_release(vm->globals[i].name_string);
+    val_release(vm->globals[i].value);
+    value_release(vm->globals[i].boxed);
+    mem_free(vm->globals[i].type_name);
   }
+  mem_free(vm->globals);
+  mem_free(vm->global_index);
 
-  // Release functions
-  for (size_t i = 0; i < vm->function_count; i++) {
+  // Release functions, including replaced definitions
+  for (size_t i = 0; i < vm->function_capacity; i++) {
     function_free(vm->functions[i]);
   }
+  mem_free(vm->functions);
+  for (size_t i = 0; i < vm->retired_count; i++) {
+    function_free(vm->retired_functions[i]);
+  }
+  mem_free(vm->retired_functions);
+
+  reclaim_queue_free(&vm->reclaim);
+  // The VM's garbage cycles are buffered on this thread; free them now
+  // rather than on its next run, while the caller's heap is still there
+  gc_collect_cycles();
+  mem_free(vm->last_error_message);
+  mem_free(vm);
+  mem_set_allocator(previous_allocator);
+  mem_allocator_release(allocator);
+
+#ifdef KRONOS_OPCODE_STATS
+  opcode_stats_dump(stderr);
+#endif
+}
 
-  free(vm->last_error_message);
-  free(vm);
+// Make a VM's allocator current; returns the previous one to restore
+MemAllocator *vm_use_allocator(KronosVM *vm) {
+  return mem_set_allocator(vm->allocator);
 }
 
 // Free a function
@@ -228,58 +340,151 @@ void function_free(Function *func) {
   if (!func)
     return;
 
-  free(func->name);
+  mem_free(func->name);
   for (size_t i = 0; i < func->param_count; i++) {
-    free(func->params[i]);
+    mem_free(func->params[i]);
   }
-  free(func->params);
+  mem_free(func->params);
+  mem_free(func->local_names);
+  code_links_release(func->links);
 
   // Free bytecode structure
-  free(func->bytecode.code);
+  mem_free(func->bytecode.code);
   for (size_t i = 0; i < func->bytecode.const_count; i++) {
     value_release(func->bytecode.constants[i]);
   }
-  free(func->bytecode.constants);
+  mem_free(func->bytecode.constants);
+
+  mem_free(func);
+}
+
+// Find the function table bucket holding name, or the empty bucket where it
+// belongs (the table must have at least one empty bucket)
+static size_t vm_function_bucket(const KronosVM *vm, const char *name,
+                                 uint32_t hash) {
+  size_t mask = vm->function_capacity - 1;
+  size_t bucket = hash & mask;
+  while (vm->functions[bucket]) {
+    const Function *func = vm->functions[bucket];
+    if (func->hash == hash && strcmp(func->name, name) == 0)
+      break;
+    bucket = (bucket + 1) & mask;
+  }
+  return bucket;
+}
+
+// Rehash the function table into twice as many buckets
+static int vm_grow_functions(KronosVM *vm) {
+  size_t capacity = vm->function_capacity ? vm->function_capacity * 2 : 32;
+  Function **functions = mem_calloc(capacity, sizeof(Function *));
+  if (!functions) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to allocate function table");
+  }
+  for (size_t i = 0; i < vm->function_capacity; i++) {
+    Function *func = vm->functions[i];
+    if (!func)
+      continue;
+    size_t bucket = func->hash & (capacity - 1);
+    while (functions[bucket])
+      bucket = (bucket + 1) & (capacity - 1);
+    functions[bucket] = func;
+  }
+  mem_free(vm->functions);
+  vm->functions = functions;
+  vm->function_capacity = capacity;
+  return 0;
+}
 
-  free(func);
+// Free replaced definitions that no call frame is executing any more. Call
+// caches may still point at them, but only under an older function_epoch,
+// so those entries are never followed.
+static void vm_sweep_retired_functions(KronosVM *vm) {
+  size_t kept = 0;
+  for (size_t i = 0; i < vm->retired_count; i++) {
+    Function *func = vm->retired_functions[i];
+    bool running = false;
+    for (size_t j = 0; j < vm->call_stack_size && !running; j++) {
+      running = vm->call_stack[j].function == func;
+    }
+    if (running) {
+      vm->retired_functions[kept++] = func;
+    } else {
+      function_free(func);
+    }
+  }
+  vm->retired_count = kept;
 }
 
 // Define a function
 int vm_define_function(KronosVM *vm, Function *func) {
-  if (!vm || !func) {
+  if (!vm || !func || !func->name) {
     return vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
                     "vm_define_function requires non-null inputs");
   }
 
-  if (vm->function_count >= FUNCTIONS_MAX) {
-    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                     "Maximum number of functions exceeded (%d allowed)",
-                     FUNCTIONS_MAX);
+  // Keep the load factor at or below one half
+  if ((vm->function_count + 1) * 2 > vm->function_capacity) {
+    int status = vm_grow_functions(vm);
+    if (status != 0)
+      return status;
   }
 
-  vm->functions[vm->function_count++] = func;
+  // Bodies that index globals need link state to run unchecked
+  func->verified =
+      (func->bytecode.global_count == 0 || func->links) &&
+      bytecode_verify(&func->bytecode, func->local_count, true,
+                      &func->max_stack, NULL);
+
+  func->hash = string_hash(func->name, strlen(func->name));
+  size_t bucket = vm_function_bucket(vm, func->name, func->hash);
+  Function *old = vm->functions[bucket];
+  if (!old) {
+    vm->functions[bucket] = func;
+    vm->function_count++;
+    return 0;
+  }
+  if (old == func)
+    return 0;
+
+  // Replacing a definition: the old one may still be executing, so park it
+  // until no frame runs it and invalidate every cached call site
+  if (vm->retired_count == vm->retired_capacity) {
+    size_t capacity = vm->retired_capacity ? vm->retired_capacity * 2 : 8;
+    Function **retired =
+        mem_realloc(vm->retired_functions, capacity * sizeof(Function *));
+    if (!retired) {
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate retired function list");
+    }
+    vm->retired_functions = retired;
+    vm->retired_capacity = capacity;
+  }
+  vm->retired_functions[vm->retired_count++] = old;
+  vm->functions[bucket] = func;
+  vm->function_epoch++;
+  vm_sweep_retired_functions(vm);
   return 0;
 }
 
 // Get a function by name
 Function *vm_get_function(KronosVM *vm, const char *name) {
-  for (size_t i = 0; i < vm->function_count; i++) {
-    if (strcmp(vm->functions[i]->name, name) == 0) {
-      return vm->functions[i];
-    }
-  }
-  return NULL;
+  if (!vm || !name || vm->function_count == 0)
+    return NULL;
+  uint32_t hash = string_hash(name, strlen(name));
+  return vm->functions[vm_function_bucket(vm, name, hash)];
 }
 
 /**
  * @brief Push a value onto the VM stack
  *
- * Retains the value while it's on the stack. Fails if stack overflow occurs.
+ * Retains heap objects while they're on the stack; immediates are copied
+ * directly into the slot. Fails if stack overflow occurs.
  *
  * @param vm VM instance
  * @param value Value to push (will be retained)
  */
-static void push(KronosVM *vm, KronosValue *value) {
+static inline void push(KronosVM *vm, Value value) {
   if (vm->stack_top >= vm->stack + STACK_MAX) {
     vm_set_errorf(vm, KRONOS_ERR_RUNTIME,
                   "Stack overflow (too many nested operations or calls)");
@@ -287,7 +492,20 @@ static void push(KronosVM *vm, KronosValue *value) {
   }
   *vm->stack_top = value;
   vm->stack_top++;
-  value_retain(value); // Retain while on stack
+  val_retain(value); // Retain while on stack
+}
+
+/**
+ * @brief Push a newly created heap object onto the VM stack
+ *
+ * Transfers the caller's reference to the stack (no extra retain).
+ *
+ * @param vm VM instance
+ * @param obj Object to push (reference is consumed)
+ */
+static inline void push_object(KronosVM *vm, KronosValue *obj) {
+  push(vm, OBJ_VAL(obj));
+  value_release(obj);
 }
 
 /**
@@ -297,20 +515,36 @@ static void push(KronosVM *vm, KronosValue *value) {
  * counting). Fails if stack underflow occurs.
  *
  * @param vm VM instance
- * @return Popped value, or NULL on underflow
+ * @return Popped value, or EMPTY_VAL on underflow
  */
-static KronosValue *pop(KronosVM *vm) {
+static inline Value pop(KronosVM *vm) {
   if (vm->stack_top <= vm->stack) {
     vm_set_error(vm, KRONOS_ERR_RUNTIME,
                  "Stack underflow (internal error - please report this bug)");
-    return NULL;
+    return EMPTY_VAL;
   }
   vm->stack_top--;
-  KronosValue *val = *vm->stack_top;
-  return val;
+  return *vm->stack_top;
+}
+
+// Unchecked stack access for verified bytecode, whose depth was proven at
+// load time (and the room for it checked on entry)
+static inline void push_unchecked(KronosVM *vm, Value value) {
+  *vm->stack_top++ = value;
+  val_retain(value);
+}
+
+static inline void push_object_unchecked(KronosVM *vm, KronosValue *obj) {
+  *vm->stack_top++ = OBJ_VAL(obj); // The caller's reference moves over
+}
+
+static inline Value pop_unchecked(KronosVM *vm) { return *--vm->stack_top; }
+
+static inline Value peek_unchecked(KronosVM *vm, int distance) {
+  return vm->stack_top[-1 - distance];
 }
 
-static KronosValue *peek(KronosVM *vm, int distance) {
+static Value peek(KronosVM *vm, int distance) {
   // Bounds checking: ensure distance is valid
   // Guard: distance must be >= 0 and < stack size
   if (distance < 0) {
@@ -336,213 +570,421 @@ static KronosValue *peek(KronosVM *vm, int distance) {
 }
 
 /**
- * @brief Set or create a global variable
- *
- * Creates a new global variable or updates an existing mutable one.
- * Enforces immutability and type checking if type_name was specified.
+ * @brief Find the slot of a global variable by name
  *
  * @param vm VM instance
  * @param name Variable name
- * @param value Value to assign (will be retained by VM)
- * @param is_mutable Whether the variable can be reassigned
- * @param type_name Optional type annotation (e.g., "number", "string")
- * @return 0 on success, negative error code on failure
+ * @param len Length of name
+ * @param hash string_hash() of name
+ * @return Slot index, or -1 if the name has no slot
  */
-int vm_set_global(KronosVM *vm, const char *name, KronosValue *value,
-                  bool is_mutable, const char *type_name) {
-  if (!vm || !name || !value) {
-    return vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
-                    "vm_set_global requires non-null inputs");
+static long vm_find_global(const KronosVM *vm, const char *name, size_t len,
+                           uint32_t hash) {
+  if (vm->global_index_capacity == 0)
+    return -1;
+  size_t mask = vm->global_index_capacity - 1;
+  for (size_t bucket = hash & mask; vm->global_index[bucket];
+       bucket = (bucket + 1) & mask) {
+    const GlobalVar *global = &vm->globals[vm->global_index[bucket] - 1];
+    // Names taken from compiled code are the interned bytes themselves
+    if (global->hash == hash &&
+        (global->name == name ||
+         (strncmp(global->name, name, len) == 0 && global->name[len] == '\0')))
+      return (long)vm->global_index[bucket] - 1;
   }
+  return -1;
+}
 
-  // Check if variable already exists
+// Rebuild the global hash index with twice as many buckets
+static int vm_grow_global_index(KronosVM *vm) {
+  size_t capacity =
+      vm->global_index_capacity ? vm->global_index_capacity * 2 : 64;
+  uint32_t *index = mem_calloc(capacity, sizeof(uint32_t));
+  if (!index) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to allocate global variable index");
+  }
   for (size_t i = 0; i < vm->global_count; i++) {
-    if (strcmp(vm->globals[i].name, name) == 0) {
-      // Check if it's immutable
-      if (!vm->globals[i].is_mutable) {
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Cannot reassign immutable variable '%s'", name);
-      }
-
-      // Check type if specified
-      if (vm->globals[i].type_name != NULL &&
-          !value_is_type(value, vm->globals[i].type_name)) {
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Type mismatch for variable '%s': expected '%s'", name,
-                         vm->globals[i].type_name);
-      }
-
-      value_release(vm->globals[i].value);
-      vm->globals[i].value = value;
-      value_retain(value);
-      return 0;
-    }
+    size_t bucket = vm->globals[i].hash & (capacity - 1);
+    while (index[bucket])
+      bucket = (bucket + 1) & (capacity - 1);
+    index[bucket] = (uint32_t)i + 1;
   }
+  mem_free(vm->global_index);
+  vm->global_index = index;
+  vm->global_index_capacity = capacity;
+  return 0;
+}
 
-  // Add new global
-  if (vm->global_count >= GLOBALS_MAX) {
-    fprintf(stderr,
-            "Fatal error: Maximum number of global variables exceeded (%d "
-            "allowed)\n",
-            GLOBALS_MAX);
-    fflush(stderr);
-    exit(1);
+/**
+ * @brief Find or create the slot of a global variable
+ *
+ * New slots start unassigned (EMPTY_VAL), so code can be linked against a
+ * global before the statement that defines it has run.
+ *
+ * @param vm VM instance
+ * @param name Variable name (interned on creation)
+ * @param len Length of name
+ * @param out_slot Receives the slot index
+ * @return 0 on success, negative error code on allocation failure
+ */
+static int vm_global_slot(KronosVM *vm, const char *name, size_t len,
+                          uint32_t *out_slot) {
+  uint32_t hash = string_hash(name, len);
+  long found = vm_find_global(vm, name, len, hash);
+  if (found >= 0) {
+    *out_slot = (uint32_t)found;
+    return 0;
   }
 
-  // Allocate into temporary pointers first, check each for NULL
-  char *name_copy = strdup(name);
-  if (!name_copy) {
-    return vm_error(vm, KRONOS_ERR_INTERNAL,
-                    "Failed to allocate memory for variable name");
+  if (vm->global_count >= UINT32_MAX - 1) {
+    return vm_error(vm, KRONOS_ERR_RUNTIME,
+                    "Maximum number of global variables exceeded");
   }
-
-  char *type_copy = NULL;
-  if (type_name) {
-    type_copy = strdup(type_name);
-    if (!type_copy) {
-      // Free already-allocated name_copy on failure
-      free(name_copy);
+  if ((vm->global_count + 1) * 2 > vm->global_index_capacity) {
+    int status = vm_grow_global_index(vm);
+    if (status != 0)
+      return status;
+  }
+  if (vm->global_count >= vm->global_capacity) {
+    size_t capacity = vm->global_capacity ? vm->global_capacity * 2 : 32;
+    GlobalVar *globals = mem_realloc(vm->globals, capacity * sizeof(GlobalVar));
+    if (!globals) {
       return vm_error(vm, KRONOS_ERR_INTERNAL,
-                      "Failed to allocate memory for type name");
+                      "Failed to grow global variable table");
     }
+    vm->globals = globals;
+    vm->global_capacity = capacity;
   }
 
-  // Call value_retain before modifying vm->globals
-  value_retain(value);
-
-  // Only assign to vm->globals after all allocations succeed
-  vm->globals[vm->global_count].name = name_copy;
-  vm->globals[vm->global_count].value = value;
-  vm->globals[vm->global_count].is_mutable = is_mutable;
-  vm->globals[vm->global_count].type_name = type_copy;
+  KronosValue *name_string = string_intern(name, len);
+  if (!name_string) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to allocate memory for variable name");
+  }
 
-  // Only increment global_count after everything succeeds
-  vm->global_count++;
+  GlobalVar *global = &vm->globals[vm->global_count];
+  global->name = name_string->as.string.data;
+  global->name_string = name_string;
+  global->hash = hash;
+  global->value = EMPTY_VAL;
+  global->boxed = NULL;
+  global->is_mutable = true;
+  global->type_name = NULL;
+
+  size_t mask = vm->global_index_capacity - 1;
+  size_t bucket = hash & mask;
+  while (vm->global_index[bucket])
+    bucket = (bucket + 1) & mask;
+  vm->global_index[bucket] = (uint32_t)vm->global_count + 1;
+
+  *out_slot = (uint32_t)vm->global_count++;
   return 0;
 }
 
-KronosValue *vm_get_global(KronosVM *vm, const char *name) {
-  for (size_t i = 0; i < vm->global_count; i++) {
-    if (strcmp(vm->globals[i].name, name) == 0) {
-      return vm->globals[i].value;
+/**
+ * @brief Assign a global variable slot
+ *
+ * The first assignment fixes the variable's mutability and type; later
+ * assignments enforce immutability and type checking.
+ *
+ * @param vm VM instance
+ * @param slot Global slot index
+ * @param value Value to assign (heap objects are retained by the VM)
+ * @param is_mutable Whether the variable can be reassigned
+ * @param type_name Optional type annotation (e.g., "number", "string")
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_assign_global(KronosVM *vm, uint32_t slot, Value value,
+                            bool is_mutable, const char *type_name) {
+  GlobalVar *global = &vm->globals[slot];
+
+  if (IS_EMPTY(global->value)) {
+    char *type_copy = NULL;
+    if (type_name) {
+      type_copy = mem_strdup(type_name);
+      if (!type_copy) {
+        return vm_error(vm, KRONOS_ERR_INTERNAL,
+                        "Failed to allocate memory for type name");
+      }
+    }
+    global->is_mutable = is_mutable;
+    global->type_name = type_copy;
+  } else {
+    // Check if it's immutable
+    if (!global->is_mutable) {
+      return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                       "Cannot reassign immutable variable '%s'",
+                       global->name);
+    }
+
+    // Check type if specified
+    if (global->type_name != NULL && !val_is_type(value, global->type_name)) {
+      return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                       "Type mismatch for variable '%s': expected '%s'",
+                       global->name, global->type_name);
     }
+    val_release(global->value);
+    value_release(global->boxed);
+    global->boxed = NULL;
   }
-  return NULL;
+
+  val_retain(value);
+  global->value = value;
+  return 0;
+}
+
+/**
+ * @brief Set or create a global variable from a tagged value
+ *
+ * @param vm VM instance
+ * @param name Variable name
+ * @param value Value to assign (heap objects are retained by the VM)
+ * @param is_mutable Whether the variable can be reassigned
+ * @param type_name Optional type annotation (e.g., "number", "string")
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_store_global(KronosVM *vm, const char *name, Value value,
+                           bool is_mutable, const char *type_name) {
+  uint32_t slot;
+  int status = vm_global_slot(vm, name, strlen(name), &slot);
+  if (status != 0)
+    return status;
+  return vm_assign_global(vm, slot, value, is_mutable, type_name);
 }
 
-// Set local variable in current frame
-int vm_set_local(KronosVM *vm, CallFrame *frame, const char *name,
-                 KronosValue *value, bool is_mutable, const char *type_name) {
-  if (!vm || !frame || !name || !value)
+/**
+ * @brief Set or create a global variable
+ *
+ * Boxed entry point for embedders and tests; see vm_store_global().
+ *
+ * @param vm VM instance
+ * @param name Variable name
+ * @param value Value to assign (will be retained by VM)
+ * @param is_mutable Whether the variable can be reassigned
+ * @param type_name Optional type annotation (e.g., "number", "string")
+ * @return 0 on success, negative error code on failure
+ */
+int vm_set_global(KronosVM *vm, const char *name, KronosValue *value,
+                  bool is_mutable, const char *type_name) {
+  if (!vm || !name || !value) {
     return vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
-                    "vm_set_local requires non-null inputs");
+                    "vm_set_global requires non-null inputs");
+  }
+  return vm_store_global(vm, name, val_unbox(value), is_mutable, type_name);
+}
 
-  // Check if variable already exists
-  for (size_t i = 0; i < frame->local_count; i++) {
-    if (strcmp(frame->locals[i].name, name) == 0) {
-      // Check if it's immutable
-      if (!frame->locals[i].is_mutable) {
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Cannot reassign immutable local variable '%s'", name);
-      }
+/**
+ * @brief Look up a global variable as a tagged value
+ *
+ * @param vm VM instance
+ * @param name Variable name
+ * @return The value (borrowed), or EMPTY_VAL if not defined
+ */
+static Value vm_load_global(KronosVM *vm, const char *name) {
+  size_t len = strlen(name);
+  long slot = vm_find_global(vm, name, len, string_hash(name, len));
+  return slot < 0 ? EMPTY_VAL : vm->globals[slot].value;
+}
 
-      // Check type if specified
-      if (frame->locals[i].type_name != NULL &&
-          !value_is_type(value, frame->locals[i].type_name)) {
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Type mismatch for local variable '%s': expected '%s'",
-                         name, frame->locals[i].type_name);
-      }
+KronosValue *vm_get_global(KronosVM *vm, const char *name) {
+  size_t len = strlen(name);
+  long slot = vm_find_global(vm, name, len, string_hash(name, len));
+  if (slot < 0)
+    return NULL;
 
-      value_release(frame->locals[i].value);
-      frame->locals[i].value = value;
-      value_retain(value);
-      return 0;
-    }
-  }
+  GlobalVar *global = &vm->globals[slot];
+  if (IS_EMPTY(global->value))
+    return NULL;
+  if (IS_OBJ(global->value))
+    return AS_OBJ(global->value);
+  if (!global->boxed)
+    global->boxed = val_box(global->value);
+  return global->boxed;
+}
 
-  // Add new local variable
-  if (frame->local_count >= LOCALS_MAX) {
-    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                     "Maximum number of local variables exceeded (%d allowed)",
-                     LOCALS_MAX);
-  }
+// Drop a reference to link state, freeing it with the last one
+static void code_links_release(CodeLinks *links) {
+  if (!links || --links->refcount > 0)
+    return;
+  mem_free(links->global_links);
+  mem_free(links->call_cache);
+  mem_free(links->constants);
+  mem_free(links);
+}
 
-  // Allocate into temporary pointers first, check each for NULL
-  char *name_copy = strdup(name);
-  if (!name_copy) {
-    // Allocation failure: release value and return error without modifying
-    // frame state
-    value_release(value);
+/**
+ * @brief Link a bytecode against the VM
+ *
+ * Resolves every name in bytecode->globals once, creating unassigned slots
+ * for names that have not been defined yet, allocates an empty call-site
+ * cache with one entry per constant, and unboxes every constant so loads and
+ * constant arithmetic skip val_unbox().
+ *
+ * @param vm VM instance
+ * @param bytecode Bytecode to link
+ * @param out_links Receives the new link state (refcount 1)
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_link_code(KronosVM *vm, const Bytecode *bytecode,
+                        CodeLinks **out_links) {
+  *out_links = NULL;
+  CodeLinks *links = mem_calloc(1, sizeof(CodeLinks));
+  if (!links) {
     return vm_error(vm, KRONOS_ERR_INTERNAL,
-                    "Failed to allocate memory for local name");
+                    "Failed to allocate bytecode link state");
   }
+  links->refcount = 1;
 
-  char *type_copy = NULL;
-  if (type_name) {
-    type_copy = strdup(type_name);
-    if (!type_copy) {
-      // Allocation failure: free already-allocated name_copy, release value,
-      // and return error
-      free(name_copy);
-      value_release(value);
+  // Epoch 0 never matches vm->function_epoch, so every entry starts empty
+  if (bytecode->const_count > 0) {
+    links->call_cache = mem_calloc(bytecode->const_count, sizeof(CallCache));
+    if (!links->call_cache) {
+      code_links_release(links);
       return vm_error(vm, KRONOS_ERR_INTERNAL,
-                      "Failed to allocate memory for local type");
+                      "Failed to allocate call site cache");
     }
+    links->constants = mem_alloc(sizeof(Value) * bytecode->const_count);
+    if (!links->constants) {
+      code_links_release(links);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate constant table");
+    }
+    for (size_t i = 0; i < bytecode->const_count; i++)
+      links->constants[i] = val_unbox(bytecode->constants[i]);
   }
 
-  // Only assign to frame->locals[...] after all allocations succeed
-  frame->locals[frame->local_count].name = name_copy;
-  frame->locals[frame->local_count].value = value;
-  frame->locals[frame->local_count].is_mutable = is_mutable;
-  frame->locals[frame->local_count].type_name = type_copy;
-
-  // Only call value_retain after all allocations and assignments succeed
-  value_retain(value);
-  // Only increment frame->local_count after everything succeeds
-  frame->local_count++;
+  if (bytecode->global_count > 0) {
+    links->global_links = mem_alloc(sizeof(uint32_t) * bytecode->global_count);
+    if (!links->global_links) {
+      code_links_release(links);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate global link table");
+    }
+  }
+  for (size_t i = 0; i < bytecode->global_count; i++) {
+    KronosValue *name = bytecode->globals[i] < bytecode->const_count
+                            ? bytecode->constants[bytecode->globals[i]]
+                            : NULL;
+    if (!name || name->type != VAL_STRING) {
+      code_links_release(links);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Global name constant is not a string");
+    }
+    int status = vm_global_slot(vm, name->as.string.data,
+                                name->as.string.length,
+                                &links->global_links[i]);
+    if (status != 0) {
+      code_links_release(links);
+      return status;
+    }
+  }
+  *out_links = links;
   return 0;
 }
 
-// Get local variable from current frame
-KronosValue *vm_get_local(CallFrame *frame, const char *name) {
-  if (!frame)
-    return NULL;
+/**
+ * @brief Store a value into a frame slot
+ *
+ * The first store in a call fixes the slot's mutability and type; later
+ * stores are checked against them, mirroring vm_store_global().
+ *
+ * @param vm VM instance
+ * @param frame Call frame owning the slot
+ * @param slot Slot index (must be < frame->local_count)
+ * @param value Value to assign (heap objects are retained by the frame)
+ * @param is_mutable Whether the variable can be reassigned
+ * @param type_name Optional type annotation (borrowed, must outlive the frame)
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_store_local(KronosVM *vm, CallFrame *frame, size_t slot,
+                          Value value, bool is_mutable,
+                          const char *type_name) {
+  if (IS_EMPTY(frame->locals[slot].value)) {
+    frame->locals[slot].is_mutable = is_mutable;
+    frame->locals[slot].type_name = type_name;
+  } else {
+    const char *name = frame->function->local_names[slot];
+    if (!frame->locals[slot].is_mutable) {
+      return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                       "Cannot reassign immutable local variable '%s'",
+                       name ? name : "?");
+    }
+    if (frame->locals[slot].type_name != NULL &&
+        !val_is_type(value, frame->locals[slot].type_name)) {
+      return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                       "Type mismatch for local variable '%s': expected '%s'",
+                       name ? name : "?", frame->locals[slot].type_name);
+    }
+    val_release(frame->locals[slot].value);
+  }
+
+  val_retain(value);
+  frame->locals[slot].value = value;
+  return 0;
+}
 
+// Find the slot a frame's function assigned to a name (-1 if none)
+static int vm_find_local(const CallFrame *frame, const char *name) {
+  if (!frame->function)
+    return -1;
   for (size_t i = 0; i < frame->local_count; i++) {
-    if (strcmp(frame->locals[i].name, name) == 0) {
-      return frame->locals[i].value;
-    }
+    const char *slot_name = frame->function->local_names[i];
+    if (slot_name && strcmp(slot_name, name) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+// Set local variable in a frame by name
+int vm_set_local(KronosVM *vm, CallFrame *frame, const char *name, Value value,
+                 bool is_mutable, const char *type_name) {
+  if (!vm || !frame || !name || IS_EMPTY(value))
+    return vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
+                    "vm_set_local requires non-null inputs");
+
+  int slot = vm_find_local(frame, name);
+  if (slot < 0) {
+    return vm_errorf(vm, KRONOS_ERR_NOT_FOUND,
+                     "Function has no local variable '%s'", name);
   }
+  return vm_store_local(vm, frame, (size_t)slot, value, is_mutable,
+                        type_name);
+}
+
+// Get local variable from a frame by name
+Value vm_get_local(CallFrame *frame, const char *name) {
+  if (!frame)
+    return EMPTY_VAL;
 
-  return NULL;
+  int slot = vm_find_local(frame, name);
+  return slot < 0 ? EMPTY_VAL : frame->locals[slot].value;
 }
 
 // Get variable (try local first, then global)
-KronosValue *vm_get_variable(KronosVM *vm, const char *name) {
+Value vm_get_variable(KronosVM *vm, const char *name) {
   // Try local variables if in function
   if (vm->current_frame) {
-    KronosValue *local = vm_get_local(vm->current_frame, name);
-    if (local)
+    Value local = vm_get_local(vm->current_frame, name);
+    if (!IS_EMPTY(local))
       return local;
   }
 
   // Try global variables
-  KronosValue *global = vm_get_global(vm, name);
-  if (global)
+  Value global = vm_load_global(vm, name);
+  if (!IS_EMPTY(global))
     return global;
 
   vm_set_errorf(vm, KRONOS_ERR_NOT_FOUND, "Undefined variable '%s'", name);
-  return NULL;
+  return EMPTY_VAL;
 }
 
-// Read byte from bytecode
-static uint8_t read_byte(KronosVM *vm) {
-  // Compute current offset and compare against bytecode count
-  size_t offset = vm->ip - vm->bytecode->code;
-  if (offset >= vm->bytecode->count) {
+// Read byte from bytecode, advancing *ip (which must not pass end)
+static inline uint8_t read_byte(KronosVM *vm, uint8_t **ip,
+                                const uint8_t *end) {
+  if (*ip >= end) {
     // Out of bounds: set error state and return sentinel value
-    // Do not increment vm->ip when out of range
+    // Do not increment the instruction pointer when out of range
     vm_set_error(
         vm, KRONOS_ERR_RUNTIME,
         "Bytecode read out of bounds (truncated or malformed bytecode)");
@@ -550,19 +992,21 @@ static uint8_t read_byte(KronosVM *vm) {
     return OP_HALT;
   }
   // Safe to dereference and increment
-  return *vm->ip++;
+  return *(*ip)++;
 }
 
 // Read 16-bit value (big-endian)
-static uint16_t read_uint16(KronosVM *vm) {
-  uint16_t high = read_byte(vm);
-  uint16_t low = read_byte(vm);
+static inline uint16_t read_uint16(KronosVM *vm, uint8_t **ip,
+                                   const uint8_t *end) {
+  uint16_t high = read_byte(vm, ip, end);
+  uint16_t low = read_byte(vm, ip, end);
   return (high << 8) | low;
 }
 
 // Read constant from pool
-static KronosValue *read_constant(KronosVM *vm) {
-  uint16_t idx = read_uint16(vm);
+static inline KronosValue *read_constant(KronosVM *vm, uint8_t **ip,
+                                         const uint8_t *end) {
+  uint16_t idx = read_uint16(vm, ip, end);
   // Validate index is within bounds of constants array
   if (idx >= vm->bytecode->const_count) {
     vm_set_errorf(vm, KRONOS_ERR_RUNTIME,
@@ -574,2757 +1018,1714 @@ static KronosValue *read_constant(KronosVM *vm) {
   return vm->bytecode->constants[idx];
 }
 
-// Helper function to convert a value to a string representation
-// Returns a newly allocated string that the caller must free
-static char *value_to_string_repr(KronosValue *val) {
-  if (val->type == VAL_STRING) {
-    char *str = malloc(val->as.string.length + 1);
-    if (!str)
-      return NULL;
-    memcpy(str, val->as.string.data, val->as.string.length);
-    str[val->as.string.length] = '\0';
-    return str;
-  } else if (val->type == VAL_NUMBER) {
-    char *str_buf = malloc(64);
-    if (!str_buf)
-      return NULL;
+// Read constant from pool as a tagged value (EMPTY_VAL on a bad index)
+static inline Value read_constant_value(KronosVM *vm, uint8_t **ip,
+                                        const uint8_t *end) {
+  if (!read_constant(vm, ip, end))
+    return EMPTY_VAL;
+  if (!vm->links) {
+    vm_set_errorf(vm, KRONOS_ERR_INTERNAL, "Bytecode is not linked");
+    return EMPTY_VAL;
+  }
+  return vm->links->constants[(*ip)[-2] << 8 | (*ip)[-1]];
+}
+
+// String form of a value for concatenation. Strings are returned in place;
+// other values are formatted into buf, which must hold 64 bytes.
+static const char *value_string_form(Value val, char *buf, size_t *len) {
+  if (IS_STRING(val)) {
+    *len = AS_STRING_LEN(val);
+    return AS_CSTRING(val);
+  }
+  if (IS_INT(val)) {
+    int written = snprintf(buf, 64, "%" PRId64, AS_INT(val));
+    *len = written > 0 ? (size_t)written : 0;
+    return buf;
+  }
+  if (IS_NUMBER(val)) {
+    double number = AS_NUMBER(val);
     double intpart;
-    double frac = modf(val->as.number, &intpart);
-    size_t len;
-    // Use scientific notation for large numbers to prevent buffer overflow (buffer is 64 bytes)
-    
-    if (frac == 0.0 && fabs(val->as.number) < 1.0e15) {
-  
-      len = (size_t)snprintf(str_buf, 64, "%.0f", val->as.number);
+    double frac = modf(number, &intpart);
+    int written;
+    // Use scientific notation for large numbers to stay within the buffer
+    if (frac == 0.0 && fabs(number) < 1.0e15) {
+      written = snprintf(buf, 64, "%.0f", number);
     } else {
-      len = (size_t)snprintf(str_buf, 64, "%g", val->as.number);
+      written = snprintf(buf, 64, "%g", number);
     }
-    // Reallocate to exact size
-    char *result = realloc(str_buf, len + 1);
-    return result ? result : str_buf;
-  } else if (val->type == VAL_BOOL) {
-    return strdup(val->as.boolean ? "true" : "false");
-  } else if (val->type == VAL_NIL) {
-    return strdup("null");
+    *len = written > 0 ? (size_t)written : 0;
+    return buf;
+  }
+  const char *text = ""; // Unknown type
+  if (IS_BOOL(val)) {
+    text = AS_BOOL(val) ? "true" : "false";
+  } else if (IS_NIL(val)) {
+    text = "null";
   }
-  return strdup(""); // Unknown type
+  *len = strlen(text);
+  return text;
 }
 
-// Execute bytecode
-/**
- * @brief Execute bytecode on the virtual machine
- *
- * Main execution loop. Reads instructions from bytecode and executes them
- * using a stack-based model. Handles all instruction types including:
- * - Stack operations (push, pop)
- * - Variable operations (load, store)
- * - Arithmetic and comparison operations
- * - Control flow (jumps, conditionals)
- * - Function calls and returns
- * - Built-in function invocations
- *
- * @param vm VM instance to execute on
- * @param bytecode Compiled bytecode to execute
- * @return 0 on success, negative error code on failure
- */
-int vm_execute(KronosVM *vm, Bytecode *bytecode) {
-  if (!vm) {
-    return -(int)KRONOS_ERR_INVALID_ARGUMENT;
+// Built-in: read_file(path)
+static int builtin_read_file(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1)
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Expected 1 argument");
+  Value path_val = pop(vm);
+  if (IS_EMPTY(path_val))
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  if (!IS_STRING(path_val)) {
+    val_release(path_val);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Path must be a string");
   }
-  if (!bytecode) {
-    return vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
-                    "vm_execute: bytecode must not be NULL");
+  FILE *file = fopen(AS_CSTRING(path_val), "rb");
+  if (!file) {
+    val_release(path_val);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Could not open file");
   }
+  fseek(file, 0L, SEEK_END);
+  long fsize = ftell(file);
+  if (fsize < 0) {
+    fclose(file);
+    val_release(path_val);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Failed to get file size");
+  }
+  rewind(file);
+  if ((unsigned long)fsize > SIZE_MAX - 1) {
+    fclose(file);
+    val_release(path_val);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "File too large");
+  }
+  char *buff = mem_alloc(fsize + 1);
+  if (!buff) {
+    fclose(file);
+    val_release(path_val);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  size_t bytes_read = fread(buff, 1, fsize, file);
+  if (bytes_read != (size_t)fsize) {
+    mem_free(buff);
+    fclose(file);
+    val_release(path_val);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Failed to read file");
+  }
+  buff[bytes_read] = '\0';
+  fclose(file);
+  KronosValue *res = value_new_string(buff, bytes_read);
+  mem_free(buff);
+  push_object(vm, res);
+  val_release(path_val);
+  return 0;
+}
 
-  vm->bytecode = bytecode;
-  vm->ip = bytecode->code;
-
-  while (1) {
-    uint8_t instruction = read_byte(vm);
-
-    switch (instruction) {
-    case OP_LOAD_CONST: {
-      KronosValue *constant = read_constant(vm);
-      if (!constant) {
-        return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-      }
-      push(vm, constant);
-      break;
-    }
+// Built-in: add(a, b)
+static int builtin_add(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'add' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value b = pop(vm);
+  if (IS_EMPTY(b)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value a = pop(vm);
+  if (IS_EMPTY(a)) {
+    val_release(b);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_NUMBER(a) && IS_NUMBER(b)) {
+    push(vm, val_number_add(a, b));
+  } else {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'add' requires both arguments to be numbers");
+    val_release(a);
+    val_release(b);
+    return err;
+  }
+  val_release(a);
+  val_release(b);
+  return 0;
+}
 
-    case OP_LOAD_VAR: {
-      KronosValue *name_val = read_constant(vm);
-      if (!name_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-      }
-      if (name_val->type != VAL_STRING) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Variable name constant is not a string");
-      }
-      KronosValue *value = vm_get_variable(vm, name_val->as.string.data);
-      if (!value) {
-        // Debug: check what error was set
-        if (vm->last_error_code == KRONOS_ERR_NOT_FOUND) {
-          fprintf(stderr, "DEBUG: OP_LOAD_VAR failed to find variable '%s'\n",
-                  name_val->as.string.data);
-        }
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      push(vm, value);
-      break;
+// Built-in: subtract(a, b)
+static int builtin_subtract(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'subtract' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value b = pop(vm);
+  if (IS_EMPTY(b)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value a = pop(vm);
+  if (IS_EMPTY(a)) {
+    val_release(b);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_NUMBER(a) && IS_NUMBER(b)) {
+    push(vm, val_number_sub(a, b));
+  } else {
+    int err = vm_errorf(
+        vm, KRONOS_ERR_RUNTIME,
+        "Function 'subtract' requires both arguments to be numbers");
+    val_release(a);
+    val_release(b);
+    return err;
+  }
+  val_release(a);
+  val_release(b);
+  return 0;
+}
+
+// Built-in: multiply(a, b)
+static int builtin_multiply(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'multiply' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value b = pop(vm);
+  if (IS_EMPTY(b)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value a = pop(vm);
+  if (IS_EMPTY(a)) {
+    val_release(b);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_NUMBER(a) && IS_NUMBER(b)) {
+    push(vm, val_number_mul(a, b));
+  } else {
+    int err = vm_errorf(
+        vm, KRONOS_ERR_RUNTIME,
+        "Function 'multiply' requires both arguments to be numbers");
+    val_release(a);
+    val_release(b);
+    return err;
+  }
+  val_release(a);
+  val_release(b);
+  return 0;
+}
+
+// Built-in: divide(a, b)
+static int builtin_divide(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'divide' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value b = pop(vm);
+  if (IS_EMPTY(b)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value a = pop(vm);
+  if (IS_EMPTY(a)) {
+    val_release(b);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_NUMBER(a) && IS_NUMBER(b)) {
+    if (AS_NUMBER(b) == 0) {
+      int err = vm_error(vm, KRONOS_ERR_RUNTIME,
+                         "Function 'divide' cannot divide by zero");
+      val_release(a);
+      val_release(b);
+      return err;
+    } else {
+      push(vm, NUMBER_VAL(AS_NUMBER(a) / AS_NUMBER(b)));
     }
+  } else {
+    int err = vm_errorf(
+        vm, KRONOS_ERR_RUNTIME,
+        "Function 'divide' requires both arguments to be numbers");
+    val_release(a);
+    val_release(b);
+    return err;
+  }
+  val_release(a);
+  val_release(b);
+  return 0;
+}
 
-    case OP_STORE_VAR: {
-      KronosValue *name_val = read_constant(vm);
-      if (!name_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-      }
-      if (name_val->type != VAL_STRING) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Variable name constant is not a string");
-      }
-      KronosValue *value = pop(vm);
-      if (!value) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in: len(list/string)
+static int builtin_len(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'len' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_LIST(arg)) {
+    push(vm, value_from_int((int64_t)AS_LIST(arg)->count));
+  } else if (IS_STRING(arg)) {
+    push(vm, value_from_int((int64_t)AS_STRING_LEN(arg)));
+  } else {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'len' requires a list or string argument");
+    val_release(arg);
+    return err;
+  }
+  val_release(arg);
+  return 0;
+}
 
-      // Read mutability flag
-      uint8_t is_mutable_byte = read_byte(vm);
-      bool is_mutable = (is_mutable_byte == 1);
-
-      // Read type name (if specified)
-      uint8_t has_type = read_byte(vm);
-      const char *type_name = NULL;
-      if (has_type) {
-        KronosValue *type_val = read_constant(vm);
-        if (!type_val) {
-          value_release(value);
-          return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-        }
-        if (type_val->type != VAL_STRING) {
-          value_release(value);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Type name constant is not a string");
-        }
-        type_name = type_val->as.string.data;
-      }
+// Built-in: uppercase(string)
+static int builtin_uppercase(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'uppercase' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(arg)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'uppercase' requires a string argument");
+    val_release(arg);
+    return err;
+  }
 
-      // If in function, set as local variable; otherwise, set as global
-      int store_status;
-      if (vm->current_frame) {
-        store_status =
-            vm_set_local(vm, vm->current_frame, name_val->as.string.data, value,
-                         is_mutable, type_name);
-      } else {
-        store_status = vm_set_global(vm, name_val->as.string.data, value,
-                                     is_mutable, type_name);
-      }
+  char *upper = mem_alloc(AS_STRING_LEN(arg) + 1);
+  if (!upper) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  for (size_t i = 0; i < AS_STRING_LEN(arg); i++) {
+    upper[i] = (char)toupper((unsigned char)AS_CSTRING(arg)[i]);
+  }
+  upper[AS_STRING_LEN(arg)] = '\0';
 
-      value_release(value); // Release our reference
-      if (store_status != 0) {
-        return store_status;
-      }
-      break;
-    }
+  KronosValue *result = value_new_string(upper, AS_STRING_LEN(arg));
+  mem_free(upper);
+  if (!result) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(arg);
+  return 0;
+}
 
-    case OP_PRINT: {
-      KronosValue *value = pop(vm);
-      if (!value) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      value_fprint(stdout, value);
-      printf("\n");
-      value_release(value);
-      break;
-    }
+// Built-in: lowercase(string)
+static int builtin_lowercase(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'lowercase' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(arg)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'lowercase' requires a string argument");
+    val_release(arg);
+    return err;
+  }
 
-    case OP_ADD: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+  char *lower = mem_alloc(AS_STRING_LEN(arg) + 1);
+  if (!lower) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  for (size_t i = 0; i < AS_STRING_LEN(arg); i++) {
+    lower[i] = (char)tolower((unsigned char)AS_CSTRING(arg)[i]);
+  }
+  lower[AS_STRING_LEN(arg)] = '\0';
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        // Numeric addition
-        KronosValue *result = value_new_number(a->as.number + b->as.number);
-        push(vm, result);
-        value_release(result); // Push retains it
-      } else {
-        // String concatenation (handles string+string, number+string,
-        // string+number) Order matters: left operand first, then right operand
-        char *str_a = value_to_string_repr(a);
-        char *str_b = value_to_string_repr(b);
-
-        if (!str_a || !str_b) {
-          free(str_a);
-          free(str_b);
-          value_release(a);
-          value_release(b);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to allocate memory for string conversion");
-        }
+  KronosValue *result = value_new_string(lower, AS_STRING_LEN(arg));
+  mem_free(lower);
+  if (!result) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(arg);
+  return 0;
+}
 
-        size_t len_a = strlen(str_a);
-        size_t len_b = strlen(str_b);
-        size_t total_len = len_a + len_b;
-
-        char *concat = malloc(total_len + 1);
-        if (!concat) {
-          free(str_a);
-          free(str_b);
-          value_release(a);
-          value_release(b);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to allocate memory for string concatenation");
-        }
+// Built-in: trim(string)
+static int builtin_trim(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'trim' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'trim' requires a string argument");
+    val_release(arg);
+    return err;
+  }
 
-        // Concatenate in order: left operand first, then right operand
-        memcpy(concat, str_a, len_a);
-        memcpy(concat + len_a, str_b, len_b);
-        concat[total_len] = '\0';
-
-        KronosValue *result = value_new_string(concat, total_len);
-        free(concat);
-        free(str_a);
-        free(str_b);
-
-        if (!result) {
-          value_release(a);
-          value_release(b);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
+  // Find start (skip leading whitespace)
+  size_t start = 0;
+  while (start < AS_STRING_LEN(arg) &&
+         isspace((unsigned char)AS_CSTRING(arg)[start])) {
+    start++;
+  }
 
-        push(vm, result);
-        value_release(result);
-      }
+  // Find end (skip trailing whitespace)
+  size_t end = AS_STRING_LEN(arg);
+  while (end > start &&
+         isspace((unsigned char)AS_CSTRING(arg)[end - 1])) {
+    end--;
+  }
 
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  size_t trimmed_len = end - start;
+  char *trimmed = mem_alloc(trimmed_len + 1);
+  if (!trimmed) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  memcpy(trimmed, AS_CSTRING(arg) + start, trimmed_len);
+  trimmed[trimmed_len] = '\0';
 
-    case OP_SUB: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+  KronosValue *result = value_new_string(trimmed, trimmed_len);
+  mem_free(trimmed);
+  if (!result) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(arg);
+  return 0;
+}
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        KronosValue *result = value_new_number(a->as.number - b->as.number);
-        push(vm, result);
-        value_release(result);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot subtract - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
-      }
+// Built-in: split(string, delimiter)
+static int builtin_split(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'split' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value delim = pop(vm);
+  if (IS_EMPTY(delim)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value str = pop(vm);
+  if (IS_EMPTY(str)) {
+    val_release(delim);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(str) || !IS_STRING(delim)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'split' requires two string arguments");
+    val_release(str);
+    val_release(delim);
+    return err;
+  }
 
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  // Create result list
+  KronosValue *result = value_new_list(4);
+  if (!result) {
+    val_release(str);
+    val_release(delim);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
+  }
 
-    case OP_MUL: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  // Split string by delimiter
+  const char *str_data = AS_CSTRING(str);
+  const char *delim_data = AS_CSTRING(delim);
+  size_t str_len = AS_STRING_LEN(str);
+  size_t delim_len = AS_STRING_LEN(delim);
+
+  if (delim_len == 0) {
+    // Empty delimiter: split into individual characters
+    for (size_t i = 0; i < str_len; i++) {
+      // Single-character strings are shared immortal instances
+      KronosValue *ch_val = value_new_char((uint8_t)str_data[i]);
+      if (!value_list_append(result, OBJ_VAL(ch_val))) {
+        value_release(result);
+        val_release(str);
+        val_release(delim);
+        return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
       }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+    }
+  } else {
+    // Split by delimiter
+    size_t start = 0;
+    while (start < str_len) {
+      // Find next delimiter
+      size_t pos = start;
+      bool found = false;
+      while (pos + delim_len <= str_len) {
+        if (memcmp(str_data + pos, delim_data, delim_len) == 0) {
+          found = true;
+          break;
+        }
+        pos++;
       }
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        KronosValue *result = value_new_number(a->as.number * b->as.number);
-        push(vm, result);
+      size_t end = found ? pos : str_len;
+      size_t part_len = end - start;
+
+      // Create substring
+      char *part = mem_alloc(part_len + 1);
+      if (!part) {
         value_release(result);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot multiply - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
+        val_release(str);
+        val_release(delim);
+        return vm_error(vm, KRONOS_ERR_INTERNAL,
+                        "Failed to allocate memory");
       }
+      memcpy(part, str_data + start, part_len);
+      part[part_len] = '\0';
 
-      value_release(a);
-      value_release(b);
-      break;
-    }
-
-    case OP_DIV: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+      KronosValue *part_val = value_new_string(part, part_len);
+      mem_free(part);
+      if (!part_val) {
+        value_release(result);
+        val_release(str);
+        val_release(delim);
+        return vm_error(vm, KRONOS_ERR_INTERNAL,
+                        "Failed to create string value");
       }
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        if (b->as.number == 0) {
-          int err = vm_error(vm, KRONOS_ERR_RUNTIME, "Cannot divide by zero");
-          value_release(a);
-          value_release(b);
-          return err;
-        }
-        KronosValue *result = value_new_number(a->as.number / b->as.number);
-        push(vm, result);
+      // Append (the list takes its own reference)
+      bool appended = value_list_append(result, OBJ_VAL(part_val));
+      value_release(part_val);
+      if (!appended) {
         value_release(result);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot divide - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
+        val_release(str);
+        val_release(delim);
+        return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
       }
 
-      value_release(a);
-      value_release(b);
-      break;
+      start = found ? pos + delim_len : str_len;
     }
+  }
 
-    case OP_EQ: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      bool result = value_equals(a, b);
-      KronosValue *res = value_new_bool(result);
-      push(vm, res);
-      value_release(res);
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  push_object(vm, result);
+  val_release(str);
+  val_release(delim);
+  return 0;
+}
 
-    case OP_NEQ: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      bool result = !value_equals(a, b);
-      KronosValue *res = value_new_bool(result);
-      push(vm, res);
-      value_release(res);
-      value_release(a);
-      value_release(b);
-      break;
-    }
+// Built-in: join(list, delimiter)
+static int builtin_join(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'join' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value delim = pop(vm);
+  if (IS_EMPTY(delim)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value list = pop(vm);
+  if (IS_EMPTY(list)) {
+    val_release(delim);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_LIST(list) || !IS_STRING(delim)) {
+    int err = vm_errorf(
+        vm, KRONOS_ERR_RUNTIME,
+        "Function 'join' requires a list and a string delimiter");
+    val_release(list);
+    val_release(delim);
+    return err;
+  }
 
-    case OP_GT: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+  // Calculate total length
+  size_t total_len = 0;
+  for (size_t i = 0; i < AS_LIST(list)->count; i++) {
+    Value item = AS_LIST(list)->items[i];
+    if (!IS_STRING(item)) {
+      val_release(list);
+      val_release(delim);
+      return vm_error(vm, KRONOS_ERR_RUNTIME,
+                      "All list items must be strings for join");
+    }
+    total_len += AS_STRING_LEN(item);
+    if (i > 0) {
+      total_len += AS_STRING_LEN(delim);
+    }
+  }
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        bool result = a->as.number > b->as.number;
-        KronosValue *res = value_new_bool(result);
-        push(vm, res);
-        value_release(res);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot perform '>' - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
-      }
+  // Build joined string
+  char *joined = mem_alloc(total_len + 1);
+  if (!joined) {
+    val_release(list);
+    val_release(delim);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
 
-      value_release(a);
-      value_release(b);
-      break;
+  size_t offset = 0;
+  for (size_t i = 0; i < AS_LIST(list)->count; i++) {
+    if (i > 0) {
+      memcpy(joined + offset, AS_CSTRING(delim),
+             AS_STRING_LEN(delim));
+      offset += AS_STRING_LEN(delim);
     }
+    Value item = AS_LIST(list)->items[i];
+    memcpy(joined + offset, AS_CSTRING(item), AS_STRING_LEN(item));
+    offset += AS_STRING_LEN(item);
+  }
+  joined[total_len] = '\0';
 
-    case OP_LT: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+  KronosValue *result = value_new_string(joined, total_len);
+  mem_free(joined);
+  if (!result) {
+    val_release(list);
+    val_release(delim);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(list);
+  val_release(delim);
+  return 0;
+}
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        bool result = a->as.number < b->as.number;
-        KronosValue *res = value_new_bool(result);
-        push(vm, res);
-        value_release(res);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot perform '<' - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
-      }
+// Built-in: to_string(value)
+static int builtin_to_string(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'to_string' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
 
-      value_release(a);
-      value_release(b);
-      break;
+  char *str_buf = NULL;
+  size_t str_len = 0;
+
+  if (IS_STRING(arg)) {
+    // Already a string, just return it
+    val_retain(arg);
+    push(vm, arg);
+    val_release(arg);
+    return 0;
+  } else if (IS_NUMBER(arg)) {
+    // Convert number to string
+    // Use a reasonable buffer size
+    str_buf = mem_alloc(64);
+    if (!str_buf) {
+      val_release(arg);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate memory");
     }
 
-    case OP_GTE: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        bool result = a->as.number >= b->as.number;
-        KronosValue *res = value_new_bool(result);
-        push(vm, res);
-        value_release(res);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot perform '>=' - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
-      }
-
-      value_release(a);
-      value_release(b);
-      break;
+    // Check if it's a whole number
+    double intpart;
+    double frac = modf(AS_NUMBER(arg), &intpart);
+  
+    if (frac == 0.0 && fabs(AS_NUMBER(arg)) < 1.0e15) {
+      str_len = (size_t)snprintf(str_buf, 64, "%.0f", AS_NUMBER(arg));
+    } else {
+      str_len = (size_t)snprintf(str_buf, 64, "%g", AS_NUMBER(arg));
+    }
+  } else if (IS_BOOL(arg)) {
+    if (AS_BOOL(arg)) {
+      str_buf = mem_strdup("true");
+      str_len = 4;
+    } else {
+      str_buf = mem_strdup("false");
+      str_len = 5;
+    }
+    if (!str_buf) {
+      val_release(arg);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate memory");
+    }
+  } else if (IS_NIL(arg)) {
+    str_buf = mem_strdup("null");
+    str_len = 4;
+    if (!str_buf) {
+      val_release(arg);
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to allocate memory");
     }
+  } else {
+    val_release(arg);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Cannot convert type to string");
+  }
 
-    case OP_LTE: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+  KronosValue *result = value_new_string(str_buf, str_len);
+  mem_free(str_buf); // Always free our buffer (value_new_string copies it)
+  if (!result) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(arg);
+  return 0;
+}
 
-      if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-        bool result = a->as.number <= b->as.number;
-        KronosValue *res = value_new_bool(result);
-        push(vm, res);
-        value_release(res);
-      } else {
-        int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot perform '<=' - both values must be numbers");
-        value_release(a);
-        value_release(b);
-        return err;
-      }
+// Built-in: contains(string, substring)
+static int builtin_contains(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'contains' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value substring = pop(vm);
+  if (IS_EMPTY(substring)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value str = pop(vm);
+  if (IS_EMPTY(str)) {
+    val_release(substring);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(str) || !IS_STRING(substring)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'contains' requires two string arguments");
+    val_release(str);
+    val_release(substring);
+    return err;
+  }
 
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  // Use strstr to check if substring exists
+  bool found =
+      (strstr(AS_CSTRING(str), AS_CSTRING(substring)) != NULL);
+  push(vm, BOOL_VAL(found));
+  val_release(str);
+  val_release(substring);
+  return 0;
+}
 
-    case OP_AND: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in: starts_with(string, prefix)
+static int builtin_starts_with(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'starts_with' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value prefix = pop(vm);
+  if (IS_EMPTY(prefix)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value str = pop(vm);
+  if (IS_EMPTY(str)) {
+    val_release(prefix);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(str) || !IS_STRING(prefix)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'starts_with' requires two string arguments");
+    val_release(str);
+    val_release(prefix);
+    return err;
+  }
 
-      // Both operands must be truthy for AND to be true
-      bool a_truthy = value_is_truthy(a);
-      bool b_truthy = value_is_truthy(b);
-      bool result = a_truthy && b_truthy;
-      KronosValue *res = value_new_bool(result);
-      push(vm, res);
-      value_release(res);
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  bool starts = false;
+  if (AS_STRING_LEN(prefix) <= AS_STRING_LEN(str)) {
+    starts = (memcmp(AS_CSTRING(str), AS_CSTRING(prefix),
+                     AS_STRING_LEN(prefix)) == 0);
+  }
+  push(vm, BOOL_VAL(starts));
+  val_release(str);
+  val_release(prefix);
+  return 0;
+}
 
-    case OP_OR: {
-      KronosValue *b = pop(vm);
-      if (!b) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *a = pop(vm);
-      if (!a) {
-        value_release(b);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in: ends_with(string, suffix)
+static int builtin_ends_with(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'ends_with' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value suffix = pop(vm);
+  if (IS_EMPTY(suffix)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value str = pop(vm);
+  if (IS_EMPTY(str)) {
+    val_release(suffix);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(str) || !IS_STRING(suffix)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'ends_with' requires two string arguments");
+    val_release(str);
+    val_release(suffix);
+    return err;
+  }
 
-      // At least one operand must be truthy for OR to be true
-      bool a_truthy = value_is_truthy(a);
-      bool b_truthy = value_is_truthy(b);
-      bool result = a_truthy || b_truthy;
-      KronosValue *res = value_new_bool(result);
-      push(vm, res);
-      value_release(res);
-      value_release(a);
-      value_release(b);
-      break;
-    }
+  bool ends = false;
+  if (AS_STRING_LEN(suffix) <= AS_STRING_LEN(str)) {
+    size_t start_pos = AS_STRING_LEN(str) - AS_STRING_LEN(suffix);
+    ends =
+        (memcmp(AS_CSTRING(str) + start_pos, AS_CSTRING(suffix),
+                AS_STRING_LEN(suffix)) == 0);
+  }
+  push(vm, BOOL_VAL(ends));
+  val_release(str);
+  val_release(suffix);
+  return 0;
+}
 
-    case OP_NOT: {
-      KronosValue *a = pop(vm);
-      if (!a) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in: replace(string, old, new)
+static int builtin_replace(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 3) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'replace' expects 3 arguments, got %d",
+                     arg_count);
+  }
+  Value new_str = pop(vm);
+  if (IS_EMPTY(new_str)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value old_str = pop(vm);
+  if (IS_EMPTY(old_str)) {
+    val_release(new_str);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value str = pop(vm);
+  if (IS_EMPTY(str)) {
+    val_release(old_str);
+    val_release(new_str);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_STRING(str) || !IS_STRING(old_str) ||
+      !IS_STRING(new_str)) {
+    int err =
+        vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                  "Function 'replace' requires three string arguments");
+    val_release(str);
+    val_release(old_str);
+    val_release(new_str);
+    return err;
+  }
 
-      // NOT returns the opposite of the truthiness
-      bool a_truthy = value_is_truthy(a);
-      bool result = !a_truthy;
-      KronosValue *res = value_new_bool(result);
-      push(vm, res);
-      value_release(res);
-      value_release(a);
-      break;
-    }
+  // Handle empty old string (return original string)
+  if (AS_STRING_LEN(old_str) == 0) {
+    val_retain(str);
+    push(vm, str);
+    val_release(str);
+    val_release(old_str);
+    val_release(new_str);
+    return 0;
+  }
 
-    case OP_JUMP: {
-      int8_t offset = (int8_t)read_byte(vm);
-      uint8_t *new_ip = vm->ip + offset;
-      // Bounds check: ensure jump target is within valid bytecode range
-      if (new_ip < vm->bytecode->code ||
-          new_ip >= vm->bytecode->code + vm->bytecode->count) {
-        return vm_errorf(
-            vm, KRONOS_ERR_RUNTIME,
-            "Jump target out of bounds (offset: %d, bytecode size: %zu)",
-            offset, vm->bytecode->count);
+  // Calculate maximum possible result size
+  // old_len == 0 is already handled above, so we know old_len > 0 here
+  size_t str_len = AS_STRING_LEN(str);
+  size_t old_len = AS_STRING_LEN(old_str);
+  size_t new_len = AS_STRING_LEN(new_str);
+  size_t max_result_len = str_len;
+
+  if (new_len > old_len) {
+    // Worst case: maximum non-overlapping occurrences
+    // Maximum occurrences is at most str_len / old_len
+    // Each occurrence adds (new_len - old_len) characters
+    // Safe upper bound: str_len + (str_len / old_len + 1) * (new_len -
+    // old_len) But we need to check for overflow
+    size_t max_occurrences = str_len / old_len;
+    size_t growth_per_occurrence = new_len - old_len;
+
+    // Check for overflow: max_occurrences * growth_per_occurrence
+    if (max_occurrences > 0 &&
+        growth_per_occurrence > SIZE_MAX / max_occurrences) {
+      // Overflow would occur, use a conservative upper bound
+      max_result_len = SIZE_MAX;
+    } else {
+      size_t total_growth = max_occurrences * growth_per_occurrence;
+      // Check if str_len + total_growth would overflow
+      if (total_growth > SIZE_MAX - str_len) {
+        max_result_len = SIZE_MAX;
+      } else {
+        max_result_len = str_len + total_growth;
       }
-      vm->ip = new_ip;
-      break;
     }
+  }
 
-    case OP_JUMP_IF_FALSE: {
-      uint8_t offset = read_byte(vm);
-      KronosValue *condition = peek(vm, 0);
-      if (!value_is_truthy(condition)) {
-        uint8_t *new_ip = vm->ip + offset;
-        // Bounds check: ensure jump target is within valid bytecode range
-        if (new_ip < vm->bytecode->code ||
-            new_ip >= vm->bytecode->code + vm->bytecode->count) {
-          // Pop condition before returning error
-          KronosValue *condition_val = pop(vm);
-          if (condition_val) {
-            value_release(condition_val);
-          }
-          return vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Jump target out of bounds (offset: %u, bytecode size: %zu)",
-              offset, vm->bytecode->count);
-        }
-        vm->ip = new_ip;
-      }
-      KronosValue *condition_val = pop(vm);
-      if (!condition_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      value_release(condition_val); // Pop condition
+  // Check for overflow before malloc (max_result_len + 1)
+  if (max_result_len == SIZE_MAX || max_result_len + 1 < max_result_len) {
+    val_release(str);
+    val_release(old_str);
+    val_release(new_str);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Result string too large");
+  }
+
+  char *result_buf = mem_alloc(max_result_len + 1);
+  if (!result_buf) {
+    val_release(str);
+    val_release(old_str);
+    val_release(new_str);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+
+  size_t result_len = 0;
+  const char *search_start = AS_CSTRING(str);
+  const char *search_end = AS_CSTRING(str) + AS_STRING_LEN(str);
+
+  while (search_start < search_end) {
+    const char *found = strstr(search_start, AS_CSTRING(old_str));
+    if (!found || found >= search_end) {
+      // No more occurrences, copy rest of string
+      size_t remaining = search_end - search_start;
+      memcpy(result_buf + result_len, search_start, remaining);
+      result_len += remaining;
       break;
     }
 
-    case OP_DEFINE_FUNC: {
-      // Read function name
-      KronosValue *name_val = read_constant(vm);
-      if (!name_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-      }
-      if (name_val->type != VAL_STRING) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Function name constant is not a string");
-      }
-      uint8_t param_count = read_byte(vm);
+    // Copy part before match
+    size_t before_len = found - search_start;
+    memcpy(result_buf + result_len, search_start, before_len);
+    result_len += before_len;
 
-      // Create function
-      Function *func = malloc(sizeof(Function));
-      if (!func) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to allocate function structure");
-      }
+    // Copy replacement
+    memcpy(result_buf + result_len, AS_CSTRING(new_str),
+           AS_STRING_LEN(new_str));
+    result_len += AS_STRING_LEN(new_str);
 
-      // Allocate function name - check for NULL immediately after strdup
-      func->name = strdup(name_val->as.string.data);
-      if (!func->name) {
-        // Allocation failure: free func and return error
-        free(func);
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to copy function name");
-      }
-
-      func->param_count = param_count;
-      func->params =
-          param_count > 0 ? malloc(sizeof(char *) * param_count) : NULL;
-      if (param_count > 0 && !func->params) {
-        // Allocation failure: free func->name and func, then return error
-        free(func->name);
-        free(func);
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to allocate parameter array");
-      }
-
-      // Read parameter names
-      int param_error = 0;
-      size_t filled_params = 0;
-      for (size_t i = 0; i < param_count; i++) {
-        KronosValue *param_val = read_constant(vm);
-        if (!param_val) {
-          param_error = vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-          break;
-        }
-        if (param_val->type != VAL_STRING) {
-          param_error = vm_error(vm, KRONOS_ERR_INTERNAL,
-                                 "Parameter name constant is not a string");
-          break;
-        }
-
-        // Check if parameter name is a reserved constant
-        // Note: This check happens before strdup, so no cleanup needed here
-        if (strcmp(param_val->as.string.data, "Pi") == 0) {
-          param_error =
-              vm_error(vm, KRONOS_ERR_RUNTIME,
-                       "Cannot use 'Pi' as a parameter name (reserved)");
-          break;
-        }
-
-        // Allocate parameter name - check for NULL immediately after strdup
-        func->params[i] = strdup(param_val->as.string.data);
-        if (!func->params[i]) {
-          // Allocation failure: set error and break (cleanup happens below)
-          param_error = vm_error(vm, KRONOS_ERR_INTERNAL,
-                                 "Failed to copy parameter name");
-          break;
-        }
-        // Only increment filled_params after successful allocation
-        filled_params++;
-      }
-
-      // Cleanup on any error: free all allocated resources
-      if (param_error != 0) {
-        // Free all successfully allocated parameter names (0..filled_params-1)
-        for (size_t j = 0; j < filled_params; j++) {
-          free(func->params[j]);
-        }
-        // Free parameter array if allocated
-        free(func->params);
-        // Free function name
-        free(func->name);
-        // Free function structure
-        free(func);
-        return param_error;
-      }
-
-      // Consume function body start position (2 bytes) - part of bytecode
-      // format but not used at runtime; we just need to advance the instruction
-      // pointer Format:
-      // [OP_DEFINE_FUNC][name_idx:2][param_count:1][params:2*N][body_start:2][OP_JUMP][skip_offset:1]
-      read_byte(vm); // body_start high byte
-      read_byte(vm); // body_start low byte
-
-      // Consume OP_JUMP instruction byte (part of bytecode format)
-      read_byte(vm);
-
-      // Read jump offset to skip function body
-      uint8_t skip_offset = read_byte(vm);
-
-      // Calculate body end (before the jump we just read)
-      uint8_t *body_end_ptr = vm->ip + skip_offset;
-
-      // Validate that body_end_ptr is within valid bytecode bounds
-      if (body_end_ptr < vm->bytecode->code ||
-          body_end_ptr > vm->bytecode->code + vm->bytecode->count) {
-        function_free(func);
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Function body extends beyond bytecode bounds "
-                         "(offset: %u, bytecode size: %zu)",
-                         skip_offset, vm->bytecode->count);
-      }
-
-      // Copy function body bytecode
-      // Validate that body_end_ptr >= vm->ip to prevent wrap-around
-      if (body_end_ptr < vm->ip) {
-        function_free(func);
-        return vm_errorf(
-            vm, KRONOS_ERR_RUNTIME,
-            "Invalid function body: backward jump detected (offset: %u)",
-            skip_offset);
-      }
-
-      size_t bytecode_size = body_end_ptr - vm->ip;
-      func->bytecode.code = malloc(bytecode_size);
-      if (!func->bytecode.code) {
-        // Allocation failure: clean up func (name, params, etc.) and return
-        // error
-        function_free(func);
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to allocate memory for function bytecode");
-      }
-      func->bytecode.count = bytecode_size;
-      func->bytecode.capacity = bytecode_size;
-      memcpy(func->bytecode.code, vm->ip, bytecode_size);
-
-      // Copy constants (retain references)
-      func->bytecode.const_count = vm->bytecode->const_count;
-      func->bytecode.const_capacity = vm->bytecode->const_count;
-      func->bytecode.constants =
-          malloc(sizeof(KronosValue *) * func->bytecode.const_count);
-      if (!func->bytecode.constants) {
-        // Allocation failure: free func->bytecode.code, then clean up func and
-        // return error
-        free(func->bytecode.code);
-        func->bytecode.code = NULL;
-        func->bytecode.count = 0;
-        func->bytecode.capacity = 0;
-        function_free(func);
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to allocate memory for function constants");
-      }
-      for (size_t i = 0; i < func->bytecode.const_count; i++) {
-        func->bytecode.constants[i] = vm->bytecode->constants[i];
-        value_retain(func->bytecode.constants[i]);
-      }
-
-      // Store function
-      int define_status = vm_define_function(vm, func);
-      if (define_status != 0) {
-        function_free(func);
-        return define_status;
-      }
-
-      // Skip over function body
-      vm->ip = body_end_ptr;
-      break;
-    }
-
-    case OP_CALL_FUNC: {
-      KronosValue *name_val = read_constant(vm);
-      if (!name_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_INTERNAL);
-      }
-      if (name_val->type != VAL_STRING) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Function name constant is not a string");
-      }
-      uint8_t arg_count = read_byte(vm);
-
-      // Check for built-in functions first
-      const char *func_name = name_val->as.string.data;
-
-      
-      // Built-in: read_file(path)       // Built-in: read_file(path)
-       if (strcmp(func_name, "read_file") == 0) {
-         if (arg_count != 1) return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Expected 1 argument");
-         KronosValue *path_val = pop(vm);
-         if (!path_val) return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-         if (path_val->type != VAL_STRING) {
-           value_release(path_val);
-           return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Path must be a string");
-         }
-         FILE *file = fopen(path_val->as.string.data, "rb");
-         if (!file) {
-           value_release(path_val);
-           return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Could not open file");
-         }
-         fseek(file, 0L, SEEK_END);
-         long fsize = ftell(file);
-        if (fsize < 0) {
-          fclose(file);
-          value_release(path_val);
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Failed to get file size");
-        }
-         rewind(file);
-        if (fsize > SIZE_MAX - 1) {
-          fclose(file);
-          value_release(path_val);
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME, "File too large");
-        }
-         char *buff = malloc(fsize + 1);
-        if (!buff) {
-          fclose(file);
-          value_release(path_val);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        size_t bytes_read = fread(buff, 1, fsize, file);
-        if (bytes_read != (size_t)fsize) {
-          free(buff);
-          fclose(file);
-          value_release(path_val);
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME, "Failed to read file");
-        }
-        buff[bytes_read] = '\0';
-         fclose(file);
-        KronosValue *res = value_new_string(buff, bytes_read);
-         free(buff);
-         push(vm, res);
-         value_release(res);
-         value_release(path_val);
-         break;
-       }
-
-      // Check for module.function syntax (e.g., math.sqrt)
-      const char *dot = strchr(func_name, '.');
-      if (dot) {
-        // Split module and function name
-        size_t module_len = (size_t)(dot - func_name);
-        char *module_name = malloc(module_len + 1);
-        if (!module_name) {
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        strncpy(module_name, func_name, module_len);
-        module_name[module_len] = '\0';
-
-        const char *actual_func_name = dot + 1;
-
-        // Map module functions to built-in functions
-        // math module: sqrt, power, abs, round, floor, ceil, rand, min, max
-        // Note: String functions are global built-ins (no string module)
-        if (strcmp(module_name, "math") == 0) {
-          // Math functions are already implemented as built-ins
-          // Just route to the built-in function by name
-          free(module_name);
-          // Continue to built-in function checks below with actual_func_name
-          func_name = actual_func_name;
-        } else {
-          int err = vm_errorf(vm, KRONOS_ERR_NOT_FOUND, "Unknown module '%s'",
-                              module_name);
-          free(module_name);
-          return err;
-        }
-      }
-
-      // Built-in: add(a, b)
-      if (strcmp(func_name, "add") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'add' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *b = pop(vm);
-        if (!b) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *a = pop(vm);
-        if (!a) {
-          value_release(b);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-          KronosValue *result = value_new_number(a->as.number + b->as.number);
-          push(vm, result);
-          value_release(result);
-        } else {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'add' requires both arguments to be numbers");
-          value_release(a);
-          value_release(b);
-          return err;
-        }
-        value_release(a);
-        value_release(b);
-        break;
-      }
-
-      // Built-in: subtract(a, b)
-      if (strcmp(func_name, "subtract") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'subtract' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *b = pop(vm);
-        if (!b) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *a = pop(vm);
-        if (!a) {
-          value_release(b);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-          KronosValue *result = value_new_number(a->as.number - b->as.number);
-          push(vm, result);
-          value_release(result);
-        } else {
-          int err = vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Function 'subtract' requires both arguments to be numbers");
-          value_release(a);
-          value_release(b);
-          return err;
-        }
-        value_release(a);
-        value_release(b);
-        break;
-      }
-
-      // Built-in: multiply(a, b)
-      if (strcmp(func_name, "multiply") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'multiply' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *b = pop(vm);
-        if (!b) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *a = pop(vm);
-        if (!a) {
-          value_release(b);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-          KronosValue *result = value_new_number(a->as.number * b->as.number);
-          push(vm, result);
-          value_release(result);
-        } else {
-          int err = vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Function 'multiply' requires both arguments to be numbers");
-          value_release(a);
-          value_release(b);
-          return err;
-        }
-        value_release(a);
-        value_release(b);
-        break;
-      }
-
-      // Built-in: divide(a, b)
-      if (strcmp(func_name, "divide") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'divide' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *b = pop(vm);
-        if (!b) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *a = pop(vm);
-        if (!a) {
-          value_release(b);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-          if (b->as.number == 0) {
-            int err = vm_error(vm, KRONOS_ERR_RUNTIME,
-                               "Function 'divide' cannot divide by zero");
-            value_release(a);
-            value_release(b);
-            return err;
-          } else {
-            KronosValue *result = value_new_number(a->as.number / b->as.number);
-            push(vm, result);
-            value_release(result);
-          }
-        } else {
-          int err = vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Function 'divide' requires both arguments to be numbers");
-          value_release(a);
-          value_release(b);
-          return err;
-        }
-        value_release(a);
-        value_release(b);
-        break;
-      }
-
-      // Built-in: len(list/string)
-      if (strcmp(func_name, "len") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'len' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type == VAL_LIST) {
-          KronosValue *result = value_new_number((double)arg->as.list.count);
-          push(vm, result);
-          value_release(result);
-        } else if (arg->type == VAL_STRING) {
-          KronosValue *result = value_new_number((double)arg->as.string.length);
-          push(vm, result);
-          value_release(result);
-        } else {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'len' requires a list or string argument");
-          value_release(arg);
-          return err;
-        }
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: uppercase(string)
-      if (strcmp(func_name, "uppercase") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'uppercase' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'uppercase' requires a string argument");
-          value_release(arg);
-          return err;
-        }
-
-        char *upper = malloc(arg->as.string.length + 1);
-        if (!upper) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        for (size_t i = 0; i < arg->as.string.length; i++) {
-          upper[i] = (char)toupper((unsigned char)arg->as.string.data[i]);
-        }
-        upper[arg->as.string.length] = '\0';
-
-        KronosValue *result = value_new_string(upper, arg->as.string.length);
-        free(upper);
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: lowercase(string)
-      if (strcmp(func_name, "lowercase") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'lowercase' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'lowercase' requires a string argument");
-          value_release(arg);
-          return err;
-        }
-
-        char *lower = malloc(arg->as.string.length + 1);
-        if (!lower) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        for (size_t i = 0; i < arg->as.string.length; i++) {
-          lower[i] = (char)tolower((unsigned char)arg->as.string.data[i]);
-        }
-        lower[arg->as.string.length] = '\0';
-
-        KronosValue *result = value_new_string(lower, arg->as.string.length);
-        free(lower);
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: trim(string)
-      if (strcmp(func_name, "trim") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'trim' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_STRING) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'trim' requires a string argument");
-          value_release(arg);
-          return err;
-        }
-
-        // Find start (skip leading whitespace)
-        size_t start = 0;
-        while (start < arg->as.string.length &&
-               isspace((unsigned char)arg->as.string.data[start])) {
-          start++;
-        }
-
-        // Find end (skip trailing whitespace)
-        size_t end = arg->as.string.length;
-        while (end > start &&
-               isspace((unsigned char)arg->as.string.data[end - 1])) {
-          end--;
-        }
-
-        size_t trimmed_len = end - start;
-        char *trimmed = malloc(trimmed_len + 1);
-        if (!trimmed) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        memcpy(trimmed, arg->as.string.data + start, trimmed_len);
-        trimmed[trimmed_len] = '\0';
-
-        KronosValue *result = value_new_string(trimmed, trimmed_len);
-        free(trimmed);
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: split(string, delimiter)
-      if (strcmp(func_name, "split") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'split' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *delim = pop(vm);
-        if (!delim) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *str = pop(vm);
-        if (!str) {
-          value_release(delim);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (str->type != VAL_STRING || delim->type != VAL_STRING) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'split' requires two string arguments");
-          value_release(str);
-          value_release(delim);
-          return err;
-        }
-
-        // Create result list
-        KronosValue *result = value_new_list(4);
-        if (!result) {
-          value_release(str);
-          value_release(delim);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
-        }
-
-        // Split string by delimiter
-        const char *str_data = str->as.string.data;
-        const char *delim_data = delim->as.string.data;
-        size_t str_len = str->as.string.length;
-        size_t delim_len = delim->as.string.length;
-
-        if (delim_len == 0) {
-          // Empty delimiter: split into individual characters
-          for (size_t i = 0; i < str_len; i++) {
-            char ch_str[2] = {str_data[i], '\0'};
-            KronosValue *ch_val = value_new_string(ch_str, 1);
-            if (!ch_val) {
-              value_release(result);
-              value_release(str);
-              value_release(delim);
-              return vm_error(vm, KRONOS_ERR_INTERNAL,
-                              "Failed to create string value");
-            }
-
-            // Grow list if needed
-            if (result->as.list.count >= result->as.list.capacity) {
-              size_t new_cap = result->as.list.capacity * 2;
-              KronosValue **new_items = realloc(
-                  result->as.list.items, sizeof(KronosValue *) * new_cap);
-              if (!new_items) {
-                value_release(ch_val);
-                value_release(result);
-                value_release(str);
-                value_release(delim);
-                return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
-              }
-              result->as.list.items = new_items;
-              result->as.list.capacity = new_cap;
-            }
-
-            value_retain(ch_val);
-            result->as.list.items[result->as.list.count++] = ch_val;
-            value_release(ch_val);
-          }
-        } else {
-          // Split by delimiter
-          size_t start = 0;
-          while (start < str_len) {
-            // Find next delimiter
-            size_t pos = start;
-            bool found = false;
-            while (pos + delim_len <= str_len) {
-              if (memcmp(str_data + pos, delim_data, delim_len) == 0) {
-                found = true;
-                break;
-              }
-              pos++;
-            }
-
-            size_t end = found ? pos : str_len;
-            size_t part_len = end - start;
-
-            // Create substring
-            char *part = malloc(part_len + 1);
-            if (!part) {
-              value_release(result);
-              value_release(str);
-              value_release(delim);
-              return vm_error(vm, KRONOS_ERR_INTERNAL,
-                              "Failed to allocate memory");
-            }
-            memcpy(part, str_data + start, part_len);
-            part[part_len] = '\0';
-
-            KronosValue *part_val = value_new_string(part, part_len);
-            free(part);
-            if (!part_val) {
-              value_release(result);
-              value_release(str);
-              value_release(delim);
-              return vm_error(vm, KRONOS_ERR_INTERNAL,
-                              "Failed to create string value");
-            }
-
-            // Grow list if needed
-            if (result->as.list.count >= result->as.list.capacity) {
-              size_t new_cap = result->as.list.capacity * 2;
-              KronosValue **new_items = realloc(
-                  result->as.list.items, sizeof(KronosValue *) * new_cap);
-              if (!new_items) {
-                value_release(part_val);
-                value_release(result);
-                value_release(str);
-                value_release(delim);
-                return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
-              }
-              result->as.list.items = new_items;
-              result->as.list.capacity = new_cap;
-            }
-
-            value_retain(part_val);
-            result->as.list.items[result->as.list.count++] = part_val;
-            value_release(part_val);
-
-            start = found ? pos + delim_len : str_len;
-          }
-        }
-
-        push(vm, result);
-        value_release(result);
-        value_release(str);
-        value_release(delim);
-        break;
-      }
-
-      // Built-in: join(list, delimiter)
-      if (strcmp(func_name, "join") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'join' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *delim = pop(vm);
-        if (!delim) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *list = pop(vm);
-        if (!list) {
-          value_release(delim);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (list->type != VAL_LIST || delim->type != VAL_STRING) {
-          int err = vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Function 'join' requires a list and a string delimiter");
-          value_release(list);
-          value_release(delim);
-          return err;
-        }
-
-        // Calculate total length
-        size_t total_len = 0;
-        for (size_t i = 0; i < list->as.list.count; i++) {
-          KronosValue *item = list->as.list.items[i];
-          if (item->type != VAL_STRING) {
-            value_release(list);
-            value_release(delim);
-            return vm_error(vm, KRONOS_ERR_RUNTIME,
-                            "All list items must be strings for join");
-          }
-          total_len += item->as.string.length;
-          if (i > 0) {
-            total_len += delim->as.string.length;
-          }
-        }
-
-        // Build joined string
-        char *joined = malloc(total_len + 1);
-        if (!joined) {
-          value_release(list);
-          value_release(delim);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-
-        size_t offset = 0;
-        for (size_t i = 0; i < list->as.list.count; i++) {
-          if (i > 0) {
-            memcpy(joined + offset, delim->as.string.data,
-                   delim->as.string.length);
-            offset += delim->as.string.length;
-          }
-          KronosValue *item = list->as.list.items[i];
-          memcpy(joined + offset, item->as.string.data, item->as.string.length);
-          offset += item->as.string.length;
-        }
-        joined[total_len] = '\0';
-
-        KronosValue *result = value_new_string(joined, total_len);
-        free(joined);
-        if (!result) {
-          value_release(list);
-          value_release(delim);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(list);
-        value_release(delim);
-        break;
-      }
-
-      // Built-in: to_string(value)
-      if (strcmp(func_name, "to_string") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'to_string' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-
-        char *str_buf = NULL;
-        size_t str_len = 0;
-
-        if (arg->type == VAL_STRING) {
-          // Already a string, just return it
-          value_retain(arg);
-          push(vm, arg);
-          value_release(arg);
-          break;
-        } else if (arg->type == VAL_NUMBER) {
-          // Convert number to string
-          // Use a reasonable buffer size
-          str_buf = malloc(64);
-          if (!str_buf) {
-            value_release(arg);
-            return vm_error(vm, KRONOS_ERR_INTERNAL,
-                            "Failed to allocate memory");
-          }
-
-          // Check if it's a whole number
-          double intpart;
-          double frac = modf(arg->as.number, &intpart);
-        
-          if (frac == 0.0 && fabs(arg->as.number) < 1.0e15) {
-            str_len = (size_t)snprintf(str_buf, 64, "%.0f", arg->as.number);
-          } else {
-            str_len = (size_t)snprintf(str_buf, 64, "%g", arg->as.number);
-          }
-        } else if (arg->type == VAL_BOOL) {
-          if (arg->as.boolean) {
-            str_buf = strdup("true");
-            str_len = 4;
-          } else {
-            str_buf = strdup("false");
-            str_len = 5;
-          }
-          if (!str_buf) {
-            value_release(arg);
-            return vm_error(vm, KRONOS_ERR_INTERNAL,
-                            "Failed to allocate memory");
-          }
-        } else if (arg->type == VAL_NIL) {
-          str_buf = strdup("null");
-          str_len = 4;
-          if (!str_buf) {
-            value_release(arg);
-            return vm_error(vm, KRONOS_ERR_INTERNAL,
-                            "Failed to allocate memory");
-          }
-        } else {
-          value_release(arg);
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Cannot convert type to string");
-        }
-
-        KronosValue *result = value_new_string(str_buf, str_len);
-        free(str_buf); // Always free our buffer (value_new_string copies it)
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: contains(string, substring)
-      if (strcmp(func_name, "contains") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'contains' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *substring = pop(vm);
-        if (!substring) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *str = pop(vm);
-        if (!str) {
-          value_release(substring);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (str->type != VAL_STRING || substring->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'contains' requires two string arguments");
-          value_release(str);
-          value_release(substring);
-          return err;
-        }
-
-        // Use strstr to check if substring exists
-        bool found =
-            (strstr(str->as.string.data, substring->as.string.data) != NULL);
-        KronosValue *result = value_new_bool(found);
-        push(vm, result);
-        value_release(result);
-        value_release(str);
-        value_release(substring);
-        break;
-      }
-
-      // Built-in: starts_with(string, prefix)
-      if (strcmp(func_name, "starts_with") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'starts_with' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *prefix = pop(vm);
-        if (!prefix) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *str = pop(vm);
-        if (!str) {
-          value_release(prefix);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (str->type != VAL_STRING || prefix->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'starts_with' requires two string arguments");
-          value_release(str);
-          value_release(prefix);
-          return err;
-        }
-
-        bool starts = false;
-        if (prefix->as.string.length <= str->as.string.length) {
-          starts = (memcmp(str->as.string.data, prefix->as.string.data,
-                           prefix->as.string.length) == 0);
-        }
-        KronosValue *result = value_new_bool(starts);
-        push(vm, result);
-        value_release(result);
-        value_release(str);
-        value_release(prefix);
-        break;
-      }
-
-      // Built-in: ends_with(string, suffix)
-      if (strcmp(func_name, "ends_with") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'ends_with' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *suffix = pop(vm);
-        if (!suffix) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *str = pop(vm);
-        if (!str) {
-          value_release(suffix);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (str->type != VAL_STRING || suffix->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'ends_with' requires two string arguments");
-          value_release(str);
-          value_release(suffix);
-          return err;
-        }
-
-        bool ends = false;
-        if (suffix->as.string.length <= str->as.string.length) {
-          size_t start_pos = str->as.string.length - suffix->as.string.length;
-          ends =
-              (memcmp(str->as.string.data + start_pos, suffix->as.string.data,
-                      suffix->as.string.length) == 0);
-        }
-        KronosValue *result = value_new_bool(ends);
-        push(vm, result);
-        value_release(result);
-        value_release(str);
-        value_release(suffix);
-        break;
-      }
-
-      // Built-in: replace(string, old, new)
-      if (strcmp(func_name, "replace") == 0) {
-        if (arg_count != 3) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'replace' expects 3 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *new_str = pop(vm);
-        if (!new_str) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *old_str = pop(vm);
-        if (!old_str) {
-          value_release(new_str);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *str = pop(vm);
-        if (!str) {
-          value_release(old_str);
-          value_release(new_str);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (str->type != VAL_STRING || old_str->type != VAL_STRING ||
-            new_str->type != VAL_STRING) {
-          int err =
-              vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                        "Function 'replace' requires three string arguments");
-          value_release(str);
-          value_release(old_str);
-          value_release(new_str);
-          return err;
-        }
-
-        // Handle empty old string (return original string)
-        if (old_str->as.string.length == 0) {
-          value_retain(str);
-          push(vm, str);
-          value_release(str);
-          value_release(old_str);
-          value_release(new_str);
-          break;
-        }
-
-        // Calculate maximum possible result size
-        // old_len == 0 is already handled above, so we know old_len > 0 here
-        size_t str_len = str->as.string.length;
-        size_t old_len = old_str->as.string.length;
-        size_t new_len = new_str->as.string.length;
-        size_t max_result_len = str_len;
-
-        if (new_len > old_len) {
-          // Worst case: maximum non-overlapping occurrences
-          // Maximum occurrences is at most str_len / old_len
-          // Each occurrence adds (new_len - old_len) characters
-          // Safe upper bound: str_len + (str_len / old_len + 1) * (new_len -
-          // old_len) But we need to check for overflow
-          size_t max_occurrences = str_len / old_len;
-          size_t growth_per_occurrence = new_len - old_len;
-
-          // Check for overflow: max_occurrences * growth_per_occurrence
-          if (max_occurrences > 0 &&
-              growth_per_occurrence > SIZE_MAX / max_occurrences) {
-            // Overflow would occur, use a conservative upper bound
-            max_result_len = SIZE_MAX;
-          } else {
-            size_t total_growth = max_occurrences * growth_per_occurrence;
-            // Check if str_len + total_growth would overflow
-            if (total_growth > SIZE_MAX - str_len) {
-              max_result_len = SIZE_MAX;
-            } else {
-              max_result_len = str_len + total_growth;
-            }
-          }
-        }
-
-        // Check for overflow before malloc (max_result_len + 1)
-        if (max_result_len == SIZE_MAX || max_result_len + 1 < max_result_len) {
-          value_release(str);
-          value_release(old_str);
-          value_release(new_str);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Result string too large");
-        }
-
-        char *result_buf = malloc(max_result_len + 1);
-        if (!result_buf) {
-          value_release(str);
-          value_release(old_str);
-          value_release(new_str);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-
-        size_t result_len = 0;
-        const char *search_start = str->as.string.data;
-        const char *search_end = str->as.string.data + str->as.string.length;
-
-        while (search_start < search_end) {
-          const char *found = strstr(search_start, old_str->as.string.data);
-          if (!found || found >= search_end) {
-            // No more occurrences, copy rest of string
-            size_t remaining = search_end - search_start;
-            memcpy(result_buf + result_len, search_start, remaining);
-            result_len += remaining;
-            break;
-          }
-
-          // Copy part before match
-          size_t before_len = found - search_start;
-          memcpy(result_buf + result_len, search_start, before_len);
-          result_len += before_len;
-
-          // Copy replacement
-          memcpy(result_buf + result_len, new_str->as.string.data,
-                 new_str->as.string.length);
-          result_len += new_str->as.string.length;
-
-          // Move past the old substring
-          search_start = found + old_str->as.string.length;
-        }
-
-        result_buf[result_len] = '\0';
-
-        KronosValue *result = value_new_string(result_buf, result_len);
-        free(result_buf);
-        if (!result) {
-          value_release(str);
-          value_release(old_str);
-          value_release(new_str);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(str);
-        value_release(old_str);
-        value_release(new_str);
-        break;
-      }
-
-      // Built-in: sqrt(number)
-      if (strcmp(func_name, "sqrt") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'sqrt' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'sqrt' requires a number argument");
-          value_release(arg);
-          return err;
-        }
-        if (arg->as.number < 0) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'sqrt' requires a non-negative number");
-          value_release(arg);
-          return err;
-        }
-        KronosValue *result = value_new_number(sqrt(arg->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: power(base, exponent)
-      if (strcmp(func_name, "power") == 0) {
-        if (arg_count != 2) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'power' expects 2 arguments, got %d",
-                           arg_count);
-        }
-        KronosValue *exponent = pop(vm);
-        if (!exponent) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        KronosValue *base = pop(vm);
-        if (!base) {
-          value_release(exponent);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (base->type != VAL_NUMBER || exponent->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'power' requires two number arguments");
-          value_release(base);
-          value_release(exponent);
-          return err;
-        }
-        KronosValue *result =
-            value_new_number(pow(base->as.number, exponent->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(base);
-        value_release(exponent);
-        break;
-      }
-
-      // Built-in: abs(number)
-      if (strcmp(func_name, "abs") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'abs' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'abs' requires a number argument");
-          value_release(arg);
-          return err;
-        }
-        KronosValue *result = value_new_number(fabs(arg->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: round(number)
-      if (strcmp(func_name, "round") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'round' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'round' requires a number argument");
-          value_release(arg);
-          return err;
-        }
-        KronosValue *result = value_new_number(round(arg->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: floor(number)
-      if (strcmp(func_name, "floor") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'floor' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'floor' requires a number argument");
-          value_release(arg);
-          return err;
-        }
-        KronosValue *result = value_new_number(floor(arg->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: ceil(number)
-      if (strcmp(func_name, "ceil") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'ceil' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_NUMBER) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'ceil' requires a number argument");
-          value_release(arg);
-          return err;
-        }
-        KronosValue *result = value_new_number(ceil(arg->as.number));
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: rand()
-      if (strcmp(func_name, "rand") == 0) {
-        if (arg_count != 0) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'rand' expects 0 arguments, got %d",
-                           arg_count);
-        }
-        // Generate random number between 0.0 and 1.0
-        double random_val = (double)rand() / (double)RAND_MAX;
-        KronosValue *result = value_new_number(random_val);
-        push(vm, result);
-        value_release(result);
-        break;
-      }
-
-      // Built-in: min(...)
-      if (strcmp(func_name, "min") == 0) {
-        if (arg_count < 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'min' expects at least 1 argument, got %d",
-                           arg_count);
-        }
-        // Pop all arguments
-        KronosValue **args = malloc(sizeof(KronosValue *) * arg_count);
-        if (!args) {
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        for (int i = arg_count - 1; i >= 0; i--) {
-          args[i] = pop(vm);
-          if (!args[i]) {
-            // Clean up already popped args
-            for (int j = i + 1; j < arg_count; j++) {
-              value_release(args[j]);
-            }
-            free(args);
-            return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-          }
-          if (args[i]->type != VAL_NUMBER) {
-            int err = vm_errorf(
-                vm, KRONOS_ERR_RUNTIME,
-                "Function 'min' requires all arguments to be numbers");
-            for (int j = 0; j < arg_count; j++) {
-              value_release(args[j]);
-            }
-            free(args);
-            return err;
-          }
-        }
-        // Find minimum
-        double min_val = args[0]->as.number;
-        for (int i = 1; i < arg_count; i++) {
-          if (args[i]->as.number < min_val) {
-            min_val = args[i]->as.number;
-          }
-        }
-        // Release all args
-        for (int i = 0; i < arg_count; i++) {
-          value_release(args[i]);
-        }
-        free(args);
-        KronosValue *result = value_new_number(min_val);
-        push(vm, result);
-        value_release(result);
-        break;
-      }
-
-      // Built-in: max(...)
-      if (strcmp(func_name, "max") == 0) {
-        if (arg_count < 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'max' expects at least 1 argument, got %d",
-                           arg_count);
-        }
-        // Pop all arguments
-        KronosValue **args = malloc(sizeof(KronosValue *) * arg_count);
-        if (!args) {
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
-        }
-        for (int i = arg_count - 1; i >= 0; i--) {
-          args[i] = pop(vm);
-          if (!args[i]) {
-            // Clean up already popped args
-            for (int j = i + 1; j < arg_count; j++) {
-              value_release(args[j]);
-            }
-            free(args);
-            return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-          }
-          if (args[i]->type != VAL_NUMBER) {
-            int err = vm_errorf(
-                vm, KRONOS_ERR_RUNTIME,
-                "Function 'max' requires all arguments to be numbers");
-            for (int j = 0; j < arg_count; j++) {
-              value_release(args[j]);
-            }
-            free(args);
-            return err;
-          }
-        }
-        // Find maximum
-        double max_val = args[0]->as.number;
-        for (int i = 1; i < arg_count; i++) {
-          if (args[i]->as.number > max_val) {
-            max_val = args[i]->as.number;
-          }
-        }
-        // Release all args
-        for (int i = 0; i < arg_count; i++) {
-          value_release(args[i]);
-        }
-        free(args);
-        KronosValue *result = value_new_number(max_val);
-        push(vm, result);
-        value_release(result);
-        break;
-      }
-
-      // Built-in: to_number(string)
-      if (strcmp(func_name, "to_number") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'to_number' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type == VAL_NUMBER) {
-          // Already a number, just return it
-          value_retain(arg);
-          push(vm, arg);
-          value_release(arg);
-          break;
-        } else if (arg->type == VAL_STRING) {
-          // Convert string to number
-          char *endptr;
-          double num = strtod(arg->as.string.data, &endptr);
-          // Check if conversion was successful (endptr should point to end of
-          // string)
-          if (*endptr != '\0' && *endptr != '\n' && *endptr != '\r') {
-            int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                                "Cannot convert string to number: '%s'",
-                                arg->as.string.data);
-            value_release(arg);
-            return err;
-          }
-          KronosValue *result = value_new_number(num);
-          push(vm, result);
-          value_release(result);
-          value_release(arg);
-          break;
-        } else {
-          int err = vm_errorf(
-              vm, KRONOS_ERR_RUNTIME,
-              "Function 'to_number' requires a string or number argument");
-          value_release(arg);
-          return err;
-        }
-      }
-
-      // Built-in: to_bool(value)
-      if (strcmp(func_name, "to_bool") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'to_bool' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        bool bool_val = false;
-        if (arg->type == VAL_BOOL) {
-          // Already a boolean, just return it
-          bool_val = arg->as.boolean;
-        } else if (arg->type == VAL_STRING) {
-          // Convert string to boolean
-          // "true" (case-insensitive) -> true, everything else -> false
-          if (arg->as.string.length == 4 &&
-              (arg->as.string.data[0] == 't' ||
-               arg->as.string.data[0] == 'T') &&
-              (arg->as.string.data[1] == 'r' ||
-               arg->as.string.data[1] == 'R') &&
-              (arg->as.string.data[2] == 'u' ||
-               arg->as.string.data[2] == 'U') &&
-              (arg->as.string.data[3] == 'e' ||
-               arg->as.string.data[3] == 'E')) {
-            bool_val = true;
-          } else {
-            bool_val = false;
-          }
-        } else if (arg->type == VAL_NUMBER) {
-          // Number: 0 -> false, everything else -> true
-          bool_val = (arg->as.number != 0.0);
-        } else if (arg->type == VAL_NIL) {
-          // null -> false
-          bool_val = false;
-        } else {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Cannot convert type to boolean");
-          value_release(arg);
-          return err;
-        }
-        value_release(arg);
-        KronosValue *result = value_new_bool(bool_val);
-        push(vm, result);
-        value_release(result);
-        break;
-      }
-
-      // Built-in: reverse(list)
-      if (strcmp(func_name, "reverse") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'reverse' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_LIST) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'reverse' requires a list argument");
-          value_release(arg);
-          return err;
-        }
-        // Create new list with reversed items
-        KronosValue *result = value_new_list(arg->as.list.count);
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
-        }
-        // Copy items in reverse order
-        for (int i = (int)arg->as.list.count - 1; i >= 0; i--) {
-          value_retain(arg->as.list.items[i]);
-          // Grow list if needed
-          if (result->as.list.count >= result->as.list.capacity) {
-            size_t new_cap = result->as.list.capacity * 2;
-            KronosValue **new_items =
-                realloc(result->as.list.items, sizeof(KronosValue *) * new_cap);
-            if (!new_items) {
-              value_release(arg->as.list.items[i]);
-              value_release(result);
-              value_release(arg);
-              return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
-            }
-            result->as.list.items = new_items;
-            result->as.list.capacity = new_cap;
-          }
-          result->as.list.items[result->as.list.count++] =
-              arg->as.list.items[i];
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Built-in: sort(list)
-      if (strcmp(func_name, "sort") == 0) {
-        if (arg_count != 1) {
-          return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                           "Function 'sort' expects 1 argument, got %d",
-                           arg_count);
-        }
-        KronosValue *arg = pop(vm);
-        if (!arg) {
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-        if (arg->type != VAL_LIST) {
-          int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                              "Function 'sort' requires a list argument");
-          value_release(arg);
-          return err;
-        }
-        // Create new list with sorted items
-        KronosValue *result = value_new_list(arg->as.list.count);
-        if (!result) {
-          value_release(arg);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
-        }
-        // Copy items
-        for (size_t i = 0; i < arg->as.list.count; i++) {
-          value_retain(arg->as.list.items[i]);
-          // Grow list if needed
-          if (result->as.list.count >= result->as.list.capacity) {
-            size_t new_cap = result->as.list.capacity * 2;
-            KronosValue **new_items =
-                realloc(result->as.list.items, sizeof(KronosValue *) * new_cap);
-            if (!new_items) {
-              value_release(arg->as.list.items[i]);
-              value_release(result);
-              value_release(arg);
-              return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
-            }
-            result->as.list.items = new_items;
-            result->as.list.capacity = new_cap;
-          }
-          result->as.list.items[result->as.list.count++] =
-              arg->as.list.items[i];
-        }
-        // Sort the new list in-place
-        // Simple bubble sort (can be optimized later)
-        for (size_t i = 0; i < result->as.list.count; i++) {
-          for (size_t j = 0; j < result->as.list.count - i - 1; j++) {
-            KronosValue *a = result->as.list.items[j];
-            KronosValue *b = result->as.list.items[j + 1];
-            bool should_swap = false;
-            if (a->type == VAL_NUMBER && b->type == VAL_NUMBER) {
-              should_swap = a->as.number > b->as.number;
-            } else if (a->type == VAL_STRING && b->type == VAL_STRING) {
-              should_swap = strcmp(a->as.string.data, b->as.string.data) > 0;
-            } else {
-              int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                                  "Function 'sort' requires list items to be "
-                                  "all numbers or all strings");
-              value_release(result);
-              value_release(arg);
-              return err;
-            }
-            if (should_swap) {
-              result->as.list.items[j] = b;
-              result->as.list.items[j + 1] = a;
-            }
-          }
-        }
-        push(vm, result);
-        value_release(result);
-        value_release(arg);
-        break;
-      }
-
-      // Get user-defined function
-      Function *func = vm_get_function(vm, func_name);
-      if (!func) {
-        return vm_errorf(vm, KRONOS_ERR_NOT_FOUND, "Undefined function '%s'",
-                         func_name);
-      }
-
-      if (arg_count != func->param_count) {
-        return vm_errorf(vm, KRONOS_ERR_RUNTIME,
-                         "Function '%s' expects %zu argument%s, but got %d",
-                         func->name, func->param_count,
-                         func->param_count == 1 ? "" : "s", arg_count);
-      }
-
-      // Check call stack size
-      if (vm->call_stack_size >= CALL_STACK_MAX) {
-        return vm_error(vm, KRONOS_ERR_RUNTIME, "Maximum call depth exceeded");
-      }
-
-      // Create new call frame
-      CallFrame *frame = &vm->call_stack[vm->call_stack_size++];
-      frame->function = func;
-      frame->return_ip = vm->ip;
-      frame->return_bytecode = vm->bytecode;
-      frame->frame_start = vm->stack_top;
-      frame->local_count = 0;
-
-      // Pop arguments and bind to parameters (in reverse order)
-      KronosValue **args =
-          arg_count > 0 ? malloc(sizeof(KronosValue *) * arg_count) : NULL;
-      if (arg_count > 0 && !args) {
-        // Allocation failure: restore VM state and abort call setup
-        // Decrement call stack size to undo the increment above
-        vm->call_stack_size--;
-        return vm_error(vm, KRONOS_ERR_INTERNAL,
-                        "Failed to allocate argument buffer");
-      }
-      for (int i = arg_count - 1; i >= 0; i--) {
-        args[i] = pop(vm);
-        if (!args[i]) {
-          // Free already-popped arguments
-          for (int j = i + 1; j < arg_count; j++) {
-            value_release(args[j]);
-          }
-          free(args);
-          return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-        }
-      }
+    // Move past the old substring
+    search_start = found + AS_STRING_LEN(old_str);
+  }
 
-      // Set current frame before setting locals
-      vm->current_frame = frame;
-
-      // Set parameters as local variables in the new frame
-      // Parameters are mutable by default
-      for (size_t i = 0; i < arg_count; i++) {
-        int arg_status =
-            vm_set_local(vm, frame, func->params[i], args[i], true, NULL);
-        value_release(args[i]);
-        if (arg_status != 0) {
-          for (size_t j = i + 1; j < arg_count; j++) {
-            value_release(args[j]);
-          }
-          free(args);
-
-          for (size_t j = 0; j < frame->local_count; j++) {
-            free(frame->locals[j].name);
-            value_release(frame->locals[j].value);
-            free(frame->locals[j].type_name);
-          }
-          frame->local_count = 0;
-
-          vm->call_stack_size--;
-          if (vm->call_stack_size > 0) {
-            vm->current_frame = &vm->call_stack[vm->call_stack_size - 1];
-          } else {
-            vm->current_frame = NULL;
-          }
-          return arg_status;
-        }
-      }
-      free(args);
+  result_buf[result_len] = '\0';
 
-      // Switch to function bytecode
-      vm->bytecode = &func->bytecode;
-      vm->ip = func->bytecode.code;
+  KronosValue *result = value_new_string(result_buf, result_len);
+  mem_free(result_buf);
+  if (!result) {
+    val_release(str);
+    val_release(old_str);
+    val_release(new_str);
+    return vm_error(vm, KRONOS_ERR_INTERNAL,
+                    "Failed to create string value");
+  }
+  push_object(vm, result);
+  val_release(str);
+  val_release(old_str);
+  val_release(new_str);
+  return 0;
+}
 
-      break;
-    }
+// Built-in: sqrt(number)
+static int builtin_sqrt(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'sqrt' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'sqrt' requires a number argument");
+    val_release(arg);
+    return err;
+  }
+  if (AS_NUMBER(arg) < 0) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'sqrt' requires a non-negative number");
+    val_release(arg);
+    return err;
+  }
+  push(vm, NUMBER_VAL(sqrt(AS_NUMBER(arg))));
+  val_release(arg);
+  return 0;
+}
 
-    case OP_RETURN_VAL: {
-      // Pop return value from stack
-      KronosValue *return_value = pop(vm);
-      if (!return_value) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in: power(base, exponent)
+static int builtin_power(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 2) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'power' expects 2 arguments, got %d",
+                     arg_count);
+  }
+  Value exponent = pop(vm);
+  if (IS_EMPTY(exponent)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  Value base = pop(vm);
+  if (IS_EMPTY(base)) {
+    val_release(exponent);
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(base) || !IS_NUMBER(exponent)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'power' requires two number arguments");
+    val_release(base);
+    val_release(exponent);
+    return err;
+  }
+  push(vm, NUMBER_VAL(pow(AS_NUMBER(base), AS_NUMBER(exponent))));
+  val_release(base);
+  val_release(exponent);
+  return 0;
+}
 
-      // If we're in a function call, return from it
-      if (vm->call_stack_size > 0) {
-        CallFrame *frame = &vm->call_stack[vm->call_stack_size - 1];
+// Built-in: abs(number)
+static int builtin_abs(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'abs' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'abs' requires a number argument");
+    val_release(arg);
+    return err;
+  }
+  push(vm, NUMBER_VAL(fabs(AS_NUMBER(arg))));
+  val_release(arg);
+  return 0;
+}
 
-        // Clean up local variables
-        for (size_t i = 0; i < frame->local_count; i++) {
-          free(frame->locals[i].name);
-          value_release(frame->locals[i].value);
-          free(frame->locals[i].type_name);
-        }
+// Built-in: round(number)
+static int builtin_round(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'round' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'round' requires a number argument");
+    val_release(arg);
+    return err;
+  }
+  push(vm, NUMBER_VAL(round(AS_NUMBER(arg))));
+  val_release(arg);
+  return 0;
+}
 
-        // Restore VM state
-        vm->ip = frame->return_ip;
-        vm->bytecode = frame->return_bytecode;
-        vm->call_stack_size--;
+// Built-in: floor(number)
+static int builtin_floor(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'floor' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'floor' requires a number argument");
+    val_release(arg);
+    return err;
+  }
+  push(vm, NUMBER_VAL(floor(AS_NUMBER(arg))));
+  val_release(arg);
+  return 0;
+}
 
-        // Update current frame pointer
-        if (vm->call_stack_size > 0) {
-          vm->current_frame = &vm->call_stack[vm->call_stack_size - 1];
-        } else {
-          vm->current_frame = NULL;
-        }
+// Built-in: ceil(number)
+static int builtin_ceil(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'ceil' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_NUMBER(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'ceil' requires a number argument");
+    val_release(arg);
+    return err;
+  }
+  push(vm, NUMBER_VAL(ceil(AS_NUMBER(arg))));
+  val_release(arg);
+  return 0;
+}
 
-        // Push return value onto stack
-        push(vm, return_value);
-        value_release(return_value);
-      } else {
-        // Top-level return (shouldn't happen in normal code)
-        push(vm, return_value);
-        value_release(return_value);
-      }
+// Built-in: rand()
+static int builtin_rand(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 0) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'rand' expects 0 arguments, got %d",
+                     arg_count);
+  }
+  // Generate random number between 0.0 and 1.0
+  double random_val = (double)rand() / (double)RAND_MAX;
+  push(vm, NUMBER_VAL(random_val));
+  return 0;
+}
 
-      break;
+// Built-in: min(...)
+static int builtin_min(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count < 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'min' expects at least 1 argument, got %d",
+                     arg_count);
+  }
+  // Pop all arguments
+  Value *args = mem_alloc(sizeof(Value) * arg_count);
+  if (!args) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  for (int i = arg_count - 1; i >= 0; i--) {
+    args[i] = pop(vm);
+    if (IS_EMPTY(args[i])) {
+      // Clean up already popped args
+      for (int j = i + 1; j < arg_count; j++) {
+        val_release(args[j]);
+      }
+      mem_free(args);
+      return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
     }
-
-    case OP_POP: {
-      KronosValue *value = pop(vm);
-      if (!value) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      value_release(value);
-      break;
+    if (!IS_NUMBER(args[i])) {
+      int err = vm_errorf(
+          vm, KRONOS_ERR_RUNTIME,
+          "Function 'min' requires all arguments to be numbers");
+      for (int j = i; j < arg_count; j++) {
+        val_release(args[j]);
+      }
+      mem_free(args);
+      return err;
     }
-
-    case OP_LIST_NEW: {
-      // Read element count from bytecode
-      uint16_t count = (uint16_t)(read_byte(vm) << 8 | read_byte(vm));
-      KronosValue *list = value_new_list(count);
-      if (!list) {
-        return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
-      }
-      push(vm, list);
-      value_release(list);
-      break;
+  }
+  // Find minimum
+  double min_val = AS_NUMBER(args[0]);
+  for (int i = 1; i < arg_count; i++) {
+    if (AS_NUMBER(args[i]) < min_val) {
+      min_val = AS_NUMBER(args[i]);
     }
+  }
+  // Release all args
+  for (int i = 0; i < arg_count; i++) {
+    val_release(args[i]);
+  }
+  mem_free(args);
+  push(vm, NUMBER_VAL(min_val));
+  return 0;
+}
 
-    case OP_LIST_APPEND: {
-      KronosValue *value = pop(vm);
-      if (!value) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *list = pop(vm);
-      if (!list) {
-        value_release(value);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-
-      if (list->type != VAL_LIST) {
-        value_release(value);
-        value_release(list);
-        return vm_error(vm, KRONOS_ERR_RUNTIME, "Expected list for append");
-      }
-
-      // Grow list if needed
-      if (list->as.list.count >= list->as.list.capacity) {
-        size_t new_capacity =
-            list->as.list.capacity == 0 ? 4 : list->as.list.capacity * 2;
-        KronosValue **new_items =
-            realloc(list->as.list.items, sizeof(KronosValue *) * new_capacity);
-        if (!new_items) {
-          value_release(value);
-          value_release(list);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
-        }
-        list->as.list.items = new_items;
-        list->as.list.capacity = new_capacity;
-      }
-
-      // Append value
-      value_retain(value);
-      list->as.list.items[list->as.list.count++] = value;
-      push(vm, list);
-      value_release(list);
-      value_release(value);
-      break;
+// Built-in: max(...)
+static int builtin_max(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count < 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'max' expects at least 1 argument, got %d",
+                     arg_count);
+  }
+  // Pop all arguments
+  Value *args = mem_alloc(sizeof(Value) * arg_count);
+  if (!args) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to allocate memory");
+  }
+  for (int i = arg_count - 1; i >= 0; i--) {
+    args[i] = pop(vm);
+    if (IS_EMPTY(args[i])) {
+      // Clean up already popped args
+      for (int j = i + 1; j < arg_count; j++) {
+        val_release(args[j]);
+      }
+      mem_free(args);
+      return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
     }
+    if (!IS_NUMBER(args[i])) {
+      int err = vm_errorf(
+          vm, KRONOS_ERR_RUNTIME,
+          "Function 'max' requires all arguments to be numbers");
+      for (int j = i; j < arg_count; j++) {
+        val_release(args[j]);
+      }
+      mem_free(args);
+      return err;
+    }
+  }
+  // Find maximum
+  double max_val = AS_NUMBER(args[0]);
+  for (int i = 1; i < arg_count; i++) {
+    if (AS_NUMBER(args[i]) > max_val) {
+      max_val = AS_NUMBER(args[i]);
+    }
+  }
+  // Release all args
+  for (int i = 0; i < arg_count; i++) {
+    val_release(args[i]);
+  }
+  mem_free(args);
+  push(vm, NUMBER_VAL(max_val));
+  return 0;
+}
 
-    case OP_LIST_GET: {
-      KronosValue *index_val = pop(vm);
-      if (!index_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *container = pop(vm);
-      if (!container) {
-        value_release(index_val);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-
-      if (index_val->type != VAL_NUMBER) {
-        value_release(index_val);
-        value_release(container);
-        return vm_error(vm, KRONOS_ERR_RUNTIME, "Index must be a number");
-      }
-
-      // Handle negative indices
-      int64_t idx = (int64_t)index_val->as.number;
-
-      if (container->type == VAL_LIST) {
-        if (idx < 0) {
-          idx = (int64_t)container->as.list.count + idx;
-        }
-
-        if (idx < 0 || (size_t)idx >= container->as.list.count) {
-          value_release(index_val);
-          value_release(container);
-          return vm_error(vm, KRONOS_ERR_RUNTIME, "List index out of bounds");
-        }
-
-        KronosValue *item = container->as.list.items[(size_t)idx];
-        value_retain(item);
-        push(vm, item);
-        value_release(item);
-      } else if (container->type == VAL_STRING) {
-        // String indexing
-        if (idx < 0) {
-          idx = (int64_t)container->as.string.length + idx;
-        }
-
-        if (idx < 0 || (size_t)idx >= container->as.string.length) {
-          value_release(index_val);
-          value_release(container);
-          return vm_error(vm, KRONOS_ERR_RUNTIME, "String index out of bounds");
-        }
+// Built-in: to_number(string)
+static int builtin_to_number(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'to_number' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (IS_NUMBER(arg)) {
+    // Already a number, just return it
+    val_retain(arg);
+    push(vm, arg);
+    val_release(arg);
+    return 0;
+  } else if (IS_STRING(arg)) {
+    // Convert string to number
+    char *endptr;
+    double num = strtod(AS_CSTRING(arg), &endptr);
+    // Check if conversion was successful (endptr should point to end of
+    // string)
+    if (*endptr != '\0' && *endptr != '\n' && *endptr != '\r') {
+      int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                          "Cannot convert string to number: '%s'",
+                          AS_CSTRING(arg));
+      val_release(arg);
+      return err;
+    }
+    push(vm, NUMBER_VAL(num));
+    val_release(arg);
+    return 0;
+  } else {
+    int err = vm_errorf(
+        vm, KRONOS_ERR_RUNTIME,
+        "Function 'to_number' requires a string or number argument");
+    val_release(arg);
+    return err;
+  }
+}
 
-        // Create a single-character string
-        char ch = container->as.string.data[(size_t)idx];
-        char str[2] = {ch, '\0'};
-        KronosValue *char_str = value_new_string(str, 1);
-        if (!char_str) {
-          value_release(index_val);
-          value_release(container);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
-        push(vm, char_str);
-        value_release(char_str);
-      } else {
-        value_release(index_val);
-        value_release(container);
-        return vm_error(vm, KRONOS_ERR_RUNTIME,
-                        "Indexing only supported for lists and strings");
-      }
+// Built-in: to_bool(value)
+static int builtin_to_bool(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'to_bool' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  bool bool_val = false;
+  if (IS_BOOL(arg)) {
+    // Already a boolean, just return it
+    bool_val = AS_BOOL(arg);
+  } else if (IS_STRING(arg)) {
+    // Convert string to boolean
+    // "true" (case-insensitive) -> true, everything else -> false
+    bool_val = AS_STRING_LEN(arg) == 4 &&
+               strncasecmp(AS_CSTRING(arg), "true", 4) == 0;
+  } else if (IS_NUMBER(arg)) {
+    // Number: 0 -> false, everything else -> true
+    bool_val = (AS_NUMBER(arg) != 0.0);
+  } else if (IS_NIL(arg)) {
+    // null -> false
+    bool_val = false;
+  } else {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Cannot convert type to boolean");
+    val_release(arg);
+    return err;
+  }
+  val_release(arg);
+  push(vm, BOOL_VAL(bool_val));
+  return 0;
+}
 
-      value_release(index_val);
-      value_release(container);
-      break;
+// Built-in: reverse(list)
+static int builtin_reverse(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'reverse' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_LIST(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'reverse' requires a list argument");
+    val_release(arg);
+    return err;
+  }
+  // Create new list with reversed items
+  KronosValue *result = value_new_list(AS_LIST(arg)->count);
+  if (!result) {
+    val_release(arg);
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
+  }
+  // Copy items in reverse order
+  for (int i = (int)AS_LIST(arg)->count - 1; i >= 0; i--) {
+    if (!value_list_append(result, AS_LIST(arg)->items[i])) {
+      value_release(result);
+      val_release(arg);
+      return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
     }
+  }
+  push_object(vm, result);
+  val_release(arg);
+  return 0;
+}
 
-    case OP_LIST_LEN: {
-      KronosValue *container = pop(vm);
-      if (!container) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-
-      if (container->type == VAL_LIST) {
-        KronosValue *len = value_new_number((double)container->as.list.count);
-        push(vm, len);
-        value_release(len);
-      } else if (container->type == VAL_STRING) {
-        KronosValue *len =
-            value_new_number((double)container->as.string.length);
-        push(vm, len);
-        value_release(len);
-      } else {
-        value_release(container);
-        return vm_error(vm, KRONOS_ERR_RUNTIME,
-                        "Expected list or string for length");
+// Built-in: sort(list)
+static int builtin_sort(KronosVM *vm, uint8_t arg_count) {
+  if (arg_count != 1) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'sort' expects 1 argument, got %d",
+                     arg_count);
+  }
+  Value arg = pop(vm);
+  if (IS_EMPTY(arg)) {
+    return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
+  }
+  if (!IS_LIST(arg)) {
+    int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                        "Function 'sort' requires a list argument");
+    val_release(arg);
+    return err;
+  }
+  // A list nobody else references is sorted in place and handed back;
+  // otherwise sort a copy so other holders keep the original order
+  KronosValue *result = AS_OBJ(arg);
+  if (result->refcount > 1) {
+    result = value_new_list(AS_LIST(arg)->count);
+    if (!result) {
+      val_release(arg);
+      return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
+    }
+    for (size_t i = 0; i < AS_LIST(arg)->count; i++) {
+      if (!value_list_append(result, AS_LIST(arg)->items[i])) {
+        value_release(result);
+        val_release(arg);
+        return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to grow list");
       }
-
-      value_release(container);
-      break;
     }
+    val_release(arg);
+  }
+  if (!value_list_sort(result)) {
+    value_release(result);
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function 'sort' requires list items to be "
+                     "all numbers or all strings");
+  }
+  push_object(vm, result);
+  return 0;
+}
 
-    case OP_LIST_SLICE: {
-      KronosValue *end_val = pop(vm);
-      if (!end_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *start_val = pop(vm);
-      if (!start_val) {
-        value_release(end_val);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *container = pop(vm);
-      if (!container) {
-        value_release(start_val);
-        value_release(end_val);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Built-in dispatch table, indexed by BuiltinId (see compiler.h)
+typedef int (*BuiltinFn)(KronosVM *vm, uint8_t arg_count);
+
+static const BuiltinFn builtin_functions[BUILTIN_COUNT] = {
+    [BUILTIN_READ_FILE] = builtin_read_file,
+    [BUILTIN_ADD] = builtin_add,
+    [BUILTIN_SUBTRACT] = builtin_subtract,
+    [BUILTIN_MULTIPLY] = builtin_multiply,
+    [BUILTIN_DIVIDE] = builtin_divide,
+    [BUILTIN_LEN] = builtin_len,
+    [BUILTIN_UPPERCASE] = builtin_uppercase,
+    [BUILTIN_LOWERCASE] = builtin_lowercase,
+    [BUILTIN_TRIM] = builtin_trim,
+    [BUILTIN_SPLIT] = builtin_split,
+    [BUILTIN_JOIN] = builtin_join,
+    [BUILTIN_TO_STRING] = builtin_to_string,
+    [BUILTIN_CONTAINS] = builtin_contains,
+    [BUILTIN_STARTS_WITH] = builtin_starts_with,
+    [BUILTIN_ENDS_WITH] = builtin_ends_with,
+    [BUILTIN_REPLACE] = builtin_replace,
+    [BUILTIN_SQRT] = builtin_sqrt,
+    [BUILTIN_POWER] = builtin_power,
+    [BUILTIN_ABS] = builtin_abs,
+    [BUILTIN_ROUND] = builtin_round,
+    [BUILTIN_FLOOR] = builtin_floor,
+    [BUILTIN_CEIL] = builtin_ceil,
+    [BUILTIN_RAND] = builtin_rand,
+    [BUILTIN_MIN] = builtin_min,
+    [BUILTIN_MAX] = builtin_max,
+    [BUILTIN_TO_NUMBER] = builtin_to_number,
+    [BUILTIN_TO_BOOL] = builtin_to_bool,
+    [BUILTIN_REVERSE] = builtin_reverse,
+    [BUILTIN_SORT] = builtin_sort,
+};
+
+// Free operand stack slots
+static inline size_t vm_stack_room(const KronosVM *vm) {
+  return (size_t)(vm->stack + STACK_MAX - vm->stack_top);
+}
 
-      if (start_val->type != VAL_NUMBER || end_val->type != VAL_NUMBER) {
-        value_release(container);
-        value_release(start_val);
-        value_release(end_val);
-        return vm_error(vm, KRONOS_ERR_RUNTIME,
-                        "Slice indices must be numbers");
-      }
+/**
+ * @brief Enter a user-defined function
+ *
+ * Pushes a call frame, moves the arguments from the stack into the parameter
+ * slots and switches execution to the function's bytecode.
+ *
+ * @param vm VM instance
+ * @param func Function to call
+ * @param arg_count Number of arguments on the stack
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_call_function(KronosVM *vm, Function *func, uint8_t arg_count) {
+  if (arg_count != func->param_count) {
+    return vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                     "Function '%s' expects %zu argument%s, but got %d",
+                     func->name, func->param_count,
+                     func->param_count == 1 ? "" : "s", arg_count);
+  }
 
-      int64_t start = (int64_t)start_val->as.number;
-      int64_t end = (int64_t)end_val->as.number;
+  // Check call stack size
+  if (vm->call_stack_size >= CALL_STACK_MAX) {
+    return vm_error(vm, KRONOS_ERR_RUNTIME, "Maximum call depth exceeded");
+  }
 
-      if (container->type == VAL_LIST) {
-        size_t len = container->as.list.count;
+  if (vm->stack_top - vm->stack < arg_count) {
+    return vm_error(vm, KRONOS_ERR_RUNTIME,
+                    "Stack underflow (internal error - please report this bug)");
+  }
 
-        // Handle negative indices
-        if (start < 0) {
-          start = (int64_t)len + start;
-        }
-        if (end < 0) {
-          if (end == -1) {
-            // Special marker for "to end"
-            end = (int64_t)len;
-          } else {
-            end = (int64_t)len + end;
-          }
-        }
+  // Create new call frame
+  CallFrame *frame = &vm->call_stack[vm->call_stack_size++];
+  frame->function = func;
+  frame->return_ip = vm->ip;
+  frame->return_bytecode = vm->bytecode;
+  frame->return_links = vm->links;
+  frame->return_verified = vm->verified;
+  frame->frame_start = vm->stack_top;
+  frame->local_count = func->local_count;
+
+  // Move arguments straight into the parameter slots (mutable, untyped);
+  // the stack's references transfer to the frame
+  for (size_t i = arg_count; i < func->local_count; i++) {
+    frame->locals[i].value = EMPTY_VAL;
+  }
+  for (int i = arg_count - 1; i >= 0; i--) {
+    frame->locals[i].value = *--vm->stack_top;
+    frame->locals[i].is_mutable = true;
+    frame->locals[i].type_name = NULL;
+  }
+  vm->current_frame = frame;
 
-        // Clamp to valid range
-        if (start < 0)
-          start = 0;
-        if (end < 0)
-          end = 0;
-        if ((size_t)start > len)
-          start = (int64_t)len;
-        if ((size_t)end > len)
-          end = (int64_t)len;
-        if (start > end)
-          start = end;
-
-        // Create new list with sliced elements
-        size_t slice_len = (size_t)(end - start);
-        KronosValue *slice = value_new_list(slice_len);
-        if (!slice) {
-          value_release(container);
-          value_release(start_val);
-          value_release(end_val);
-          return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create list");
-        }
+  // Switch to function bytecode
+  vm->bytecode = &func->bytecode;
+  vm->links = func->links;
+  vm->ip = func->bytecode.code;
+  vm->verified = func->verified && vm_stack_room(vm) >= func->max_stack;
+  return 0;
+}
 
-        for (size_t i = 0; i < slice_len; i++) {
-          KronosValue *item = container->as.list.items[(size_t)start + i];
-          value_retain(item);
-          slice->as.list.items[slice->as.list.count++] = item;
-        }
+/**
+ * @brief Check whether a concatenation may append to its left operand
+ *
+ * Safe when the left string is referenced only by the operand stack and by
+ * a mutable variable that the next instruction overwrites with the result:
+ * `let s to s plus piece` then grows s in place, so building a string in a
+ * loop is linear instead of quadratic. A string whose only reference is the
+ * operand stack (an intermediate result) may always be extended.
+ *
+ * @param vm VM instance
+ * @param a Left operand, popped by the caller
+ * @param next Instruction after the addition (NULL to disable the check)
+ * @param end End of the current bytecode
+ * @return true if a can be mutated without anyone observing it
+ */
+static bool vm_concat_in_place(KronosVM *vm, Value a, const uint8_t *next,
+                               const uint8_t *end) {
+  if (!next || !IS_STRING(a))
+    return false;
+  KronosValue *str = AS_OBJ(a);
+  if (str->flags & (VALUE_FLAG_IMMORTAL | VALUE_FLAG_SHARED))
+    return false;
+  if (str->refcount == 1)
+    return true;
+  if (str->refcount != 2)
+    return false;
+
+  if (end - next > 1 && next[0] == OP_STORE_LOCAL) {
+    CallFrame *frame = vm->current_frame;
+    uint8_t slot = next[1];
+    return frame && slot < frame->local_count &&
+           frame->locals[slot].value == a && frame->locals[slot].is_mutable;
+  }
+  if (end - next > 2 && next[0] == OP_STORE_GLOBAL) {
+    uint16_t idx = (uint16_t)(next[1] << 8 | next[2]);
+    if (!vm->links || idx >= vm->bytecode->global_count)
+      return false;
+    GlobalVar *global = &vm->globals[vm->links->global_links[idx]];
+    return global->value == a && global->is_mutable;
+  }
+  return false;
+}
 
-        push(vm, slice);
-        value_release(slice);
-      } else if (container->type == VAL_STRING) {
-        size_t len = container->as.string.length;
+/**
+ * @brief Concatenate the string forms of two values (OP_ADD on non-numbers)
+ *
+ * Appends to the left string in place when vm_concat_in_place() allows it,
+ * otherwise builds the result with a single allocation.
+ *
+ * @param vm VM instance
+ * @param a Left operand (borrowed)
+ * @param b Right operand (borrowed)
+ * @param next Instruction after the addition (NULL to always copy)
+ * @param end End of the current bytecode
+ * @param out Receives the new string (owned by the caller)
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_concat_values(KronosVM *vm, Value a, Value b,
+                            const uint8_t *next, const uint8_t *end,
+                            Value *out) {
+  char buf_a[64];
+  char buf_b[64];
+  size_t len_a;
+  size_t len_b;
+  const char *str_b = value_string_form(b, buf_b, &len_b);
+
+  if (a != b && vm_concat_in_place(vm, a, next, end) &&
+      value_string_append(AS_OBJ(a), str_b, len_b)) {
+    val_retain(a);
+    *out = a;
+    return 0;
+  }
 
-        // Handle negative indices
-        if (start < 0) {
-          start = (int64_t)len + start;
-        }
-        if (end < 0) {
-          if (end == -1) {
-            // Special marker for "to end"
-            end = (int64_t)len;
-          } else {
-            end = (int64_t)len + end;
-          }
-        }
+  // Left operand first, then right operand
+  const char *str_a = value_string_form(a, buf_a, &len_a);
+  KronosValue *result = value_new_string_concat(str_a, len_a, str_b, len_b);
+  if (!result) {
+    return vm_error(vm, KRONOS_ERR_INTERNAL, "Failed to create string value");
+  }
+  *out = OBJ_VAL(result);
+  return 0;
+}
 
-        // Clamp to valid range
-        if (start < 0)
-          start = 0;
-        if (end < 0)
-          end = 0;
-        if ((size_t)start > len)
-          start = (int64_t)len;
-        if ((size_t)end > len)
-          end = (int64_t)len;
-        if (start > end)
-          start = end;
-
-        // Create new string with sliced characters
-        size_t slice_len = (size_t)(end - start);
-        char *slice_data = malloc(slice_len + 1);
-        if (!slice_data) {
-          value_release(container);
-          value_release(start_val);
-          value_release(end_val);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to allocate memory for string slice");
-        }
+// Add two values with OP_ADD semantics; *out is owned by the caller. next
+// and end locate the following instruction (see vm_concat_in_place()).
+static inline int vm_add_values(KronosVM *vm, Value a, Value b,
+                                const uint8_t *next, const uint8_t *end,
+                                Value *out) {
+  if (IS_NUMBER(a) && IS_NUMBER(b)) {
+    *out = val_number_add(a, b);
+    return 0;
+  }
+  return vm_concat_values(vm, a, b, next, end, out);
+}
 
-        memcpy(slice_data, container->as.string.data + start, slice_len);
-        slice_data[slice_len] = '\0';
-
-        KronosValue *slice = value_new_string(slice_data, slice_len);
-        free(slice_data);
-        if (!slice) {
-          value_release(container);
-          value_release(start_val);
-          value_release(end_val);
-          return vm_error(vm, KRONOS_ERR_INTERNAL,
-                          "Failed to create string value");
-        }
+// Longest number form value_string_form() produces ("%.0f" below 1e15, or
+// "%g"), plus its terminator
+#define NUMBER_FORM_MAX 24
 
-        push(vm, slice);
-        value_release(slice);
-      } else {
-        value_release(container);
-        value_release(start_val);
-        value_release(end_val);
-        return vm_error(vm, KRONOS_ERR_RUNTIME,
-                        "Slicing only supported for lists and strings");
-      }
+/**
+ * @brief Replace the top count stack values with their concatenation
+ *
+ * Implements OP_BUILD_STRING: every value is converted with the same rules
+ * as OP_ADD concatenation, the total length is summed, and the result is
+ * built with one allocation instead of a chain of intermediate strings.
+ * When the first value is a string that vm_concat_in_place() allows to be
+ * mutated (`let s to s plus ", " plus item`), the rest is appended to it.
+ *
+ * @param vm VM instance
+ * @param count Number of values to join (taken from the top of the stack)
+ * @param strict Fail like to_string on values other than strings, numbers,
+ * booleans and null (f-strings) instead of joining them as ""
+ * @param next Instruction after OP_BUILD_STRING (NULL to always copy)
+ * @param end End of the current bytecode
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_build_string(KronosVM *vm, uint8_t count, bool strict,
+                           const uint8_t *next, const uint8_t *end) {
+  if (vm->stack_top - vm->stack < count) {
+    return vm_error(vm, KRONOS_ERR_RUNTIME, "Stack underflow");
+  }
+  const char *parts[UINT8_MAX];
+  size_t lengths[UINT8_MAX];
+  // Numbers are formatted back to back; the final slack lets the last one
+  // use the full 64 bytes value_string_form() may write
+  char forms[UINT8_MAX * NUMBER_FORM_MAX + 64];
+  size_t used = 0;
+
+  Value *base = vm->stack_top - count;
+  bool in_place = count > 1 && vm_concat_in_place(vm, base[0], next, end);
+  for (uint8_t i = 0; i < count; i++) {
+    Value val = base[i];
+    if (strict && !IS_STRING(val) && !IS_NUMBER(val) && !IS_BOOL(val) &&
+        !IS_NIL(val)) {
+      return vm_error(vm, KRONOS_ERR_RUNTIME, "Cannot convert type to string");
+    }
+    parts[i] = value_string_form(val, forms + used, &lengths[i]);
+    if (parts[i] == forms + used)
+      used += lengths[i];
+    if (i > 0 && val == base[0])
+      in_place = false; // Appending would read the bytes being extended
+  }
 
-      value_release(container);
-      value_release(start_val);
-      value_release(end_val);
-      break;
+  Value result;
+  if (in_place &&
+      value_string_append_parts(AS_OBJ(base[0]), parts + 1, lengths + 1,
+                                count - 1u)) {
+    result = base[0];
+    val_retain(result);
+  } else {
+    KronosValue *joined = value_new_string_parts(parts, lengths, count);
+    if (!joined) {
+      return vm_error(vm, KRONOS_ERR_INTERNAL,
+                      "Failed to create string value");
     }
+    result = OBJ_VAL(joined);
+  }
+  while (vm->stack_top > base)
+    val_release(*--vm->stack_top);
+  *vm->stack_top++ = result;
+  return 0;
+}
 
-    case OP_LIST_ITER: {
-      KronosValue *list = pop(vm);
-      if (!list) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Report a numeric comparison on non-numbers (releases both operands)
+static int vm_compare_error(KronosVM *vm, Value a, Value b,
+                            const char *symbol) {
+  int err = vm_errorf(vm, KRONOS_ERR_RUNTIME,
+                      "Cannot perform '%s' - both values must be numbers",
+                      symbol);
+  val_release(a);
+  val_release(b);
+  return err;
+}
 
-      if (list->type != VAL_LIST) {
-        value_release(list);
-        return vm_error(vm, KRONOS_ERR_RUNTIME, "Expected list for iteration");
-      }
+// True once a range counter has passed end, moving in step's direction
+// (all three must be numbers and step nonzero)
+static inline bool range_past_end(Value counter, Value end, Value step) {
+  if (IS_INT(counter) && IS_INT(end) && IS_INT(step)) {
+    return AS_INT(step) > 0 ? AS_INT(counter) > AS_INT(end)
+                            : AS_INT(counter) < AS_INT(end);
+  }
+  return AS_NUMBER(step) > 0 ? !(AS_NUMBER(counter) <= AS_NUMBER(end))
+                             : !(AS_NUMBER(counter) >= AS_NUMBER(end));
+}
 
-      // Create iterator (just push the list and current index)
-      // For simplicity, we'll use a list value with a special marker
-      // Actually, we need to track iteration state. Let's use a simple
-      // approach: Push list, then push index 0
-      value_retain(list);
-      push(vm, list);
-      KronosValue *index = value_new_number(0);
-      push(vm, index);
-      value_release(index);
-      value_release(list);
-      break;
-    }
+/*
+ * Dispatch: with GCC/Clang every handler ends by jumping straight to the next
+ * handler through a table of label addresses ("computed goto"), so each
+ * opcode gets its own, far more predictable, indirect branch instead of all
+ * sharing the one at the top of a switch. Other compilers, or builds with
+ * -DKRONOS_NO_COMPUTED_GOTO, use the portable switch.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    !defined(KRONOS_NO_COMPUTED_GOTO)
+#define KRONOS_COMPUTED_GOTO 1
+#else
+#define KRONOS_COMPUTED_GOTO 0
+#endif
 
-    case OP_LIST_NEXT: {
-      // Stack: [list, index] (list on bottom, index on top)
-      // Verify stack has at least 2 items before popping
-      size_t stack_depth = (size_t)(vm->stack_top - vm->stack);
-      if (stack_depth < 2) {
-        return vm_errorf(
-            vm, KRONOS_ERR_RUNTIME,
-            "Stack underflow in list iteration: expected 2 items, got %zu. "
-            "This usually means iterator variables were not loaded correctly.",
-            stack_depth);
-      }
-      KronosValue *index_val = pop(vm);
-      if (!index_val) {
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
-      KronosValue *list = pop(vm);
-      if (!list) {
-        value_release(index_val);
-        return vm_propagate_error(vm, KRONOS_ERR_RUNTIME);
-      }
+// Returned by an interpreter loop when execution must continue in the other
+// loop (a call or return crossed between verified and unverified bytecode)
+#define VM_RUN_SWITCH 1
 
-      if (list->type != VAL_LIST || index_val->type != VAL_NUMBER) {
-        value_release(index_val);
-        value_release(list);
-        return vm_error(vm, KRONOS_ERR_RUNTIME, "Invalid iterator state");
-      }
+#define VM_RUN_NAME vm_run_checked
+#define VM_CHECKED 1
+#include "vm_loop.inc"
 
-      size_t idx = (size_t)index_val->as.number;
-      bool has_more = idx < list->as.list.count;
-
-      if (has_more) {
-        // Push in order: [list, index+1, item, has_more]
-        // This way, after popping has_more, item is on top for OP_STORE_VAR
-        // After storing item, we have [list, index+1] for next iteration
-
-        // Push in order: [list, index+1, item, has_more]
-        // This way, after popping has_more, item is on top for OP_STORE_VAR
-        // After storing item, we have [list, index+1] for next iteration
-
-        // Push list first (bottom of stack)
-        value_retain(list);
-        push(vm, list);
-        value_release(list);
-
-        // Update and push index
-        KronosValue *next_index = value_new_number((double)(idx + 1));
-        push(vm, next_index);
-        value_release(next_index);
-
-        // Push item
-        KronosValue *item = list->as.list.items[idx];
-        value_retain(item);
-        push(vm, item);
-        value_release(item);
-
-        // Push has_more flag (true) on top
-        KronosValue *has_more_val = value_new_bool(true);
-        push(vm, has_more_val);
-        value_release(has_more_val);
-      } else {
-        // No more items - push iterator state back, then has_more flag (false)
-        // Push list back (for cleanup)
-        value_retain(list);
-        push(vm, list);
-        value_release(list);
-
-        // Push index back (for cleanup)
-        value_retain(index_val);
-        push(vm, index_val);
-        value_release(index_val);
-
-        // Push has_more flag (false) on top
-        KronosValue *has_more_val = value_new_bool(false);
-        push(vm, has_more_val);
-        value_release(has_more_val);
-      }
+#define VM_RUN_NAME vm_run_unchecked
+#define VM_CHECKED 0
+#include "vm_loop.inc"
 
-      value_release(index_val);
-      value_release(list);
-      break;
-    }
+/**
+ * @brief Main execution loop
+ *
+ * Reads instructions from vm->bytecode starting at vm->ip and executes them
+ * using a stack-based model. Handles all instruction types including:
+ * - Stack operations (push, pop)
+ * - Variable operations (load, store)
+ * - Arithmetic and comparison operations
+ * - Control flow (jumps, conditionals)
+ * - Function calls and returns
+ * - Built-in function invocations
+ *
+ * Runs the unchecked loop while vm->verified is set and the checked loop
+ * otherwise, switching whenever a call or return changes it.
+ *
+ * @param vm VM instance with bytecode, ip and link state set up
+ * @return 0 on success, negative error code on failure
+ */
+static int vm_run(KronosVM *vm) {
+  int status;
+  do {
+    status = vm->verified ? vm_run_unchecked(vm) : vm_run_checked(vm);
+  } while (status == VM_RUN_SWITCH);
+  return status;
+}
 
-    case OP_HALT: {
-      return 0;
-    }
+// Execute bytecode
+/**
+ * @brief Execute bytecode on the virtual machine
+ *
+ * Links the bytecode's globals and call sites against the VM and verifies it,
+ * then runs it until OP_HALT or an error. Verified bytecode runs in the
+ * unchecked interpreter loop; anything else keeps every runtime check. Dead
+ * lists are reclaimed incrementally during the run and the rest are freed
+ * before returning.
+ *
+ * @param vm VM instance to execute on
+ * @param bytecode Compiled bytecode to execute
+ * @return 0 on success, negative error code on failure
+ */
+int vm_execute(KronosVM *vm, Bytecode *bytecode) {
+  if (!vm) {
+    return -(int)KRONOS_ERR_INVALID_ARGUMENT;
+  }
+  MemAllocator *previous_allocator = vm_use_allocator(vm);
+  if (!bytecode) {
+    int status = vm_error(vm, KRONOS_ERR_INVALID_ARGUMENT,
+                          "vm_execute: bytecode must not be NULL");
+    mem_set_allocator(previous_allocator);
+    return status;
+  }
 
-    default:
-      return vm_errorf(
-          vm, KRONOS_ERR_INTERNAL,
-          "Unknown bytecode instruction: %d (this is a compiler bug)",
-          instruction);
-    }
+  CodeLinks *links;
+  int status = vm_link_code(vm, bytecode, &links);
+  if (status != 0) {
+    mem_set_allocator(previous_allocator);
+    return status;
   }
 
-  return 0;
+  size_t max_stack;
+  vm->bytecode = bytecode;
+  vm->ip = bytecode->code;
+  vm->links = links;
+  vm->verified = bytecode_verify(bytecode, 0, false, &max_stack, NULL) &&
+                 vm_stack_room(vm) >= max_stack;
+
+  // Budget 0 turns deferred reclamation off
+  ReclaimQueue *previous =
+      value_set_reclaim_queue(vm->reclaim.budget > 0 ? &vm->reclaim : NULL);
+  GCBudget *previous_budget = gc_set_budget(&vm->memory);
+  vm->memory.exceeded = false;
+  status = vm_run(vm);
+  value_reclaim(&vm->reclaim, SIZE_MAX);
+  gc_set_budget(previous_budget);
+  value_set_reclaim_queue(previous);
+
+  // Functions defined by this bytecode hold their own references
+  vm->links = NULL;
+  vm->verified = false;
+  code_links_release(links);
+  mem_set_allocator(previous_allocator);
+  return status;
 }
@@ -3,70 +3,136 @@
 
 #include "../../include/kronos.h"
 #include "../compiler/compiler.h"
+#include "../core/gc.h"
+#include "../core/memory.h"
 #include "../core/runtime.h"
 #include <stdbool.h>
 #include <stddef.h>
 
 #define STACK_MAX 1024
-#define GLOBALS_MAX 256
-#define FUNCTIONS_MAX 128
 #define CALL_STACK_MAX 256
-#define LOCALS_MAX 64
+// Default steps per deferred reclamation slice (kronos_set_reclaim_budget)
+#define VM_RECLAIM_BUDGET 1024
 
-// Function definition
+struct Function;
+
+// Resolution cached for one OP_CALL_FUNC site (keyed by its name constant)
+typedef struct {
+  struct Function *function; // Resolved user function (NULL for built-ins)
+  int builtin;               // BuiltinId, or -1 for user functions
+  uint32_t epoch;            // KronosVM.function_epoch when resolved
+} CallCache;
+
+// VM-side link state for one compiled Bytecode, shared (refcounted) by its
+// top-level run and every function it defines
 typedef struct {
+  uint32_t *global_links; // VM global slot per Bytecode.globals entry
+  CallCache *call_cache;  // One entry per constant (const_count entries)
+  Value *constants;       // val_unbox() of each constant (borrowed)
+  size_t refcount;
+} CodeLinks;
+
+// Function definition
+typedef struct Function {
   char *name;
   char **params;
   size_t param_count;
+  // Frame slot names, parameters first (NULL for hidden loop state). Entries
+  // are borrowed from params and the constant pool; only the array is owned.
+  const char **local_names;
+  size_t local_count;
+  uint32_t hash;      // string_hash() of name, set by vm_define_function
+  CodeLinks *links;   // Link state of the defining bytecode (retained)
+  // Set by vm_define_function when the body passes bytecode_verify(); the
+  // body then runs in the unchecked loop whenever max_stack slots are free
+  bool verified;
+  size_t max_stack;
   Bytecode bytecode; // Full bytecode structure
 } Function;
 
+// Global variable entry; its index in KronosVM.globals never changes
+typedef struct {
+  const char *name;         // Bytes of name_string
+  KronosValue *name_string; // Interned name (the entry holds a reference)
+  uint32_t hash;
+  Value value;        // EMPTY_VAL while referenced but never assigned
+  KronosValue *boxed; // Lazily boxed copy handed out by vm_get_global
+  bool is_mutable;
+  char *type_name; // NULL if no type restriction
+} GlobalVar;
+
 // Call frame for function calls
 typedef struct {
   Function *function;
   uint8_t *return_ip;        // Where to return to
   Bytecode *return_bytecode; // Which bytecode to return to
-  KronosValue **frame_start; // Start of this frame's stack
+  CodeLinks *return_links;   // Link state of return_bytecode
+  bool return_verified;      // Whether return_bytecode runs unchecked
+  Value *frame_start;        // Start of this frame's stack
 
-  // Local variables (includes parameters)
+  // Local variable slots (parameters first), indexed by OP_LOAD_LOCAL and
+  // OP_STORE_LOCAL; names live in function->local_names
   struct {
-    char *name;
-    KronosValue *value;
+    Value value;           // EMPTY_VAL until first assigned in this call
     bool is_mutable;
-    char *type_name; // NULL if no type restriction
+    const char *type_name; // NULL if no type restriction (borrowed)
   } locals[LOCALS_MAX];
   size_t local_count;
 } CallFrame;
 
 // Virtual machine state
 typedef struct KronosVM {
-  // Value stack
-  KronosValue *stack[STACK_MAX];
-  KronosValue **stack_top;
+  // Value stack (tagged values; see Value in runtime.h)
+  Value stack[STACK_MAX];
+  Value *stack_top;
 
   // Call stack
   CallFrame call_stack[CALL_STACK_MAX];
   size_t call_stack_size;
   CallFrame *current_frame;
 
-  // Global variables
-  struct {
-    char *name;
-    KronosValue *value;
-    bool is_mutable;
-    char *type_name; // NULL if no type restriction
-  } globals[GLOBALS_MAX];
+  // Global variables: growable array of stable slots plus an open-addressing
+  // hash index from name to slot (bucket holds slot + 1, 0 when empty)
+  GlobalVar *globals;
   size_t global_count;
+  size_t global_capacity;
+  uint32_t *global_index;
+  size_t global_index_capacity; // Power of two
 
-  // Functions
-  Function *functions[FUNCTIONS_MAX];
+  // Functions: open-addressing hash table keyed by name (NULL when empty)
+  Function **functions;
   size_t function_count;
+  size_t function_capacity; // Power of two
+  // Definitions replaced by a later vm_define_function that a call frame was
+  // still executing. Swept on each redefinition and return (see
+  // vm_sweep_retired_functions); vm_free frees whatever is left.
+  Function **retired_functions;
+  size_t retired_count;
+  size_t retired_capacity;
+  // Bumped whenever a definition is replaced; invalidates CallCache entries
+  uint32_t function_epoch;
 
   // Instruction pointer
   uint8_t *ip;
 
-  // Current bytecode
+  // Current bytecode and its link state
   Bytecode *bytecode;
+  CodeLinks *links;
+  // true while the current bytecode is verified and has stack room, so the
+  // unchecked interpreter loop runs it
+  bool verified;
+
+  // Dead lists freed in slices of reclaim.budget steps at backward jumps and
+  // allocations while this VM runs; drained when vm_execute returns
+  ReclaimQueue reclaim;
+
+  // Heap budget charged by values allocated while this VM runs; an
+  // allocation it refuses fails the run with "memory limit exceeded"
+  GCBudget memory;
+
+  // Allocator of everything the VM owns: a reference to the creating
+  // thread's current one (NULL: the C library)
+  MemAllocator *allocator;
 
   // Error tracking
   char *last_error_message;
@@ -85,7 +151,9 @@ typedef struct KronosVM {
  * @brief Create a new Kronos virtual machine instance.
  *
  * Allocates and initializes a new VM with empty stacks, no variables, and no
- * functions. The Pi constant is pre-initialized as an immutable global.
+ * functions. The Pi constant is pre-initialized as an immutable global. The
+ * VM allocates through the calling thread's current allocator (see
+ * mem_set_allocator()) for its whole lifetime.
  *
  * @return Pointer to new VM on success, NULL on allocation failure.
  * @note Caller must call vm_free() to release resources.
@@ -104,6 +172,19 @@ KronosVM *vm_new(void);
  */
 void vm_free(KronosVM *vm);
 
+/**
+ * @brief Make a VM's allocator current on the calling thread.
+ *
+ * Everything a VM owns must be allocated and freed under its allocator.
+ * vm_new(), vm_free() and vm_execute() switch to it themselves; wrap other
+ * calls that allocate on the VM's behalf (tokenizing, parsing, compiling,
+ * setting globals or errors) in this call.
+ *
+ * @param vm VM whose allocator to use (must not be NULL).
+ * @return The previous allocator, to restore with mem_set_allocator().
+ */
+MemAllocator *vm_use_allocator(KronosVM *vm);
+
 /**
  * @brief Execute compiled bytecode in the VM.
  *
@@ -146,6 +227,9 @@ int vm_set_global(KronosVM *vm, const char *name, KronosValue *value,
 /**
  * @brief Get a global variable from the VM.
  *
+ * Numbers, booleans and nil are stored unboxed; for those the VM keeps a
+ * boxed copy alive until the global is reassigned or the VM is freed.
+ *
  * @param vm VM instance (must not be NULL).
  * @param name Variable name to look up (must not be NULL).
  * @return Pointer to the value if found, NULL if not found.
@@ -161,34 +245,36 @@ KronosValue *vm_get_global(KronosVM *vm, const char *name);
  *
  * Similar to vm_set_global but operates on function-local variables.
  * Checks mutability and type constraints if the variable already exists.
+ * Locals live in the frame slots laid out by the compiler, so @p name must be
+ * one of the frame function's parameters or assigned names.
  *
  * @param vm VM instance for error reporting (must not be NULL).
  * @param frame Call frame (must not be NULL).
- * @param name Variable name (copied internally via strdup, caller retains
- * ownership).
+ * @param name Variable name (not retained).
  * @param value Value to store. On success the frame retains the value
- * (increments refcount); on failure, ownership stays with the caller.
+ * (increments refcount of heap objects); on failure, ownership stays with the
+ * caller.
  * @param is_mutable true for mutable (let), false for immutable (set).
- * @param type_name Type constraint or NULL (copied internally via strdup if
- * non-NULL; ownership stays with caller on failure).
- * @return 0 on success, negative KronosErrorCode on failure.
+ * @param type_name Type constraint or NULL. Not copied: it must stay valid
+ * until the frame returns (constant pool strings do).
+ * @return 0 on success, negative KronosErrorCode on failure
+ * (KRONOS_ERR_NOT_FOUND if the function has no slot named @p name).
  * @note Thread-safety: VM is NOT thread-safe. Caller must synchronize access.
  */
 int vm_set_local(KronosVM *vm, CallFrame *frame, const char *name,
-                 KronosValue *value, bool is_mutable, const char *type_name);
+                 Value value, bool is_mutable, const char *type_name);
 
 /**
  * @brief Get a local variable from a call frame.
  *
  * @param frame Call frame (must not be NULL).
  * @param name Variable name to look up (must not be NULL).
- * @return Pointer to the value if found, NULL if not found.
- * @note Returned value is NOT owned by caller (do not free). It remains in the
- * frame.
- * @note To use the value beyond the current scope, call value_retain().
+ * @return The value if found, EMPTY_VAL if not found.
+ * @note Returned value is NOT owned by caller. It remains in the frame.
+ * @note To use the value beyond the current scope, call val_retain().
  * @note Thread-safety: VM is NOT thread-safe. Caller must synchronize access.
  */
-KronosValue *vm_get_local(CallFrame *frame, const char *name);
+Value vm_get_local(CallFrame *frame, const char *name);
 
 /**
  * @brief Get a variable by name, checking local scope first, then global.
@@ -198,24 +284,26 @@ KronosValue *vm_get_local(CallFrame *frame, const char *name);
  *
  * @param vm VM instance (must not be NULL).
  * @param name Variable name to look up (must not be NULL).
- * @return Pointer to the value if found, NULL if not found in either scope.
- * @note Returned value is NOT owned by caller (do not free).
- * @note To use the value beyond the current scope, call value_retain().
+ * @return The value if found, EMPTY_VAL if not found in either scope.
+ * @note Returned value is NOT owned by caller.
+ * @note To use the value beyond the current scope, call val_retain().
  * @note Thread-safety: VM is NOT thread-safe. Caller must synchronize access.
  */
-KronosValue *vm_get_variable(KronosVM *vm, const char *name);
+Value vm_get_variable(KronosVM *vm, const char *name);
 
 /**
  * @brief Define a new function in the VM.
  *
  * Registers a function so it can be called by name. If a function with the
- * same name exists, it is replaced (no error).
+ * same name exists, it is replaced (no error): call sites that cached the old
+ * definition re-resolve, and the old Function stays allocated until vm_free()
+ * in case a running frame still uses it.
  *
  * @param vm VM instance (must not be NULL).
  * @param func Function to register. On success the VM takes ownership; on
  * failure, the caller retains ownership and must free the Function.
- * @return 0 on success, negative error code on failure (e.g., -ENOSPC if the
- * function table is full, -EINVAL for invalid arguments).
+ * @return 0 on success, negative KronosErrorCode on failure (invalid
+ * arguments or allocation failure).
  * @note Thread-safety: VM is NOT thread-safe. Caller must synchronize access.
  */
 int vm_define_function(KronosVM *vm, Function *func);
@@ -335,7 +423,7 @@ int vm_errorf(KronosVM *vm, KronosErrorCode code, const char *fmt, ...);
  * calling, the VM has no recorded error.
  *
  * @param vm VM instance (may be NULL, in which case this is a no-op).
- * @note Frees the stored error message (if any) via free().
+ * @note Frees the stored error message (if any) via mem_free().
  * @note Resets vm->last_error_code to KRONOS_OK.
  * @note Does not invoke the error callback.
  * @note Thread-safety: NOT thread-safe. Caller must synchronize access.
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Kronos Benchmarks
+# Reports the best wall time of each tests/bench/*.kr script for one or more
+# interpreter binaries, so a change can be compared against an older build:
+#
+#   tests/bench/run_bench.sh                     # ./kronos
+#   tests/bench/run_bench.sh /tmp/old/kronos ./kronos
+#
+# BENCH_RUNS sets how many runs each best-of time is taken over (default 3).
+
+runs=${BENCH_RUNS:-3}
+bench_dir=$(dirname "$0")
+binaries=("$@")
+if [ ${#binaries[@]} -eq 0 ]; then
+    binaries=(./kronos)
+fi
+
+for binary in "${binaries[@]}"; do
+    if [ ! -x "$binary" ]; then
+        echo "Not an executable: $binary" >&2
+        exit 1
+    fi
+done
+
+printf "%-14s" "script"
+for binary in "${binaries[@]}"; do
+    printf "%16s" "$binary"
+done
+echo ""
+
+for script in "$bench_dir"/*.kr; do
+    printf "%-14s" "$(basename "$script")"
+    for binary in "${binaries[@]}"; do
+        best=""
+        for ((run = 0; run < runs; run++)); do
+            start=$(date +%s%N)
+            if ! "$binary" "$script" > /dev/null; then
+                echo ""
+                echo "$binary failed on $script" >&2
+                exit 1
+            fi
+            end=$(date +%s%N)
+            ms=$(( (end - start) / 1000000 ))
+            if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+                best=$ms
+            fi
+        done
+        printf "%14sms" "$best"
+    done
+    echo ""
+done
@@ -103,7 +103,7 @@ void test_run(const char *name, TestFunc func, const char *file);
     double _diff = (_a > _b) ? (_a - _b) : (_b - _a);                          \
     if (_diff > 0.0001) {                                                      \
       char msg[256];                                                           \
-      snprintf(msg, sizeof(msg), "Expected %s == %s, got %.6f != %.6f", #a,    \
+      snprintf(msg, sizeof(msg), "Expected %s == %s, got %.10g != %.10g", #a,  \
                #b, _a, _b);                                                    \
       test_fail(__FILE__, __LINE__, msg);                                      \
       return;                                                                  \
@@ -126,6 +126,149 @@ TEST(compile_function_definition) {
     ast_free(ast);
 }
 
+TEST(compile_function_locals_use_slots) {
+    AST *ast = parse_string("function f with x:\n    let y to x plus 1\n    return y");
+    ASSERT_PTR_NOT_NULL(ast);
+
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    // Parameters and locals are addressed by slot, not by name
+    bool has_load_local = false;
+    bool has_store_local = false;
+    for (size_t i = 0; i < bytecode->count; i++) {
+        if (bytecode->code[i] == OP_LOAD_LOCAL) {
+            has_load_local = true;
+        } else if (bytecode->code[i] == OP_STORE_LOCAL) {
+            has_store_local = true;
+        }
+    }
+    ASSERT_TRUE(has_load_local);
+    ASSERT_TRUE(has_store_local);
+
+    bytecode_free(bytecode);
+    ast_free(ast);
+}
+
+TEST(compile_globals_share_one_entry) {
+    AST *ast = parse_string("let x to 1\nlet x to x plus 1\nprint x\nset y to x");
+    ASSERT_PTR_NOT_NULL(ast);
+
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    // Every reference to 'x' resolves to the same global table entry
+    ASSERT_INT_EQ(bytecode->global_count, 2);
+    ASSERT_STR_EQ(bytecode->constants[bytecode->globals[0]]->as.string.data, "x");
+    ASSERT_STR_EQ(bytecode->constants[bytecode->globals[1]]->as.string.data, "y");
+
+    bytecode_free(bytecode);
+    ast_free(ast);
+}
+
+TEST(builtin_lookup_ids) {
+    ASSERT_INT_EQ(builtin_lookup("sqrt"), BUILTIN_SQRT);
+    ASSERT_INT_EQ(builtin_lookup("math.sqrt"), BUILTIN_SQRT);
+    ASSERT_INT_EQ(builtin_lookup("sort"), BUILTIN_SORT);
+    ASSERT_INT_EQ(builtin_lookup("my_function"), -1);
+    ASSERT_INT_EQ(builtin_lookup("strings.len"), -1);
+    ASSERT_STR_EQ(builtin_name(BUILTIN_READ_FILE), "read_file");
+}
+
+TEST(compile_builtin_call_uses_id) {
+    AST *ast = parse_string("set x to call math.sqrt with 16\nset y to call mine with x");
+    ASSERT_PTR_NOT_NULL(ast);
+
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    // Arguments are constants, so the first call follows LOAD_CONST <idx:2>
+    ASSERT_INT_EQ(bytecode->code[3], OP_CALL_BUILTIN);
+    ASSERT_INT_EQ(bytecode->code[4], BUILTIN_SQRT);
+    ASSERT_INT_EQ(bytecode->code[5], 1);
+
+    // User functions are still called by name
+    bool has_call_func = false;
+    for (size_t i = 6; i < bytecode->count; i++) {
+        if (bytecode->code[i] == OP_CALL_FUNC) {
+            has_call_func = true;
+            break;
+        }
+    }
+    ASSERT_TRUE(has_call_func);
+
+    bytecode_free(bytecode);
+    ast_free(ast);
+}
+
+TEST(compile_superinstructions) {
+    AST *ast = parse_string(
+        "let i to 0\n"
+        "while i is less than 3:\n"
+        "    let i to i plus 1\n"
+        "print i minus 1");
+    ASSERT_PTR_NOT_NULL(ast);
+
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    // 0: LOAD_CONST, 3: STORE_GLOBAL, 8: LOAD_GLOBAL, 11: LOAD_CONST
+    ASSERT_INT_EQ(bytecode->code[8], OP_LOAD_GLOBAL);
+    ASSERT_INT_EQ(bytecode->code[11], OP_LOAD_CONST);
+    // The comparison and branch are one instruction...
+    ASSERT_INT_EQ(bytecode->code[14], OP_JUMP_IF_NOT_LT);
+    // ...and so is the increment
+    ASSERT_INT_EQ(bytecode->code[16], OP_INC_GLOBAL);
+    ASSERT_INT_EQ(bytecode->code[21], OP_JUMP);
+    // Constant right operands are folded into the arithmetic
+    ASSERT_INT_EQ(bytecode->code[23], OP_LOAD_GLOBAL);
+    ASSERT_INT_EQ(bytecode->code[26], OP_SUB_CONST);
+    ASSERT_INT_EQ(bytecode->code[29], OP_PRINT);
+
+    bytecode_free(bytecode);
+    ast_free(ast);
+}
+
+TEST(compile_counted_range_loop) {
+    // The body leaves the variable alone: a counted loop
+    AST *ast = parse_string("for i in range 1 to 10 by 2:\n    print i");
+    ASSERT_PTR_NOT_NULL(ast);
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    // 0, 3, 6: LOAD_CONST start, end and step (evaluated once)
+    ASSERT_INT_EQ(bytecode->code[9], OP_RANGE_ITER);
+    ASSERT_INT_EQ(bytecode->code[10], OP_RANGE_NEXT);
+    ASSERT_INT_EQ(bytecode->code[12], OP_STORE_GLOBAL);
+    bytecode_free(bytecode);
+    ast_free(ast);
+
+    // The body assigns the variable: it stays the counter
+    ast = parse_string("for i in range 1 to 10:\n    let i to i plus 3");
+    ASSERT_PTR_NOT_NULL(ast);
+    bytecode = compile(ast, &err);
+    ASSERT_PTR_NULL(err);
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(bytecode->code[0], OP_LOAD_CONST);
+    ASSERT_INT_EQ(bytecode->code[3], OP_STORE_GLOBAL);
+    ASSERT_INT_EQ(bytecode->code[8], OP_LOAD_GLOBAL);
+    for (size_t i = 0; i < bytecode->count; i++) {
+        ASSERT_NE(bytecode->code[i], OP_RANGE_NEXT);
+    }
+    bytecode_free(bytecode);
+    ast_free(ast);
+}
+
 TEST(compile_list_literal) {
     AST *ast = parse_string("set mylist to list 1, 2, 3");
     ASSERT_PTR_NOT_NULL(ast);
@@ -1,6 +1,8 @@
 #include "../framework/test_framework.h"
 #include "../../src/core/runtime.h"
 #include <math.h>
+#include <pthread.h>
+#include <string.h>
 
 TEST(value_new_number) {
     KronosValue *val = value_new_number(42.5);
@@ -49,8 +51,62 @@ TEST(value_new_nil) {
     value_release(val);
 }
 
+TEST(value_immortal_singletons) {
+    // nil, booleans and small integers are shared and never counted
+    ASSERT_EQ(value_new_nil(), value_new_nil());
+    ASSERT_EQ(value_new_bool(true), value_new_bool(true));
+    ASSERT_EQ(value_new_number(7), value_new_number(7.0));
+    ASSERT_EQ(value_new_number(VALUE_SMALL_INT_MIN),
+                  value_new_number(VALUE_SMALL_INT_MIN));
+
+    KronosValue *seven = value_new_number(7);
+    ASSERT_TRUE(seven->flags & VALUE_FLAG_IMMORTAL);
+    value_retain(seven);
+    ASSERT_INT_EQ(seven->refcount, 1);
+    value_release(seven);
+    value_release(seven);
+    ASSERT_DOUBLE_EQ(value_new_number(7)->as.number, 7.0);
+
+    // Other numbers (including -0 and values past the cache) are allocated
+    KronosValue *neg_zero = value_new_number(-0.0);
+    ASSERT_TRUE(signbit(neg_zero->as.number));
+    ASSERT_FALSE(neg_zero->flags & VALUE_FLAG_IMMORTAL);
+    KronosValue *big = value_new_number(VALUE_SMALL_INT_MAX + 1);
+    ASSERT_FALSE(big->flags & VALUE_FLAG_IMMORTAL);
+    value_release(neg_zero);
+    value_release(big);
+}
+
+TEST(value_short_and_char_strings) {
+    // Empty and single-byte strings are shared immortal instances
+    KronosValue *a = value_new_string("a", 1);
+    ASSERT_EQ(a, value_new_char('a'));
+    ASSERT_TRUE(a->flags & VALUE_FLAG_IMMORTAL);
+    ASSERT_STR_EQ(a->as.string.data, "a");
+    ASSERT_INT_EQ(a->as.string.hash, string_hash("a", 1));
+    ASSERT_EQ(value_new_string("", 0), value_new_string("", 0));
+    ASSERT_INT_EQ(value_new_char(0)->as.string.length, 1);
+
+    // Short strings keep their bytes inline, long ones in a separate buffer
+    KronosValue *short_str = value_new_string("hello", 5);
+    ASSERT_TRUE(short_str->flags & VALUE_FLAG_INLINE);
+    ASSERT_EQ(short_str->as.string.data, (char *)(short_str + 1));
+    ASSERT_STR_EQ(short_str->as.string.data, "hello");
+
+    char long_text[301];
+    memset(long_text, 'x', 300);
+    long_text[300] = '\0';
+    KronosValue *long_str = value_new_string(long_text, 300);
+    ASSERT_FALSE(long_str->flags & VALUE_FLAG_INLINE);
+    ASSERT_INT_EQ(memcmp(long_str->as.string.data, long_text, 301), 0);
+    ASSERT_TRUE(value_equals(long_str, long_str));
+
+    value_release(short_str);
+    value_release(long_str);
+}
+
 TEST(value_retain_release) {
-    KronosValue *val = value_new_number(10);
+    KronosValue *val = value_new_number(10.5);
     ASSERT_INT_EQ(val->refcount, 1);
 
     value_retain(val);
@@ -264,12 +320,73 @@ TEST(string_intern) {
     KronosValue *val2 = string_intern("test", 4);
     ASSERT_PTR_NOT_NULL(val2);
     // Should be the same pointer (interning)
-    ASSERT_TRUE(val1 == val2 || value_equals(val1, val2));
+    ASSERT_EQ(val1, val2);
+    ASSERT_TRUE(val1->flags & VALUE_FLAG_INTERNED);
+
+    // Equal content still compares equal to an uninterned copy
+    KronosValue *copy = value_new_string("test", 4);
+    ASSERT_TRUE(value_equals(val1, copy));
+    ASSERT_FALSE(copy->flags & VALUE_FLAG_INTERNED);
+    value_release(copy);
 
     value_release(val1);
     value_release(val2);
 }
 
+TEST(string_intern_grows) {
+    // Far more names than the table's initial capacity
+    enum { COUNT = 5000 };
+    static KronosValue *names[COUNT];
+    char buf[32];
+    for (int i = 0; i < COUNT; i++) {
+        int len = snprintf(buf, sizeof(buf), "name_%d", i);
+        names[i] = string_intern(buf, (size_t)len);
+        ASSERT_PTR_NOT_NULL(names[i]);
+        ASSERT_TRUE(names[i]->flags & VALUE_FLAG_INTERNED);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        int len = snprintf(buf, sizeof(buf), "name_%d", i);
+        KronosValue *again = string_intern(buf, (size_t)len);
+        ASSERT_EQ(again, names[i]);
+        value_release(again);
+    }
+    ASSERT_FALSE(value_equals(names[0], names[1]));
+    for (int i = 0; i < COUNT; i++)
+        value_release(names[i]);
+}
+
+// Retain and release an interned string many times, as a VM on its own
+// thread does with the constants it shares with other VMs
+static void *intern_churn_thread(void *arg) {
+    for (int i = 0; i < 100000; i++) {
+        KronosValue *name = string_intern("shared_name", 11);
+        value_retain(name);
+        value_release(name);
+        value_release(name);
+    }
+    (void)arg;
+    return NULL;
+}
+
+TEST(string_intern_shared_between_threads) {
+    KronosValue *name = string_intern("shared_name", 11);
+    ASSERT_PTR_NOT_NULL(name);
+    ASSERT_TRUE(name->flags & VALUE_FLAG_SHARED);
+    uint32_t refcount = name->refcount;
+
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++)
+        ASSERT_INT_EQ(pthread_create(&threads[i], NULL, intern_churn_thread,
+                                     NULL),
+                      0);
+    for (int i = 0; i < 4; i++)
+        pthread_join(threads[i], NULL);
+
+    // No update was lost, so the table's reference is still there
+    ASSERT_INT_EQ(name->refcount, refcount);
+    value_release(name);
+}
+
 TEST(value_new_function) {
     uint8_t bytecode[] = {1, 2, 3};
     KronosValue *func = value_new_function(bytecode, 3, 2);
@@ -287,3 +404,240 @@ TEST(value_new_function_null_bytecode) {
     ASSERT_PTR_NULL(func);
 }
 
+
+TEST(tagged_value_immediates) {
+    Value num = NUMBER_VAL(42.5);
+    ASSERT_TRUE(IS_NUMBER(num));
+    ASSERT_FALSE(IS_OBJ(num));
+    ASSERT_DOUBLE_EQ(AS_NUMBER(num), 42.5);
+    ASSERT_INT_EQ(val_type(num), VAL_NUMBER);
+
+    ASSERT_TRUE(IS_BOOL(TRUE_VAL));
+    ASSERT_TRUE(IS_BOOL(FALSE_VAL));
+    ASSERT_TRUE(AS_BOOL(TRUE_VAL));
+    ASSERT_FALSE(AS_BOOL(FALSE_VAL));
+    ASSERT_FALSE(IS_NUMBER(TRUE_VAL));
+
+    ASSERT_TRUE(IS_NIL(NIL_VAL));
+    ASSERT_FALSE(IS_BOOL(NIL_VAL));
+    ASSERT_FALSE(IS_EMPTY(NIL_VAL));
+    ASSERT_INT_EQ(val_type(NIL_VAL), VAL_NIL);
+
+    // NaN must stay a number and never alias a tag
+    Value nan_val = NUMBER_VAL(NAN);
+    ASSERT_TRUE(IS_NUMBER(nan_val));
+    ASSERT_FALSE(IS_OBJ(nan_val));
+    Value neg_nan = NUMBER_VAL(-NAN);
+    ASSERT_TRUE(IS_NUMBER(neg_nan));
+}
+
+TEST(tagged_value_integers) {
+    // NUMBER_VAL gives integral numbers the integer form
+    Value seven = NUMBER_VAL(7.0);
+    ASSERT_TRUE(IS_INT(seven));
+    ASSERT_TRUE(IS_NUMBER(seven));
+    ASSERT_FALSE(IS_OBJ(seven));
+    ASSERT_EQ(seven, INT_VAL(7));
+    ASSERT_DOUBLE_EQ(AS_NUMBER(seven), 7.0);
+    ASSERT_INT_EQ(AS_INT(NUMBER_VAL(-3)), -3);
+    ASSERT_EQ(NUMBER_VAL((double)VALUE_INT_MIN), INT_VAL(VALUE_INT_MIN));
+    ASSERT_FALSE(IS_INT(NUMBER_VAL(2.5)));
+    ASSERT_FALSE(IS_INT(NUMBER_VAL(-0.0)));
+    ASSERT_FALSE(IS_INT(NUMBER_VAL((double)VALUE_INT_MAX + 1)));
+    ASSERT_FALSE(IS_INT(NIL_VAL));
+    ASSERT_FALSE(IS_INT(TRUE_VAL));
+    ASSERT_FALSE(IS_INT(EMPTY_VAL));
+
+    // Overflow leaves the integer range and gives the double result
+    Value max = INT_VAL(VALUE_INT_MAX);
+    Value sum = val_number_add(max, INT_VAL(1));
+    ASSERT_FALSE(IS_INT(sum));
+    ASSERT_DOUBLE_EQ(AS_NUMBER(sum), (double)VALUE_INT_MAX + 1);
+    Value product = val_number_mul(max, max);
+    ASSERT_DOUBLE_EQ(AS_NUMBER(product), (double)VALUE_INT_MAX * VALUE_INT_MAX);
+    ASSERT_EQ(val_number_sub(INT_VAL(5), INT_VAL(8)), INT_VAL(-3));
+    ASSERT_EQ(val_number_mul(INT_VAL(-4), INT_VAL(6)), INT_VAL(-24));
+    ASSERT_EQ(val_number_add(INT_VAL(1), NUMBER_VAL(0.5)), NUMBER_VAL(1.5));
+    Value whole = val_number_add(NUMBER_VAL(0.5), NUMBER_VAL(0.5));
+    ASSERT_TRUE(val_equals(whole, INT_VAL(1)));
+
+    // 0 times a negative number is -0, as with doubles
+    Value neg_zero = val_number_mul(INT_VAL(0), INT_VAL(-5));
+    ASSERT_FALSE(IS_INT(neg_zero));
+    ASSERT_TRUE(signbit(AS_NUMBER(neg_zero)));
+
+    ASSERT_TRUE(val_equals(INT_VAL(3), NUMBER_VAL(3.0)));
+    KronosValue *boxed = val_box(INT_VAL(1 << 20));
+    ASSERT_PTR_NOT_NULL(boxed);
+    ASSERT_EQ(val_unbox(boxed), INT_VAL(1 << 20));
+    value_release(boxed);
+    boxed = val_box(NUMBER_VAL(0.25));
+    ASSERT_PTR_NOT_NULL(boxed);
+    ASSERT_EQ(val_unbox(boxed), NUMBER_VAL(0.25));
+    value_release(boxed);
+}
+
+TEST(tagged_value_objects) {
+    KronosValue *str = value_new_string("hi", 2);
+    ASSERT_PTR_NOT_NULL(str);
+    Value v = OBJ_VAL(str);
+    ASSERT_TRUE(IS_OBJ(v));
+    ASSERT_TRUE(IS_STRING(v));
+    ASSERT_FALSE(IS_NUMBER(v));
+    ASSERT_TRUE(AS_OBJ(v) == str);
+
+    val_retain(v);
+    ASSERT_INT_EQ(str->refcount, 2);
+    val_release(v);
+    ASSERT_INT_EQ(str->refcount, 1);
+
+    // Retain/release are no-ops for immediates
+    val_retain(NUMBER_VAL(1));
+    val_release(TRUE_VAL);
+
+    value_release(str);
+}
+
+TEST(tagged_value_box_unbox) {
+    KronosValue *boxed = val_box(NUMBER_VAL(7));
+    ASSERT_PTR_NOT_NULL(boxed);
+    ASSERT_INT_EQ(boxed->type, VAL_NUMBER);
+    ASSERT_DOUBLE_EQ(boxed->as.number, 7.0);
+
+    Value unboxed = val_unbox(boxed);
+    ASSERT_TRUE(IS_NUMBER(unboxed));
+    ASSERT_DOUBLE_EQ(AS_NUMBER(unboxed), 7.0);
+    value_release(boxed);
+
+    KronosValue *b = value_new_bool(true);
+    ASSERT_TRUE(val_unbox(b) == TRUE_VAL);
+    value_release(b);
+
+    ASSERT_TRUE(val_unbox(NULL) == NIL_VAL);
+}
+
+TEST(tagged_value_list_items) {
+    KronosValue *list = value_new_list(1);
+    ASSERT_PTR_NOT_NULL(list);
+    KronosValue *str = value_new_string("xy", 2);
+    ASSERT_PTR_NOT_NULL(str);
+
+    ASSERT_TRUE(value_list_append(list, NUMBER_VAL(1)));
+    ASSERT_TRUE(value_list_append(list, OBJ_VAL(str)));
+    ASSERT_TRUE(value_list_append(list, NIL_VAL));
+    ASSERT_INT_EQ(list->as.list.count, 3);
+    ASSERT_INT_EQ(str->refcount, 2);
+
+    KronosValue *other = value_new_list(0);
+    ASSERT_PTR_NOT_NULL(other);
+    ASSERT_TRUE(value_list_append(other, NUMBER_VAL(1)));
+    ASSERT_TRUE(value_list_append(other, OBJ_VAL(str)));
+    ASSERT_TRUE(value_list_append(other, NIL_VAL));
+    ASSERT_TRUE(value_equals(list, other));
+
+    value_release(other);
+    value_release(list);
+    ASSERT_INT_EQ(str->refcount, 1);
+    value_release(str);
+}
+
+TEST(value_list_sort_numbers) {
+    KronosValue *list = value_new_list(0);
+    ASSERT_PTR_NOT_NULL(list);
+
+    // Descending run with duplicates and negatives, long enough to partition
+    for (int i = 0; i < 200; i++) {
+        ASSERT_TRUE(value_list_append(list, NUMBER_VAL((i % 50) - 25.5)));
+    }
+    ASSERT_TRUE(value_list_append(list, NUMBER_VAL(-1e300)));
+    ASSERT_TRUE(value_list_sort(list));
+
+    ASSERT_INT_EQ(list->as.list.count, 201);
+    ASSERT_DOUBLE_EQ(AS_NUMBER(list->as.list.items[0]), -1e300);
+    ASSERT_DOUBLE_EQ(AS_NUMBER(list->as.list.items[1]), -25.5);
+    ASSERT_DOUBLE_EQ(AS_NUMBER(list->as.list.items[200]), 23.5);
+    for (size_t i = 1; i < list->as.list.count; i++) {
+        ASSERT_TRUE(AS_NUMBER(list->as.list.items[i - 1]) <=
+                    AS_NUMBER(list->as.list.items[i]));
+    }
+
+    value_release(list);
+
+    // Integers (immediate form) on their own and mixed with doubles
+    const double ints[] = {5, -3, 10, -7, 0, VALUE_INT_MAX, VALUE_INT_MIN};
+    const double ints_sorted[] = {VALUE_INT_MIN, -7, -3, 0, 5, 10,
+                                  VALUE_INT_MAX};
+    list = value_new_list(0);
+    ASSERT_PTR_NOT_NULL(list);
+    for (size_t i = 0; i < 7; i++) {
+        ASSERT_TRUE(value_list_append(list, NUMBER_VAL(ints[i])));
+    }
+    ASSERT_TRUE(IS_INT(list->as.list.items[1]));
+    ASSERT_TRUE(value_list_sort(list));
+    for (size_t i = 0; i < 7; i++) {
+        ASSERT_TRUE(IS_INT(list->as.list.items[i]));
+        ASSERT_DOUBLE_EQ(AS_NUMBER(list->as.list.items[i]), ints_sorted[i]);
+    }
+    value_release(list);
+
+    const double mixed[] = {3, -1, 2, 1.5, -2.5, 0, -7.25, 1e20};
+    const double mixed_sorted[] = {-7.25, -2.5, -1, 0, 1.5, 2, 3, 1e20};
+    list = value_new_list(0);
+    ASSERT_PTR_NOT_NULL(list);
+    for (size_t i = 0; i < 8; i++) {
+        ASSERT_TRUE(value_list_append(list, NUMBER_VAL(mixed[i])));
+    }
+    ASSERT_TRUE(value_list_sort(list));
+    for (size_t i = 0; i < 8; i++) {
+        ASSERT_DOUBLE_EQ(AS_NUMBER(list->as.list.items[i]), mixed_sorted[i]);
+    }
+    value_release(list);
+}
+
+TEST(value_list_sort_strings_and_mixed) {
+    const char *words[] = {"pear", "apple", "app", "", "banana"};
+    KronosValue *list = value_new_list(0);
+    ASSERT_PTR_NOT_NULL(list);
+    for (size_t i = 0; i < 5; i++) {
+        KronosValue *str = value_new_string(words[i], strlen(words[i]));
+        ASSERT_PTR_NOT_NULL(str);
+        ASSERT_TRUE(value_list_append(list, OBJ_VAL(str)));
+        value_release(str);
+    }
+    ASSERT_TRUE(value_list_sort(list));
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[0]), "");
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[1]), "app");
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[2]), "apple");
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[3]), "banana");
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[4]), "pear");
+
+    // Mixed items are rejected without reordering anything
+    ASSERT_TRUE(value_list_append(list, NUMBER_VAL(1)));
+    ASSERT_FALSE(value_list_sort(list));
+    ASSERT_STR_EQ(AS_CSTRING(list->as.list.items[4]), "pear");
+    value_release(list);
+
+    // A single item of any type is already sorted
+    KronosValue *single = value_new_list(1);
+    ASSERT_PTR_NOT_NULL(single);
+    ASSERT_TRUE(value_list_append(single, NIL_VAL));
+    ASSERT_TRUE(value_list_sort(single));
+    value_release(single);
+}
+
+TEST(tagged_value_equals_and_truthy) {
+    ASSERT_TRUE(val_equals(NUMBER_VAL(1.0), NUMBER_VAL(1.0)));
+    ASSERT_FALSE(val_equals(NUMBER_VAL(1.0), TRUE_VAL));
+    ASSERT_TRUE(val_equals(NIL_VAL, NIL_VAL));
+    ASSERT_FALSE(val_equals(NIL_VAL, FALSE_VAL));
+
+    ASSERT_FALSE(val_is_truthy(NUMBER_VAL(0)));
+    ASSERT_TRUE(val_is_truthy(NUMBER_VAL(-2)));
+    ASSERT_FALSE(val_is_truthy(NIL_VAL));
+    ASSERT_FALSE(val_is_truthy(FALSE_VAL));
+
+    ASSERT_TRUE(val_is_type(NUMBER_VAL(3), "number"));
+    ASSERT_TRUE(val_is_type(TRUE_VAL, "boolean"));
+    ASSERT_TRUE(val_is_type(NIL_VAL, "null"));
+    ASSERT_FALSE(val_is_type(NIL_VAL, "number"));
+}
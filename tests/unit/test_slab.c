@@ -0,0 +1,128 @@
+#include "../../src/core/slab.h"
+#include "../framework/test_framework.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Values allocated elsewhere in the run share the size classes, so the tests
+// compare counts before and after rather than absolute numbers.
+
+static SlabClassStats class_stats(size_t size) {
+  SlabStats stats;
+  slab_get_stats(&stats);
+  return stats.classes[(size - 1) / SLAB_GRANULE];
+}
+
+TEST(slab_alloc_free_stats) {
+  enum { COUNT = 100, SIZE = 136 };
+  SlabClassStats before = class_stats(SIZE);
+
+  void *blocks[COUNT];
+  for (int i = 0; i < COUNT; i++) {
+    blocks[i] = slab_alloc(SIZE);
+    ASSERT_PTR_NOT_NULL(blocks[i]);
+    ASSERT_INT_EQ((uintptr_t)blocks[i] % SLAB_GRANULE, 0);
+    memset(blocks[i], i, SIZE);
+  }
+  ASSERT_NE(blocks[0], blocks[1]);
+
+  SlabClassStats during = class_stats(SIZE);
+  ASSERT_INT_EQ(during.slot_size, 144);
+  ASSERT_INT_EQ(during.live_count, before.live_count + COUNT);
+  ASSERT_TRUE(during.slot_count >= during.live_count);
+
+  SlabStats totals;
+  slab_get_stats(&totals);
+  ASSERT_TRUE(totals.occupancy > 0.0 && totals.occupancy <= 1.0);
+  ASSERT_TRUE(totals.fragmentation >= 0.0 && totals.fragmentation < 1.0);
+  ASSERT_INT_EQ(totals.page_bytes, totals.page_count * SLAB_PAGE_SIZE);
+
+  for (int i = 0; i < COUNT; i++)
+    slab_free(blocks[i], SIZE);
+  ASSERT_INT_EQ(class_stats(SIZE).live_count, before.live_count);
+
+  // Freed slots are reused before new ones are carved
+  void *again = slab_alloc(SIZE);
+  ASSERT_EQ(again, blocks[COUNT - 1]);
+  slab_free(again, SIZE);
+
+  // Oversized requests bypass the slabs
+  void *large = slab_alloc(SLAB_MAX_SIZE + 1);
+  ASSERT_PTR_NOT_NULL(large);
+  slab_free(large, SLAB_MAX_SIZE + 1);
+}
+
+TEST(slab_releases_empty_pages) {
+  enum { SIZE = 200 };
+  SlabClassStats before = class_stats(SIZE);
+  void *first = slab_alloc(SIZE);
+  SlabClassStats one = class_stats(SIZE);
+  size_t count = one.slot_count / one.page_count * 4;
+  slab_free(first, SIZE);
+
+  void **blocks = malloc(count * sizeof(void *));
+  ASSERT_PTR_NOT_NULL(blocks);
+
+  for (size_t i = 0; i < count; i++)
+    blocks[i] = slab_alloc(SIZE);
+  ASSERT_TRUE(class_stats(SIZE).page_count >= before.page_count + 3);
+
+  for (size_t i = 0; i < count; i++)
+    slab_free(blocks[i], SIZE);
+
+  // Emptied pages go back to the system, except the current page and a spare
+  SlabClassStats after = class_stats(SIZE);
+  ASSERT_INT_EQ(after.live_count, before.live_count);
+  ASSERT_TRUE(after.page_count <= before.page_count + 2);
+  free(blocks);
+}
+
+enum { ORPHAN_SIZE = 232, ORPHAN_COUNT = 10 };
+
+// Allocate ORPHAN_COUNT blocks and exit without freeing them
+static void *orphan_thread(void *arg) {
+  void **blocks = arg;
+  for (int i = 0; i < ORPHAN_COUNT; i++)
+    blocks[i] = slab_alloc(ORPHAN_SIZE);
+  return NULL;
+}
+
+// Allocate one block from a fresh heap, which adopts the orphaned page
+static void *adopt_thread(void *arg) {
+  SlabClassStats *seen = arg;
+  void *block = slab_alloc(ORPHAN_SIZE);
+  *seen = class_stats(ORPHAN_SIZE);
+  slab_free(block, ORPHAN_SIZE);
+  return NULL;
+}
+
+TEST(slab_cross_thread_free) {
+  SlabClassStats before = class_stats(ORPHAN_SIZE);
+  void *blocks[ORPHAN_COUNT];
+  pthread_t thread;
+  ASSERT_INT_EQ(pthread_create(&thread, NULL, orphan_thread, blocks), 0);
+  ASSERT_INT_EQ(pthread_join(thread, NULL), 0);
+
+  // The thread exited with live blocks, so its page was orphaned
+  SlabClassStats orphaned = class_stats(ORPHAN_SIZE);
+  ASSERT_INT_EQ(orphaned.page_count, before.page_count + 1);
+  ASSERT_INT_EQ(orphaned.live_count, before.live_count + ORPHAN_COUNT);
+
+  // Frees from this thread are queued on the page until its owner collects
+  for (int i = 0; i < ORPHAN_COUNT; i++)
+    slab_free(blocks[i], ORPHAN_SIZE);
+  ASSERT_INT_EQ(class_stats(ORPHAN_SIZE).live_count,
+                before.live_count + ORPHAN_COUNT);
+
+  SlabClassStats adopted;
+  ASSERT_INT_EQ(pthread_create(&thread, NULL, adopt_thread, &adopted), 0);
+  ASSERT_INT_EQ(pthread_join(thread, NULL), 0);
+  ASSERT_INT_EQ(adopted.page_count, before.page_count + 1);
+  ASSERT_INT_EQ(adopted.live_count, before.live_count + 1);
+
+  // The adopting thread exited with the page empty, so it was released
+  SlabClassStats after = class_stats(ORPHAN_SIZE);
+  ASSERT_INT_EQ(after.page_count, before.page_count);
+  ASSERT_INT_EQ(after.live_count, before.live_count);
+}
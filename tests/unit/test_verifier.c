@@ -0,0 +1,183 @@
+#include "../framework/test_framework.h"
+#include "../../src/frontend/tokenizer.h"
+#include "../../src/frontend/parser.h"
+#include "../../src/compiler/compiler.h"
+#include "../../src/vm/verifier.h"
+#include "../../src/vm/vm.h"
+#include <stdlib.h>
+#include <string.h>
+
+static Bytecode *compile_string(const char *source) {
+    TokenizeError *tok_err = NULL;
+    TokenArray *tokens = tokenize(source, &tok_err);
+    if (tok_err != NULL || tokens == NULL) {
+        if (tok_err) tokenize_error_free(tok_err);
+        return NULL;
+    }
+
+    AST *ast = parse(tokens);
+    token_array_free(tokens);
+    if (ast == NULL) {
+        return NULL;
+    }
+
+    const char *err = NULL;
+    Bytecode *bytecode = compile(ast, &err);
+    ast_free(ast);
+    return err == NULL ? bytecode : NULL;
+}
+
+// Wrap hand-written code (and an optional constant pool) in a Bytecode
+static Bytecode make_bytecode(uint8_t *code, size_t count,
+                              KronosValue **constants, size_t const_count) {
+    Bytecode bytecode;
+    memset(&bytecode, 0, sizeof(bytecode));
+    bytecode.code = code;
+    bytecode.count = count;
+    bytecode.capacity = count;
+    bytecode.constants = constants;
+    bytecode.const_count = const_count;
+    bytecode.const_capacity = const_count;
+    return bytecode;
+}
+
+TEST(verify_compiled_program) {
+    Bytecode *bytecode = compile_string(
+        "function sum_items with items:\n"
+        "    let total to 0\n"
+        "    for item in items:\n"
+        "        let total to total plus item\n"
+        "    return total\n"
+        "set numbers to list 1, 2, 3\n"
+        "let i to 0\n"
+        "while i is less than 3:\n"
+        "    let i to i plus 1\n"
+        "print call sum_items with numbers");
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    size_t max_stack = 0;
+    const char *error = NULL;
+    ASSERT_TRUE(bytecode_verify(bytecode, 0, false, &max_stack, &error));
+    ASSERT_PTR_NULL(error);
+    ASSERT_TRUE(max_stack > 0);
+
+    bytecode_free(bytecode);
+}
+
+TEST(verify_defined_functions) {
+    Bytecode *bytecode = compile_string(
+        "function fact with n:\n"
+        "    if n is less than 2:\n"
+        "        return 1\n"
+        "    return n times call fact with n minus 1\n"
+        "set result to call fact with 5");
+    ASSERT_PTR_NOT_NULL(bytecode);
+
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    // Bodies are verified by vm_define_function
+    Function *fact = vm_get_function(vm, "fact");
+    ASSERT_PTR_NOT_NULL(fact);
+    ASSERT_TRUE(fact->verified);
+    ASSERT_TRUE(fact->max_stack > 0);
+
+    KronosValue *result = vm_get_global(vm, "result");
+    ASSERT_PTR_NOT_NULL(result);
+    ASSERT_DOUBLE_EQ(result->as.number, 120.0);
+
+    vm_free(vm);
+    bytecode_free(bytecode);
+}
+
+TEST(verify_rejects_constant_out_of_range) {
+    uint8_t code[] = {OP_LOAD_CONST, 0, 3, OP_PRINT, OP_HALT};
+    Bytecode bytecode = make_bytecode(code, sizeof(code), NULL, 0);
+
+    const char *error = NULL;
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, &error));
+    ASSERT_PTR_NOT_NULL(error);
+}
+
+TEST(verify_rejects_truncated_operands) {
+    KronosValue *constants[] = {value_new_number(1)};
+    uint8_t code[] = {OP_LOAD_CONST, 0};
+    Bytecode bytecode = make_bytecode(code, sizeof(code), constants, 1);
+
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, NULL));
+    value_release(constants[0]);
+}
+
+TEST(verify_rejects_stack_underflow) {
+    uint8_t code[] = {OP_POP, OP_HALT};
+    Bytecode bytecode = make_bytecode(code, sizeof(code), NULL, 0);
+
+    const char *error = NULL;
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, &error));
+    ASSERT_STR_EQ(error, "operand stack underflow");
+}
+
+TEST(verify_rejects_bad_control_flow) {
+    KronosValue *constants[] = {value_new_number(1)};
+
+    // Jump past the end of the code
+    uint8_t past_end[] = {OP_JUMP, 10, OP_HALT};
+    Bytecode bytecode =
+        make_bytecode(past_end, sizeof(past_end), constants, 1);
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, NULL));
+
+    // Falling off the end without OP_HALT
+    uint8_t no_halt[] = {OP_LOAD_CONST, 0, 0, OP_PRINT};
+    bytecode = make_bytecode(no_halt, sizeof(no_halt), constants, 1);
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, NULL));
+
+    // The two paths reach OP_HALT with different stack depths
+    uint8_t join[] = {OP_LOAD_CONST, 0, 0, OP_JUMP_IF_FALSE, 3,
+                      OP_LOAD_CONST, 0, 0, OP_HALT};
+    bytecode = make_bytecode(join, sizeof(join), constants, 1);
+    const char *error = NULL;
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, &error));
+    ASSERT_STR_EQ(error, "inconsistent stack depth at join");
+
+    value_release(constants[0]);
+}
+
+TEST(verify_function_slots_and_return) {
+    KronosValue *constants[] = {value_new_number(1)};
+
+    // return slot 0
+    uint8_t ok[] = {OP_LOAD_LOCAL, 0, OP_RETURN_VAL};
+    Bytecode bytecode = make_bytecode(ok, sizeof(ok), constants, 1);
+    size_t max_stack = 0;
+    ASSERT_TRUE(bytecode_verify(&bytecode, 1, true, &max_stack, NULL));
+    ASSERT_INT_EQ(max_stack, 1);
+
+    // Slot 1 does not exist, and top-level code has no slots at all
+    uint8_t bad_slot[] = {OP_LOAD_LOCAL, 1, OP_RETURN_VAL};
+    bytecode = make_bytecode(bad_slot, sizeof(bad_slot), constants, 1);
+    ASSERT_FALSE(bytecode_verify(&bytecode, 1, true, NULL, NULL));
+    bytecode = make_bytecode(ok, sizeof(ok), constants, 1);
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, false, NULL, NULL));
+
+    // A return must leave nothing but the return value behind
+    uint8_t extra[] = {OP_LOAD_CONST, 0, 0, OP_LOAD_CONST, 0, 0,
+                       OP_RETURN_VAL};
+    bytecode = make_bytecode(extra, sizeof(extra), constants, 1);
+    ASSERT_FALSE(bytecode_verify(&bytecode, 0, true, NULL, NULL));
+
+    value_release(constants[0]);
+}
+
+TEST(verify_malformed_bytecode_keeps_runtime_checks) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // Fails verification, so the checked loop reports the bad index
+    uint8_t code[] = {OP_LOAD_CONST, 0, 3, OP_PRINT, OP_HALT};
+    Bytecode bytecode = make_bytecode(code, sizeof(code), NULL, 0);
+    ASSERT_NE(vm_execute(vm, &bytecode), 0);
+    ASSERT_PTR_NOT_NULL(vm->last_error_message);
+
+    vm_free(vm);
+}
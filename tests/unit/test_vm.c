@@ -309,6 +309,316 @@ TEST(vm_get_variable_local_scope) {
     vm_free(vm);
 }
 
+TEST(vm_local_slot_falls_back_to_global) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // First read of 'x' happens before the function assigns it
+    Bytecode *bytecode = compile_string(
+        "set x to 7\n"
+        "function f with n:\n"
+        "    let total to 0\n"
+        "    for i in range 1 to n:\n"
+        "        let total to total plus x\n"
+        "        let x to 1\n"
+        "    return total\n"
+        "set result to call f with 3");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *result = vm_get_global(vm, "result");
+    ASSERT_PTR_NOT_NULL(result);
+    ASSERT_DOUBLE_EQ(result->as.number, 9.0);
+
+    KronosValue *x = vm_get_global(vm, "x");
+    ASSERT_PTR_NOT_NULL(x);
+    ASSERT_DOUBLE_EQ(x->as.number, 7.0);
+    ASSERT_EQ(vm->call_stack_size, 0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_increment_matches_generic_add) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // Fused increments keep OP_ADD semantics: string concatenation and the
+    // global fallback for a slot that has not been assigned yet
+    Bytecode *bytecode = compile_string(
+        "let s to \"n\"\n"
+        "let s to s plus 1\n"
+        "let g to 40\n"
+        "function f:\n"
+        "    let g to g plus 2\n"
+        "    return g\n"
+        "set result to call f");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *s = vm_get_global(vm, "s");
+    ASSERT_PTR_NOT_NULL(s);
+    ASSERT_STR_EQ(s->as.string.data, "n1");
+    KronosValue *result = vm_get_global(vm, "result");
+    ASSERT_PTR_NOT_NULL(result);
+    ASSERT_DOUBLE_EQ(result->as.number, 42.0);
+    KronosValue *g = vm_get_global(vm, "g");
+    ASSERT_PTR_NOT_NULL(g);
+    ASSERT_DOUBLE_EQ(g->as.number, 40.0);
+    bytecode_free(bytecode);
+
+    // ...and the immutability check of the store
+    bytecode = compile_string("set x to 1\nlet x to x plus 1");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_NE(vm_execute(vm, bytecode), 0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_and_or_short_circuit) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // 'missing' is undefined, so evaluating it would fail the program
+    Bytecode *bytecode = compile_string(
+        "set a to false and missing\n"
+        "set b to true or missing\n"
+        "set c to 1 and \"x\"\n"
+        "let branch to 0\n"
+        "if a or b and false:\n"
+        "    let branch to 1\n"
+        "else if b or missing:\n"
+        "    let branch to 2\n"
+        "else:\n"
+        "    let branch to 3");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *a = vm_get_global(vm, "a");
+    ASSERT_PTR_NOT_NULL(a);
+    ASSERT_EQ(a->type, VAL_BOOL);
+    ASSERT_FALSE(a->as.boolean);
+    KronosValue *b = vm_get_global(vm, "b");
+    ASSERT_PTR_NOT_NULL(b);
+    ASSERT_TRUE(b->as.boolean);
+    KronosValue *c = vm_get_global(vm, "c");
+    ASSERT_PTR_NOT_NULL(c);
+    ASSERT_EQ(c->type, VAL_BOOL);
+    ASSERT_TRUE(c->as.boolean);
+    KronosValue *branch = vm_get_global(vm, "branch");
+    ASSERT_PTR_NOT_NULL(branch);
+    ASSERT_DOUBLE_EQ(branch->as.number, 2.0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_string_append_in_place) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // s grows in place; copy and the parameter t share it and must not
+    Bytecode *bytecode = compile_string(
+        "let s to \"start\"\n"
+        "for i in range 1 to 100:\n"
+        "    let s to s plus \"ab\"\n"
+        "set copy to s\n"
+        "let s to s plus \"!\"\n"
+        "function grow with t:\n"
+        "    let t to t plus \"?\"\n"
+        "    return t\n"
+        "set grown to call grow with copy");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *s = vm_get_global(vm, "s");
+    ASSERT_PTR_NOT_NULL(s);
+    ASSERT_INT_EQ(s->as.string.length, 206);
+    ASSERT_EQ(s->as.string.data[205], '!');
+    ASSERT_INT_EQ(s->as.string.hash, string_hash(s->as.string.data, 206));
+    KronosValue *copy = vm_get_global(vm, "copy");
+    ASSERT_PTR_NOT_NULL(copy);
+    ASSERT_INT_EQ(copy->as.string.length, 205);
+    ASSERT_EQ(copy->as.string.data[204], 'b');
+    KronosValue *grown = vm_get_global(vm, "grown");
+    ASSERT_PTR_NOT_NULL(grown);
+    ASSERT_INT_EQ(grown->as.string.length, 206);
+    ASSERT_EQ(grown->as.string.data[205], '?');
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_build_string) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    Bytecode *bytecode = compile_string(
+        "set n to 7\n"
+        "set f to f\"n={n}, half={n divided by 2}, {true}/{null}\"\n"
+        "set chain to \"[\" plus n plus \"|\" plus 1.5 plus \"]\"\n"
+        "set sum to 1 plus 2 plus \"x\"\n"
+        "let s to \"ab\"\n"
+        "let s to s plus \"-\" plus s\n"
+        "for i in range 1 to 3:\n"
+        "    let s to s plus \",\" plus i");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    bool has_build = false;
+    for (size_t i = 0; i < bytecode->count; i++) {
+        if (bytecode->code[i] == OP_BUILD_STRING)
+            has_build = true;
+    }
+    ASSERT_TRUE(has_build);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *f = vm_get_global(vm, "f");
+    ASSERT_PTR_NOT_NULL(f);
+    ASSERT_STR_EQ(f->as.string.data, "n=7, half=3.5, true/null");
+    KronosValue *chain = vm_get_global(vm, "chain");
+    ASSERT_PTR_NOT_NULL(chain);
+    ASSERT_STR_EQ(chain->as.string.data, "[7|1.5]");
+    // Numbers before the first string still add
+    KronosValue *sum = vm_get_global(vm, "sum");
+    ASSERT_PTR_NOT_NULL(sum);
+    ASSERT_STR_EQ(sum->as.string.data, "3x");
+    KronosValue *s = vm_get_global(vm, "s");
+    ASSERT_PTR_NOT_NULL(s);
+    ASSERT_STR_EQ(s->as.string.data, "ab-ab,1,2,3");
+    ASSERT_INT_EQ(s->as.string.hash, string_hash(s->as.string.data, 11));
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+
+    // f-strings keep to_string's rule for values without a string form
+    vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+    bytecode = compile_string("set items to list 1, 2\nprint f\"{items}\"");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_TRUE(vm_execute(vm, bytecode) < 0);
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_list_iteration_control_flow) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // The iterator lives on the operand stack; break, continue and return
+    // must all leave the stack balanced
+    Bytecode *bytecode = compile_string(
+        "function find with items, target:\n"
+        "    for x in items:\n"
+        "        if x is equal target:\n"
+        "            return x\n"
+        "    return -1\n"
+        "set items to list 1, 2, 3, 4, 5\n"
+        "let total to 0\n"
+        "for x in items:\n"
+        "    if x is equal 2:\n"
+        "        continue\n"
+        "    if x is equal 5:\n"
+        "        break\n"
+        "    let total to total plus x\n"
+        "set found to call find with items, 4");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *total = vm_get_global(vm, "total");
+    ASSERT_PTR_NOT_NULL(total);
+    ASSERT_DOUBLE_EQ(total->as.number, 8.0);
+    KronosValue *found = vm_get_global(vm, "found");
+    ASSERT_PTR_NOT_NULL(found);
+    ASSERT_DOUBLE_EQ(found->as.number, 4.0);
+    ASSERT_EQ(vm->stack_top, vm->stack);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_list_iteration_releases_iterator) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    Bytecode *bytecode = compile_string(
+        "set nums to list 1, 2, 3\n"
+        "for n in nums:\n"
+        "    let seen to n\n");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    // Only the global still references the list once the loop is done
+    KronosValue *nums = vm_get_global(vm, "nums");
+    ASSERT_PTR_NOT_NULL(nums);
+    ASSERT_INT_EQ(nums->refcount, 1);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_range_loop_negative_step) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // 10, 7, 4, 1 whichever way the loop is lowered: counted (a), body
+    // assigns the counter with a literal step (b) or a variable one (c, d)
+    Bytecode *bytecode = compile_string(
+        "set down to -3\n"
+        "let a to 0\n"
+        "for i in range 10 to 1 by -3:\n"
+        "    let a to a plus i\n"
+        "let b to 0\n"
+        "for i in range 10 to 1 by -3:\n"
+        "    let i to i plus 0\n"
+        "    let b to b plus i\n"
+        "let c to 0\n"
+        "for i in range 10 to 1 by down:\n"
+        "    let i to i plus 0\n"
+        "    let c to c plus i\n"
+        "function count_down with top:\n"
+        "    let total to 0\n"
+        "    for i in range top to 1 by down:\n"
+        "        let i to i plus 0\n"
+        "        if i is equal 4:\n"
+        "            break\n"
+        "        let total to total plus i\n"
+        "    return total\n"
+        "set d to call count_down with 10");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    const char *names[] = {"a", "b", "c"};
+    for (size_t i = 0; i < 3; i++) {
+        KronosValue *sum = vm_get_global(vm, names[i]);
+        ASSERT_PTR_NOT_NULL(sum);
+        ASSERT_DOUBLE_EQ(sum->as.number, 22.0);
+    }
+    KronosValue *d = vm_get_global(vm, "d");
+    ASSERT_PTR_NOT_NULL(d);
+    ASSERT_DOUBLE_EQ(d->as.number, 17.0);
+    ASSERT_TRUE(vm_get_function(vm, "count_down")->verified);
+    ASSERT_EQ(vm->stack_top, vm->stack);
+    bytecode_free(bytecode);
+
+    // A zero step is rejected by both lowerings
+    const char *zero_step[] = {
+        "for i in range 1 to 3 by 0:\n    print i",
+        "for i in range 1 to 3 by 0:\n    let i to i plus 1",
+        "set z to 0\nfor i in range 1 to 3 by z:\n    let i to i plus 1",
+    };
+    for (size_t i = 0; i < 3; i++) {
+        bytecode = compile_string(zero_step[i]);
+        ASSERT_PTR_NOT_NULL(bytecode);
+        ASSERT_NE(vm_execute(vm, bytecode), 0);
+        ASSERT_PTR_NOT_NULL(vm->last_error_message);
+        ASSERT_TRUE(strstr(vm->last_error_message,
+                           "Range step cannot be zero") != NULL);
+        bytecode_free(bytecode);
+    }
+
+    vm_free(vm);
+}
+
 TEST(vm_get_function) {
     KronosVM *vm = vm_new();
     ASSERT_PTR_NOT_NULL(vm);
@@ -430,7 +740,7 @@ TEST(vm_define_function_direct) {
     ASSERT_PTR_NOT_NULL(vm);
 
     // Create a simple function manually
-    Function *func = malloc(sizeof(Function));
+    Function *func = calloc(1, sizeof(Function));
     ASSERT_PTR_NOT_NULL(func);
 
     func->name = strdup("test_func");
@@ -454,7 +764,175 @@ TEST(vm_define_function_direct) {
     Function *retrieved = vm_get_function(vm, "test_func");
     ASSERT_PTR_NOT_NULL(retrieved);
     ASSERT_STR_EQ(retrieved->name, "test_func");
+    ASSERT_FALSE(retrieved->verified); // Empty body: runs in the checked loop
+
+    vm_free(vm);
+}
+
+TEST(vm_many_globals) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
 
+    // Well past the old fixed table size of 256 entries
+    size_t cap = 1000 * 32;
+    char *source = malloc(cap);
+    ASSERT_PTR_NOT_NULL(source);
+    size_t len = 0;
+    for (int i = 0; i < 1000; i++) {
+        len += (size_t)snprintf(source + len, cap - len, "set g%d to %d\n", i, i);
+    }
+    snprintf(source + len, cap - len, "set total to g0 plus g999");
+
+    Bytecode *bytecode = compile_string(source);
+    free(source);
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *g500 = vm_get_global(vm, "g500");
+    ASSERT_PTR_NOT_NULL(g500);
+    ASSERT_DOUBLE_EQ(g500->as.number, 500.0);
+    KronosValue *total = vm_get_global(vm, "total");
+    ASSERT_PTR_NOT_NULL(total);
+    ASSERT_DOUBLE_EQ(total->as.number, 999.0);
+
+    // Embedder-set globals share the same table
+    KronosValue *num = value_new_number(5);
+    ASSERT_NE(vm_set_global(vm, "g999", num, false, NULL), 0);
+    ASSERT_INT_EQ(vm_set_global(vm, "extra", num, false, NULL), 0);
+    value_release(num);
+    KronosValue *extra = vm_get_global(vm, "extra");
+    ASSERT_PTR_NOT_NULL(extra);
+    ASSERT_DOUBLE_EQ(extra->as.number, 5.0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_global_referenced_before_definition) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // 'later' is linked when the bytecode starts but only assigned afterwards
+    Bytecode *bytecode = compile_string(
+        "function f with n:\n    return n plus later\n"
+        "set later to 10\nset result to call f with 1");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+
+    KronosValue *result = vm_get_global(vm, "result");
+    ASSERT_PTR_NOT_NULL(result);
+    ASSERT_DOUBLE_EQ(result->as.number, 11.0);
+
+    bytecode_free(bytecode);
+
+    // Referenced but never assigned is still undefined
+    bytecode = compile_string("print missing");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_NE(vm_execute(vm, bytecode), 0);
+    ASSERT_PTR_NULL(vm_get_global(vm, "missing"));
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_many_functions) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // Well past the old fixed table size of 128
+    char source[16384];
+    size_t len = 0;
+    for (int i = 0; i < 300; i++) {
+        len += (size_t)snprintf(source + len, sizeof(source) - len,
+                                "function f%d with n:\n    return n plus %d\n",
+                                i, i);
+    }
+    snprintf(source + len, sizeof(source) - len,
+             "set result to call f299 with call f7 with 1");
+
+    Bytecode *bytecode = compile_string(source);
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+    ASSERT_INT_EQ(vm->function_count, 300);
+    ASSERT_PTR_NOT_NULL(vm_get_function(vm, "f0"));
+    ASSERT_PTR_NOT_NULL(vm_get_function(vm, "f299"));
+    ASSERT_PTR_NULL(vm_get_function(vm, "f300"));
+
+    KronosValue *result = vm_get_global(vm, "result");
+    ASSERT_PTR_NOT_NULL(result);
+    ASSERT_DOUBLE_EQ(result->as.number, 307.0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_function_redefinition_invalidates_call_cache) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // The call site inside g caches f before f is replaced
+    Bytecode *bytecode = compile_string(
+        "function f with n:\n    return n plus 1\n"
+        "function g with n:\n    return call f with n\n"
+        "set a to call g with 1\n"
+        "function f with n:\n    return n times 10\n"
+        "set b to call g with 1");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+    ASSERT_INT_EQ(vm->function_count, 2);
+
+    KronosValue *a = vm_get_global(vm, "a");
+    KronosValue *b = vm_get_global(vm, "b");
+    ASSERT_PTR_NOT_NULL(a);
+    ASSERT_PTR_NOT_NULL(b);
+    ASSERT_DOUBLE_EQ(a->as.number, 2.0);
+    ASSERT_DOUBLE_EQ(b->as.number, 10.0);
+
+    bytecode_free(bytecode);
+    vm_free(vm);
+}
+
+TEST(vm_function_redefinition_frees_retired_definitions) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+
+    // Each replaced f has returned, so none of them needs to be kept
+    Bytecode *bytecode = compile_string(
+        "let total to 0\n"
+        "for i in range 1 to 2000:\n"
+        "    function f with n:\n"
+        "        return n plus 1\n"
+        "    let total to call f with total\n");
+    ASSERT_PTR_NOT_NULL(bytecode);
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+    ASSERT_INT_EQ(vm->retired_count, 0);
+    ASSERT_TRUE(vm->retired_capacity <= 8);
+
+    KronosValue *total = vm_get_global(vm, "total");
+    ASSERT_PTR_NOT_NULL(total);
+    ASSERT_DOUBLE_EQ(total->as.number, 2000.0);
+
+    // A definition replaced while it runs is kept until it returns
+    Bytecode *running = compile_string(
+        "function g with n:\n"
+        "    function g with n:\n"
+        "        return n times 10\n"
+        "    return n plus 1\n"
+        "set a to call g with 1\n"
+        "set b to call g with 1");
+    ASSERT_PTR_NOT_NULL(running);
+    ASSERT_INT_EQ(vm_execute(vm, running), 0);
+    ASSERT_INT_EQ(vm->retired_count, 0);
+
+    KronosValue *a = vm_get_global(vm, "a");
+    KronosValue *b = vm_get_global(vm, "b");
+    ASSERT_PTR_NOT_NULL(a);
+    ASSERT_PTR_NOT_NULL(b);
+    ASSERT_DOUBLE_EQ(a->as.number, 2.0);
+    ASSERT_DOUBLE_EQ(b->as.number, 10.0);
+
+    bytecode_free(running);
+    bytecode_free(bytecode);
     vm_free(vm);
 }
 
@@ -484,3 +962,159 @@ TEST(vm_set_global_type_checking) {
     vm_free(vm);
 }
 
+
+TEST(vm_memory_limit_exceeded) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+    gc_budget_set_limits(&vm->memory, 0, 1 << 20);
+
+    // Garbage is reclaimed as it is produced, so churn stays under the limit
+    Bytecode *churn = compile_string(
+        "let parts to list\n"
+        "for i in range 1 to 20000:\n"
+        "    let parts to call split with \"alpha,beta,gamma,delta\", \",\"\n");
+    ASSERT_PTR_NOT_NULL(churn);
+    ASSERT_INT_EQ(vm_execute(vm, churn), 0);
+    ASSERT_TRUE(vm->memory.used < (1 << 20));
+
+    // A string growing past 1 MiB stops the run instead of the process
+    Bytecode *grow = compile_string(
+        "let s to \"\"\n"
+        "for i in range 1 to 200000:\n"
+        "    let s to s plus \"0123456789\"\n");
+    ASSERT_PTR_NOT_NULL(grow);
+    ASSERT_INT_EQ(vm_execute(vm, grow), -(int)KRONOS_ERR_RUNTIME);
+    ASSERT_INT_EQ(vm->last_error_code, KRONOS_ERR_RUNTIME);
+    ASSERT_STR_EQ(vm->last_error_message, "memory limit exceeded");
+    ASSERT_TRUE(vm->memory.used <= (1 << 20));
+
+    // The VM stays usable
+    Bytecode *after = compile_string("set ok to 1");
+    ASSERT_PTR_NOT_NULL(after);
+    ASSERT_INT_EQ(vm_execute(vm, after), 0);
+
+    bytecode_free(churn);
+    bytecode_free(grow);
+    bytecode_free(after);
+    vm_free(vm);
+}
+
+TEST(vm_memory_limit_ignores_interned_strings) {
+    KronosVM *vm = vm_new();
+    ASSERT_PTR_NOT_NULL(vm);
+    gc_budget_set_limits(&vm->memory, 0, 1 << 20);
+
+    // Interned strings are shared by every VM, so interning one while this
+    // VM's budget is current charges nothing
+    GCBudget *previous = gc_set_budget(&vm->memory);
+    size_t used = vm->memory.used;
+    KronosValue *name = string_intern("not_charged_to_any_vm", 21);
+    ASSERT_PTR_NOT_NULL(name);
+    ASSERT_INT_EQ(vm->memory.used, used);
+    gc_set_budget(previous);
+
+    value_release(name);
+    vm_free(vm);
+}
+
+typedef struct {
+    size_t allocations;
+    size_t live;
+} CountingHeap;
+
+static void *counting_alloc(void *user_data, size_t size) {
+    CountingHeap *heap = user_data;
+    heap->allocations++;
+    heap->live++;
+    return malloc(size);
+}
+
+static void *counting_realloc(void *user_data, void *ptr, size_t size) {
+    if (!ptr)
+        return counting_alloc(user_data, size);
+    return realloc(ptr, size);
+}
+
+static void counting_free(void *user_data, void *ptr) {
+    CountingHeap *heap = user_data;
+    heap->live--;
+    free(ptr);
+}
+
+TEST(vm_custom_allocator) {
+    CountingHeap heap = {0, 0};
+    KronosAllocator allocator = {counting_alloc, counting_realloc,
+                                 counting_free, &heap};
+
+    MemAllocator *handle = mem_allocator_new(&allocator);
+    ASSERT_PTR_NOT_NULL(handle);
+    MemAllocator *previous = mem_set_allocator(handle);
+    KronosVM *vm = vm_new();
+    mem_set_allocator(previous);
+    mem_allocator_release(handle);
+    ASSERT_PTR_NOT_NULL(vm);
+    size_t after_new = heap.allocations;
+    ASSERT_TRUE(after_new > 0);
+
+    // The frontend and compiler allocate through the current allocator
+    previous = vm_use_allocator(vm);
+    Bytecode *bytecode = compile_string(
+        "function pad with s:\n"
+        "    return s plus \"................................\"\n"
+        "let text to \"\"\n"
+        "for i in range 1 to 20:\n"
+        "    let text to call pad with text\n"
+        "set parts to call split with text, \"x\"\n");
+    mem_set_allocator(previous);
+    ASSERT_PTR_NOT_NULL(bytecode);
+    size_t after_compile = heap.allocations;
+    ASSERT_TRUE(after_compile > after_new);
+
+    // Runs switch to the VM's allocator by themselves
+    ASSERT_INT_EQ(vm_execute(vm, bytecode), 0);
+    ASSERT_TRUE(heap.allocations > after_compile);
+    KronosValue *text = vm_get_global(vm, "text");
+    ASSERT_PTR_NOT_NULL(text);
+    ASSERT_INT_EQ(text->as.string.length, 640);
+
+    previous = vm_use_allocator(vm);
+    bytecode_free(bytecode);
+    mem_set_allocator(previous);
+
+    // Lists, strings and functions kept past vm_free() still free their
+    // storage (and a list its items) through the VM's allocator, whichever
+    // allocator is current when they die
+    KronosValue *parts = vm_get_global(vm, "parts");
+    ASSERT_PTR_NOT_NULL(parts);
+    value_retain(parts);
+    value_retain(text);
+    previous = vm_use_allocator(vm);
+    uint8_t code[] = {OP_HALT};
+    KronosValue *function = value_new_function(code, sizeof(code), 0);
+    mem_set_allocator(previous);
+    ASSERT_PTR_NOT_NULL(function);
+    vm_free(vm);
+    ASSERT_TRUE(heap.live > 0);
+
+    CountingHeap other_heap = {0, 0};
+    KronosAllocator other = {counting_alloc, counting_realloc, counting_free,
+                             &other_heap};
+    handle = mem_allocator_new(&other);
+    ASSERT_PTR_NOT_NULL(handle);
+    previous = mem_set_allocator(handle);
+    value_release(parts);
+    value_release(text);
+    value_release(function);
+    mem_set_allocator(previous);
+    mem_allocator_release(handle);
+    ASSERT_INT_EQ(heap.live, 0);
+    ASSERT_INT_EQ(other_heap.live, 0);
+
+    // Every callback is required
+    allocator.free = NULL;
+    ASSERT_PTR_NULL(mem_allocator_new(&allocator));
+    allocator.free = counting_free;
+    allocator.realloc = NULL;
+    ASSERT_PTR_NULL(mem_allocator_new(&allocator));
+    ASSERT_PTR_NULL(mem_allocator_new(NULL));
+}